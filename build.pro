@@ -25,6 +25,10 @@
 #   PREFIX - specifies base folder to which files are copied during "make install"
 #            step, defaults to "$$OUT_PWD/usr" on Linux and to "$$OUT_PWD/app" on Windows.
 #
+# Tests:
+#   If QtTest module is installed, tests and benchmarks of feed parsers
+#   are compiled too. Run them via "make check".
+#
 # Other information:
 #   - supports Windows, Linux, Mac OS X, Android,
 #   - Qt 5.9.0 or higher is required,
@@ -44,3 +48,10 @@ librssguard.subdir  = src/librssguard
 
 rssguard.subdir  = src/rssguard
 rssguard.depends = libtextosaurus
+
+qtHaveModule(testlib) {
+  SUBDIRS += tests
+
+  tests.subdir = src/tests
+  tests.depends = librssguard
+}
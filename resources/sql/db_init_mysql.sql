@@ -12,7 +12,7 @@ CREATE TABLE IF NOT EXISTS Information (
   inf_value       TEXT        NOT NULL
 );
 -- !
-INSERT INTO Information VALUES (1, 'schema_version', '11');
+INSERT INTO Information VALUES (1, 'schema_version', '18');
 -- !
 CREATE TABLE IF NOT EXISTS Accounts (
   id              INTEGER     PRIMARY KEY,
@@ -78,6 +78,9 @@ CREATE TABLE IF NOT EXISTS Categories (
   icon            BLOB,
   account_id      INTEGER       NOT NULL,
   custom_id       TEXT,
+  retention_count INTEGER       NOT NULL DEFAULT 0 CHECK (retention_count >= 0),
+  retention_days  INTEGER       NOT NULL DEFAULT 0 CHECK (retention_days >= 0),
+  retention_keep_important INTEGER(1) NOT NULL DEFAULT 1 CHECK (retention_keep_important >= 0 AND retention_keep_important <= 1),
   
   FOREIGN KEY (account_id) REFERENCES Accounts (id)
 );
@@ -101,6 +104,11 @@ CREATE TABLE IF NOT EXISTS Feeds (
   type            INTEGER,
   account_id      INTEGER       NOT NULL,
   custom_id       TEXT,
+  http_etag       TEXT,
+  http_last_modified TEXT,
+  retention_count INTEGER       NOT NULL DEFAULT 0 CHECK (retention_count >= 0),
+  retention_days  INTEGER       NOT NULL DEFAULT 0 CHECK (retention_days >= 0),
+  retention_keep_important INTEGER(1) NOT NULL DEFAULT 1 CHECK (retention_keep_important >= 0 AND retention_keep_important <= 1),
   
   FOREIGN KEY (account_id) REFERENCES Accounts (id)
 );
@@ -123,6 +131,71 @@ CREATE TABLE IF NOT EXISTS Messages (
   account_id      INTEGER     NOT NULL,
   custom_id       TEXT,
   custom_hash     TEXT,
+  identity_hash   BIGINT,
+  content_hash    BIGINT,
+  compressed_contents MEDIUMBLOB,
   
   FOREIGN KEY (account_id) REFERENCES Accounts (id)
-);
\ No newline at end of file
+);
+-- !
+CREATE INDEX idx_messages_feed ON Messages (account_id, feed(100), is_deleted, is_pdeleted, is_read);
+-- !
+CREATE INDEX idx_messages_custom_id ON Messages (account_id, custom_id(100));
+-- !
+CREATE INDEX idx_feeds_custom_id ON Feeds (account_id, custom_id(100));
+-- !
+CREATE INDEX idx_messages_identity_hash ON Messages (account_id, feed(100), identity_hash);
+-- !
+CREATE INDEX idx_messages_feed_date ON Messages (account_id, feed(100), date_created);
+-- !
+CREATE TABLE IF NOT EXISTS FeedCounters (
+  account_id        INTEGER     NOT NULL,
+  feed              TEXT        NOT NULL,
+  unread_count      INTEGER     NOT NULL DEFAULT 0,
+  total_count       INTEGER     NOT NULL DEFAULT 0,
+  bin_unread_count  INTEGER     NOT NULL DEFAULT 0,
+  bin_total_count   INTEGER     NOT NULL DEFAULT 0,
+  
+  PRIMARY KEY (account_id, feed(100))
+);
+-- !
+CREATE TRIGGER trg_messages_counters_insert AFTER INSERT ON Messages FOR EACH ROW
+BEGIN
+  INSERT INTO FeedCounters (account_id, feed, unread_count, total_count, bin_unread_count, bin_total_count)
+    VALUES (NEW.account_id, NEW.feed, (NEW.is_deleted = 0 AND NEW.is_pdeleted = 0 AND NEW.is_read = 0), (NEW.is_deleted = 0 AND NEW.is_pdeleted = 0), (NEW.is_deleted = 1 AND NEW.is_pdeleted = 0 AND NEW.is_read = 0), (NEW.is_deleted = 1 AND NEW.is_pdeleted = 0))
+    ON DUPLICATE KEY UPDATE
+      unread_count = unread_count + VALUES(unread_count),
+      total_count = total_count + VALUES(total_count),
+      bin_unread_count = bin_unread_count + VALUES(bin_unread_count),
+      bin_total_count = bin_total_count + VALUES(bin_total_count);
+END;
+-- !
+CREATE TRIGGER trg_messages_counters_delete AFTER DELETE ON Messages FOR EACH ROW
+BEGIN
+  UPDATE FeedCounters SET
+      unread_count = unread_count - (OLD.is_deleted = 0 AND OLD.is_pdeleted = 0 AND OLD.is_read = 0),
+      total_count = total_count - (OLD.is_deleted = 0 AND OLD.is_pdeleted = 0),
+      bin_unread_count = bin_unread_count - (OLD.is_deleted = 1 AND OLD.is_pdeleted = 0 AND OLD.is_read = 0),
+      bin_total_count = bin_total_count - (OLD.is_deleted = 1 AND OLD.is_pdeleted = 0)
+    WHERE account_id = OLD.account_id AND feed = OLD.feed;
+END;
+-- !
+CREATE TRIGGER trg_messages_counters_update AFTER UPDATE ON Messages FOR EACH ROW
+BEGIN
+  IF OLD.is_read <> NEW.is_read OR OLD.is_deleted <> NEW.is_deleted OR OLD.is_pdeleted <> NEW.is_pdeleted OR
+     OLD.feed <> NEW.feed OR OLD.account_id <> NEW.account_id THEN
+    UPDATE FeedCounters SET
+        unread_count = unread_count - (OLD.is_deleted = 0 AND OLD.is_pdeleted = 0 AND OLD.is_read = 0),
+        total_count = total_count - (OLD.is_deleted = 0 AND OLD.is_pdeleted = 0),
+        bin_unread_count = bin_unread_count - (OLD.is_deleted = 1 AND OLD.is_pdeleted = 0 AND OLD.is_read = 0),
+        bin_total_count = bin_total_count - (OLD.is_deleted = 1 AND OLD.is_pdeleted = 0)
+      WHERE account_id = OLD.account_id AND feed = OLD.feed;
+    INSERT INTO FeedCounters (account_id, feed, unread_count, total_count, bin_unread_count, bin_total_count)
+      VALUES (NEW.account_id, NEW.feed, (NEW.is_deleted = 0 AND NEW.is_pdeleted = 0 AND NEW.is_read = 0), (NEW.is_deleted = 0 AND NEW.is_pdeleted = 0), (NEW.is_deleted = 1 AND NEW.is_pdeleted = 0 AND NEW.is_read = 0), (NEW.is_deleted = 1 AND NEW.is_pdeleted = 0))
+      ON DUPLICATE KEY UPDATE
+        unread_count = unread_count + VALUES(unread_count),
+        total_count = total_count + VALUES(total_count),
+        bin_unread_count = bin_unread_count + VALUES(bin_unread_count),
+        bin_total_count = bin_total_count + VALUES(bin_total_count);
+  END IF;
+END;
\ No newline at end of file
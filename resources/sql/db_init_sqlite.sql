@@ -6,7 +6,7 @@ CREATE TABLE IF NOT EXISTS Information (
   inf_value       TEXT        NOT NULL
 );
 -- !
-INSERT INTO Information VALUES (1, 'schema_version', '11');
+INSERT INTO Information VALUES (1, 'schema_version', '18');
 -- !
 CREATE TABLE IF NOT EXISTS Accounts (
   id              INTEGER     PRIMARY KEY,
@@ -72,6 +72,9 @@ CREATE TABLE IF NOT EXISTS Categories (
   icon            BLOB,
   account_id      INTEGER     NOT NULL,
   custom_id       TEXT,
+  retention_count INTEGER     NOT NULL DEFAULT 0 CHECK (retention_count >= 0),
+  retention_days  INTEGER     NOT NULL DEFAULT 0 CHECK (retention_days >= 0),
+  retention_keep_important INTEGER(1) NOT NULL DEFAULT 1 CHECK (retention_keep_important >= 0 AND retention_keep_important <= 1),
   
   FOREIGN KEY (account_id) REFERENCES Accounts (id)
 );
@@ -95,6 +98,11 @@ CREATE TABLE IF NOT EXISTS Feeds (
   type            INTEGER,
   account_id      INTEGER     NOT NULL,
   custom_id       TEXT,
+  http_etag       TEXT,
+  http_last_modified TEXT,
+  retention_count INTEGER     NOT NULL DEFAULT 0 CHECK (retention_count >= 0),
+  retention_days  INTEGER     NOT NULL DEFAULT 0 CHECK (retention_days >= 0),
+  retention_keep_important INTEGER(1) NOT NULL DEFAULT 1 CHECK (retention_keep_important >= 0 AND retention_keep_important <= 1),
   
   FOREIGN KEY (account_id) REFERENCES Accounts (id)
 );
@@ -117,6 +125,70 @@ CREATE TABLE IF NOT EXISTS Messages (
   account_id      INTEGER     NOT NULL,
   custom_id       TEXT,
   custom_hash     TEXT,
+  identity_hash   INTEGER,
+  content_hash    INTEGER,
+  compressed_contents BLOB,
   
   FOREIGN KEY (account_id) REFERENCES Accounts (id)
-);
\ No newline at end of file
+);
+-- !
+CREATE INDEX IF NOT EXISTS idx_messages_feed ON Messages (account_id, feed, is_deleted, is_pdeleted, is_read);
+-- !
+CREATE INDEX IF NOT EXISTS idx_messages_custom_id ON Messages (account_id, custom_id);
+-- !
+CREATE INDEX IF NOT EXISTS idx_feeds_custom_id ON Feeds (account_id, custom_id);
+-- !
+CREATE INDEX IF NOT EXISTS idx_messages_identity_hash ON Messages (account_id, feed, identity_hash);
+-- !
+CREATE INDEX IF NOT EXISTS idx_messages_feed_date ON Messages (account_id, feed, date_created);
+-- !
+CREATE TABLE IF NOT EXISTS FeedCounters (
+  account_id        INTEGER     NOT NULL,
+  feed              TEXT        NOT NULL,
+  unread_count      INTEGER     NOT NULL DEFAULT 0,
+  total_count       INTEGER     NOT NULL DEFAULT 0,
+  bin_unread_count  INTEGER     NOT NULL DEFAULT 0,
+  bin_total_count   INTEGER     NOT NULL DEFAULT 0,
+  
+  PRIMARY KEY (account_id, feed)
+);
+-- !
+CREATE TRIGGER IF NOT EXISTS trg_messages_counters_insert AFTER INSERT ON Messages
+BEGIN
+  INSERT OR IGNORE INTO FeedCounters (account_id, feed) VALUES (NEW.account_id, NEW.feed);
+  UPDATE FeedCounters SET
+      unread_count = unread_count + (NEW.is_deleted = 0 AND NEW.is_pdeleted = 0 AND NEW.is_read = 0),
+      total_count = total_count + (NEW.is_deleted = 0 AND NEW.is_pdeleted = 0),
+      bin_unread_count = bin_unread_count + (NEW.is_deleted = 1 AND NEW.is_pdeleted = 0 AND NEW.is_read = 0),
+      bin_total_count = bin_total_count + (NEW.is_deleted = 1 AND NEW.is_pdeleted = 0)
+    WHERE account_id = NEW.account_id AND feed = NEW.feed;
+END;
+-- !
+CREATE TRIGGER IF NOT EXISTS trg_messages_counters_delete AFTER DELETE ON Messages
+BEGIN
+  UPDATE FeedCounters SET
+      unread_count = unread_count - (OLD.is_deleted = 0 AND OLD.is_pdeleted = 0 AND OLD.is_read = 0),
+      total_count = total_count - (OLD.is_deleted = 0 AND OLD.is_pdeleted = 0),
+      bin_unread_count = bin_unread_count - (OLD.is_deleted = 1 AND OLD.is_pdeleted = 0 AND OLD.is_read = 0),
+      bin_total_count = bin_total_count - (OLD.is_deleted = 1 AND OLD.is_pdeleted = 0)
+    WHERE account_id = OLD.account_id AND feed = OLD.feed;
+END;
+-- !
+CREATE TRIGGER IF NOT EXISTS trg_messages_counters_update AFTER UPDATE OF is_read, is_deleted, is_pdeleted, feed, account_id ON Messages
+WHEN OLD.is_read <> NEW.is_read OR OLD.is_deleted <> NEW.is_deleted OR OLD.is_pdeleted <> NEW.is_pdeleted OR
+     OLD.feed IS NOT NEW.feed OR OLD.account_id <> NEW.account_id
+BEGIN
+  UPDATE FeedCounters SET
+      unread_count = unread_count - (OLD.is_deleted = 0 AND OLD.is_pdeleted = 0 AND OLD.is_read = 0),
+      total_count = total_count - (OLD.is_deleted = 0 AND OLD.is_pdeleted = 0),
+      bin_unread_count = bin_unread_count - (OLD.is_deleted = 1 AND OLD.is_pdeleted = 0 AND OLD.is_read = 0),
+      bin_total_count = bin_total_count - (OLD.is_deleted = 1 AND OLD.is_pdeleted = 0)
+    WHERE account_id = OLD.account_id AND feed = OLD.feed;
+  INSERT OR IGNORE INTO FeedCounters (account_id, feed) VALUES (NEW.account_id, NEW.feed);
+  UPDATE FeedCounters SET
+      unread_count = unread_count + (NEW.is_deleted = 0 AND NEW.is_pdeleted = 0 AND NEW.is_read = 0),
+      total_count = total_count + (NEW.is_deleted = 0 AND NEW.is_pdeleted = 0),
+      bin_unread_count = bin_unread_count + (NEW.is_deleted = 1 AND NEW.is_pdeleted = 0 AND NEW.is_read = 0),
+      bin_total_count = bin_total_count + (NEW.is_deleted = 1 AND NEW.is_pdeleted = 0)
+    WHERE account_id = NEW.account_id AND feed = NEW.feed;
+END;
\ No newline at end of file
@@ -0,0 +1,7 @@
+CREATE INDEX idx_messages_feed ON Messages (account_id, feed(100), is_deleted, is_pdeleted, is_read);
+-- !
+CREATE INDEX idx_messages_custom_id ON Messages (account_id, custom_id(100));
+-- !
+CREATE INDEX idx_feeds_custom_id ON Feeds (account_id, custom_id(100));
+-- !
+UPDATE Information SET inf_value = '13' WHERE inf_key = 'schema_version';
\ No newline at end of file
@@ -0,0 +1,3 @@
+UPDATE Messages SET custom_id = id WHERE custom_id IS NULL OR custom_id = '';
+-- !
+UPDATE Information SET inf_value = '14' WHERE inf_key = 'schema_version';
\ No newline at end of file
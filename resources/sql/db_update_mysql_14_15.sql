@@ -0,0 +1,7 @@
+ALTER TABLE Messages ADD COLUMN identity_hash BIGINT;
+-- !
+ALTER TABLE Messages ADD COLUMN content_hash BIGINT;
+-- !
+CREATE INDEX idx_messages_identity_hash ON Messages (account_id, feed(100), identity_hash);
+-- !
+UPDATE Information SET inf_value = '15' WHERE inf_key = 'schema_version';
\ No newline at end of file
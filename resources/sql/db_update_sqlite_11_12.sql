@@ -0,0 +1,7 @@
+ALTER TABLE Feeds
+ADD COLUMN http_etag  TEXT;
+-- !
+ALTER TABLE Feeds
+ADD COLUMN http_last_modified  TEXT;
+-- !
+UPDATE Information SET inf_value = '12' WHERE inf_key = 'schema_version';
\ No newline at end of file
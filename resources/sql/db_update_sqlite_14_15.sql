@@ -0,0 +1,7 @@
+ALTER TABLE Messages ADD COLUMN identity_hash INTEGER;
+-- !
+ALTER TABLE Messages ADD COLUMN content_hash INTEGER;
+-- !
+CREATE INDEX IF NOT EXISTS idx_messages_identity_hash ON Messages (account_id, feed, identity_hash);
+-- !
+UPDATE Information SET inf_value = '15' WHERE inf_key = 'schema_version';
\ No newline at end of file
@@ -0,0 +1,15 @@
+ALTER TABLE Feeds ADD COLUMN retention_count INTEGER NOT NULL DEFAULT 0;
+-- !
+ALTER TABLE Feeds ADD COLUMN retention_days INTEGER NOT NULL DEFAULT 0;
+-- !
+ALTER TABLE Feeds ADD COLUMN retention_keep_important INTEGER(1) NOT NULL DEFAULT 1;
+-- !
+ALTER TABLE Categories ADD COLUMN retention_count INTEGER NOT NULL DEFAULT 0;
+-- !
+ALTER TABLE Categories ADD COLUMN retention_days INTEGER NOT NULL DEFAULT 0;
+-- !
+ALTER TABLE Categories ADD COLUMN retention_keep_important INTEGER(1) NOT NULL DEFAULT 1;
+-- !
+CREATE INDEX IF NOT EXISTS idx_messages_feed_date ON Messages (account_id, feed, date_created);
+-- !
+UPDATE Information SET inf_value = '17' WHERE inf_key = 'schema_version';
\ No newline at end of file
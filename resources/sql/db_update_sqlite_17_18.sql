@@ -0,0 +1,3 @@
+ALTER TABLE Messages ADD COLUMN compressed_contents BLOB;
+-- !
+UPDATE Information SET inf_value = '18' WHERE inf_key = 'schema_version';
\ No newline at end of file
@@ -3,25 +3,67 @@
 #include "core/feeddownloader.h"
 
 #include "definitions/definitions.h"
+#include "miscellaneous/application.h"
+#include "core/feedsmodel.h"
+#include "miscellaneous/databasequeries.h"
+#include "miscellaneous/feedreader.h"
+#include "miscellaneous/settings.h"
+#include "network-web/downloader.h"
+#include "network-web/networkfactory.h"
+#include "network-web/silentnetworkaccessmanager.h"
 #include "services/abstract/cacheforserviceroot.h"
 #include "services/abstract/feed.h"
+#include "services/abstract/recyclebin.h"
+#include "services/abstract/serviceroot.h"
 
+#include <QDateTime>
 #include <QDebug>
 #include <QMessageBox>
 #include <QMessageLogger>
 #include <QMutexLocker>
+#include <QSet>
+#include <QSqlError>
+#include <QSqlQuery>
 #include <QString>
 #include <QThread>
 #include <QThreadPool>
+#include <QTimer>
+#include <QUrl>
+#include <QVector>
+
+#include <algorithm>
+#include <functional>
 
 FeedDownloader::FeedDownloader(QObject* parent)
-  : QObject(parent), m_mutex(new QMutex()), m_threadPool(new QThreadPool(this)),
-  m_feedsUpdated(0), m_feedsUpdating(0), m_feedsOriginalCount(0) {
+  : QObject(parent), m_mutex(new QMutex()), m_threadPool(new QThreadPool(this)), m_parserPool(new QThreadPool(this)),
+  m_pendingMessagesCount(0), m_commitTimer(new QTimer(this)), m_writerThread(new QThread(this)),
+  m_writer(new FeedUpdateWriter()), m_commitRunning(false), m_feedsUpdated(0), m_feedsUpdating(0), m_feedsOriginalCount(0),
+  m_updateStopped(false), m_dispatchTimer(new QTimer(this)),
+  m_random(std::random_device()()), m_bandwidthLimit(0), m_bandwidthTokens(0.0), m_bandwidthRefill(0) {
   qRegisterMetaType<FeedDownloadResults>("FeedDownloadResults");
+  qRegisterMetaType<Feed::ObtainedHints>("Feed::ObtainedHints");
+  qRegisterMetaType<QList<PendingFeedUpdate>>("QList<PendingFeedUpdate>");
+
+  m_commitTimer->setInterval(FEED_DOWNLOADER_COMMIT_INTERVAL);
+  m_commitTimer->setSingleShot(true);
+  connect(m_commitTimer, &QTimer::timeout, this, &FeedDownloader::onCommitTimeout);
+
+  m_dispatchTimer->setSingleShot(true);
+  connect(m_dispatchTimer, &QTimer::timeout, this, &FeedDownloader::onDispatchTimeout);
+
+  // Only feeds which cannot be downloaded asynchronously block these threads.
   m_threadPool->setMaxThreadCount(2);
+
+  m_writer->moveToThread(m_writerThread);
+  connect(m_writerThread, &QThread::finished, m_writer, &FeedUpdateWriter::deleteLater);
+  connect(this, &FeedDownloader::commitRequested, m_writer, &FeedUpdateWriter::storeUpdates);
+  connect(m_writer, &FeedUpdateWriter::updatesStored, this, &FeedDownloader::onUpdatesCommitted);
+  m_writerThread->start();
 }
 
 FeedDownloader::~FeedDownloader() {
+  m_writerThread->quit();
+  m_writerThread->wait();
   m_mutex->tryLock();
   m_mutex->unlock();
   delete m_mutex;
@@ -33,45 +75,170 @@ bool FeedDownloader::isUpdateRunning() const {
 }
 
 void FeedDownloader::updateAvailableFeeds() {
-  foreach (const Feed* feed, m_feeds) {
-    auto* cache = dynamic_cast<CacheForServiceRoot*>(feed->getParentServiceRoot());
-
-    if (cache != nullptr) {
-      qDebug("Saving cache for feed with DB ID %d and title '%s'.", feed->id(), qPrintable(feed->title()));
-      cache->saveAllCachedData(false);
+  const qint64 now = QDateTime::currentMSecsSinceEpoch();
+  const qint64 bandwidth_wait = bandwidthWaitTime(now);
+  qint64 next_attempt = 0;
+  QList<Feed*> skipped_feeds;
+
+  for (int i = 0; i < m_feeds.size();) {
+    Feed* feed = m_feeds.at(i);
+
+    if (feed->supportsAsynchronousUpdate()) {
+      if (m_downloads.size() >= FEED_DOWNLOADER_MAX_DOWNLOADS) {
+        // All download slots are occupied, feed stays queued.
+        i++;
+        continue;
+      }
+
+      HostState& host = m_hosts[hostOfFeed(feed)];
+
+      if (host.m_notBefore - now > FEED_DOWNLOADER_MAX_HOLD_OFF) {
+        // Host does not want to be contacted for long time, so
+        // the feed is skipped in this update.
+        m_feeds.removeAt(i);
+        skipped_feeds.append(feed);
+        continue;
+      }
+
+      if (host.m_downloads >= FEED_DOWNLOADER_MAX_HOST_DOWNLOADS) {
+        // Feed waits for other downloads from its host to finish.
+        i++;
+        continue;
+      }
+
+      const qint64 wait = qMax(hostWaitTime(host, now), bandwidth_wait);
+
+      if (wait > 0) {
+        // Feed waits for its turn.
+        next_attempt = next_attempt > 0 ? qMin(next_attempt, now + wait) : now + wait;
+        i++;
+        continue;
+      }
+
+      host.m_tokens -= 1.0;
+      host.m_downloads++;
+      host.m_notBefore = now + std::uniform_int_distribution<int>(0, FEED_DOWNLOADER_HOST_JITTER)(m_random);
+
+      Downloader* downloader = feed->startAsynchronousUpdate();
+
+      connect(downloader, &Downloader::completed, this, &FeedDownloader::oneFeedDownloadFinished);
+      m_downloads.insert(downloader, feed);
+    }
+    else {
+      connect(feed, &Feed::messagesObtained, this, &FeedDownloader::oneFeedUpdateFinished,
+              (Qt::ConnectionType)(Qt::UniqueConnection | Qt::AutoConnection));
+
+      if (!m_threadPool->tryStart(feed)) {
+        // All working threads are occupied, feed stays queued.
+        i++;
+        continue;
+      }
     }
+
+    m_feeds.removeAt(i);
+    m_feedsUpdating++;
   }
 
-  while (!m_feeds.isEmpty()) {
-    connect(m_feeds.first(), &Feed::messagesObtained, this, &FeedDownloader::oneFeedUpdateFinished,
-            (Qt::ConnectionType)(Qt::UniqueConnection | Qt::AutoConnection));
+  if (next_attempt > 0) {
+    m_dispatchTimer->start(int(qMax(next_attempt - now, qint64(10))));
+  }
 
-    if (m_threadPool->tryStart(m_feeds.first())) {
-      m_feeds.removeFirst();
-      m_feedsUpdating++;
-    }
-    else {
-      qCritical("User wanted to update some feeds but all working threads are occupied.");
+  // Skipped feeds are counted as updated, their status does not change.
+  for (const Feed* feed : skipped_feeds) {
+    qWarning("Skipping update of feed '%s' because its host asked not to be contacted now.", qPrintable(feed->url()));
+    m_feedsUpdating++;
+  }
 
-      // We want to start update of some feeds but all working threads are occupied.
-      break;
-    }
+  for (Feed* feed : skipped_feeds) {
+    oneFeedFinished(feed);
+  }
+}
+
+qint64 FeedDownloader::hostWaitTime(HostState& host, qint64 now) const {
+  if (host.m_lastRefill <= 0) {
+    host.m_tokens = FEED_DOWNLOADER_HOST_BURST;
+  }
+  else {
+    host.m_tokens = qMin(double(FEED_DOWNLOADER_HOST_BURST),
+                         host.m_tokens + (now - host.m_lastRefill) * FEED_DOWNLOADER_HOST_RATE / 1000.0);
   }
+
+  host.m_lastRefill = now;
+
+  const qint64 token_wait = host.m_tokens >= 1.0 ? 0 : qint64((1.0 - host.m_tokens) * 1000.0 / FEED_DOWNLOADER_HOST_RATE) + 1;
+
+  return qMax(host.m_notBefore - now, token_wait);
+}
+
+qint64 FeedDownloader::bandwidthWaitTime(qint64 now) {
+  if (m_bandwidthLimit <= 0) {
+    return 0;
+  }
+
+  // Budget refills continuously and can be saved for at most one second.
+  m_bandwidthTokens = qMin(double(m_bandwidthLimit), m_bandwidthTokens + (now - m_bandwidthRefill) * m_bandwidthLimit / 1000.0);
+  m_bandwidthRefill = now;
+
+  return m_bandwidthTokens >= 0.0 ? 0 : qint64(-m_bandwidthTokens * 1000.0 / m_bandwidthLimit) + 1;
+}
+
+qint64 FeedDownloader::holdOffHost(HostState& host, const Downloader* downloader, qint64 now) {
+  const QDateTime retry_after = NetworkFactory::retryAfterTime(downloader->lastRawHeader(HTTP_HEADERS_RETRY_AFTER));
+  qint64 hold_off;
+
+  host.m_throttled++;
+
+  if (retry_after.isValid()) {
+    hold_off = qMax(retry_after.toMSecsSinceEpoch() - now, qint64(FEED_DOWNLOADER_HOST_JITTER));
+  }
+  else {
+    // Each consecutive refusal doubles the time.
+    hold_off = qint64(FEED_DOWNLOADER_HOLD_OFF) << qMin(host.m_throttled - 1, 6);
+  }
+
+  host.m_tokens = 0.0;
+  host.m_notBefore = qMax(host.m_notBefore, now + hold_off);
+  return hold_off;
+}
+
+QString FeedDownloader::hostOfFeed(const Feed* feed) {
+  return QUrl(feed->url()).host().toLower();
 }
 
 void FeedDownloader::updateFeeds(const QList<Feed*>& feeds) {
   QMutexLocker locker(m_mutex);
 
   if (feeds.isEmpty()) {
-    qDebug("No feeds to update in worker thread, aborting update.");
-    finalizeUpdate();
+    if (!isUpdateRunning()) {
+      qDebug("No feeds to update in worker thread, aborting update.");
+      finalizeUpdate();
+    }
+  }
+  else if (isUpdateRunning()) {
+    // Feeds are updated together with feeds of running update.
+    qDebug("Adding %d feeds to running update.", feeds.size());
+    m_updateStopped = false;
+    m_feeds.append(feeds);
+    m_feedsOriginalCount += feeds.size();
+    saveCaches(feeds);
+    updateAvailableFeeds();
   }
   else {
     qDebug().nospace() << "Starting feed updates from worker in thread: \'" << QThread::currentThreadId() << "\'.";
     m_feeds = feeds;
     m_feedsOriginalCount = m_feeds.size();
     m_results.clear();
+    m_retriedFeeds.clear();
+    m_updateStopped = false;
     m_feedsUpdated = m_feedsUpdating = 0;
+    m_updateTimer.start();
+
+    // Limit is given in KiB/s.
+    m_bandwidthLimit = qint64(qApp->settings()->value(GROUP(Feeds), SETTING(Feeds::UpdateBandwidthLimit)).toInt()) * 1024;
+    m_bandwidthTokens = m_bandwidthLimit;
+    m_bandwidthRefill = QDateTime::currentMSecsSinceEpoch();
+
+    saveCaches(m_feeds);
 
     // Job starts now.
     emit updateStarted();
@@ -80,46 +247,336 @@ void FeedDownloader::updateFeeds(const QList<Feed*>& feeds) {
   }
 }
 
+void FeedDownloader::saveCaches(const QList<Feed*>& feeds) {
+  QSet<CacheForServiceRoot*> caches;
+
+  foreach (const Feed* feed, feeds) {
+    auto* cache = dynamic_cast<CacheForServiceRoot*>(feed->getParentServiceRoot());
+
+    if (cache != nullptr && !caches.contains(cache)) {
+      qDebug("Saving cache for feed with DB ID %d and title '%s'.", feed->id(), qPrintable(feed->title()));
+      cache->saveAllCachedData(false);
+      caches.insert(cache);
+    }
+  }
+}
+
 void FeedDownloader::stopRunningUpdate() {
+  QMutexLocker locker(m_mutex);
+
   m_threadPool->clear();
   m_feeds.clear();
+  m_dispatchTimer->stop();
+  m_updateStopped = true;
+
+  // Replies of active downloads are aborted when their
+  // downloaders are destroyed, feeds keep their status.
+  const QList<Downloader*> downloaders = m_downloads.keys();
+
+  for (Downloader* downloader : downloaders) {
+    Feed* feed = m_downloads.take(downloader);
+
+    disconnect(downloader, nullptr, this, nullptr);
+    delete downloader;
+    m_hosts[hostOfFeed(feed)].m_downloads--;
+    qDebug("Download of feed '%s' was aborted.", qPrintable(feed->url()));
+    oneFeedFinished(feed);
+  }
+
+  // Messages which were obtained before update was stopped are kept.
+  commitPendingUpdates();
 }
 
-void FeedDownloader::oneFeedUpdateFinished(const QList<Message>& messages, bool error_during_obtaining) {
+void FeedDownloader::oneFeedUpdateFinished(const QList<Message>& messages, bool error_during_obtaining,
+                                           const Feed::ObtainedHints& hints) {
   QMutexLocker locker(m_mutex);
-
-  m_feedsUpdated++;
-  m_feedsUpdating--;
   Feed* feed = qobject_cast<Feed*>(sender());
 
   disconnect(feed, &Feed::messagesObtained, this, &FeedDownloader::oneFeedUpdateFinished);
 
+  if (m_updateStopped) {
+    oneFeedFinished(feed);
+    return;
+  }
+
   // Now, we check if there are any feeds we would like to update too.
   updateAvailableFeeds();
+  feed->applyObtainedHints(hints);
 
-  // Now make sure, that messages are actually stored to SQL in a locked state.
-  qDebug().nospace() << "Saving messages of feed ID "
-                     << feed->customId() << " URL: " << feed->url() << " title: " << feed->title() << " in thread: \'"
-                     << QThread::currentThreadId() << "\'.";
+  PendingFeedUpdate update;
+
+  update.m_feed = feed;
+  update.m_messages = messages;
+  update.m_errorDuringObtaining = error_during_obtaining;
+
+  // Feed keeps its validators.
+  update.m_httpETag = feed->httpETag();
+  update.m_httpLastModified = feed->httpLastModified();
+
+  storeMessages(update);
+}
+
+void FeedDownloader::oneFeedDownloadFinished(QNetworkReply::NetworkError status, const QByteArray& contents) {
+  QMutexLocker locker(m_mutex);
+  auto* downloader = qobject_cast<Downloader*>(sender());
+  Feed* feed = m_downloads.take(downloader);
+  HostState& host = m_hosts[hostOfFeed(feed)];
+  const qint64 now = QDateTime::currentMSecsSinceEpoch();
+  const int http_code = downloader->lastHttpStatusCode();
+
+  downloader->deleteLater();
+  host.m_downloads--;
+
+  if (m_bandwidthLimit > 0) {
+    bandwidthWaitTime(now);
+    m_bandwidthTokens -= contents.size();
+  }
+
+  if (http_code == HTTP_CODE_TOO_MANY_REQUESTS || http_code == HTTP_CODE_UNAVAILABLE) {
+    const qint64 hold_off = holdOffHost(host, downloader, now);
+
+    qWarning("Host '%s' refused to serve feed '%s' with code %d, it will not be contacted for %lld ms.",
+             qPrintable(hostOfFeed(feed)), qPrintable(feed->url()), http_code, hold_off);
+
+    if (!m_retriedFeeds.contains(feed) && hold_off <= FEED_DOWNLOADER_MAX_HOLD_OFF) {
+      // Feed is tried once more when host allows it.
+      m_retriedFeeds.insert(feed);
+      m_feeds.append(feed);
+      m_feedsUpdating--;
+      updateAvailableFeeds();
+    }
+    else {
+      // Feed keeps its status, host is just busy.
+      updateAvailableFeeds();
+      oneFeedFinished(feed);
+    }
+
+    return;
+  }
+  else if (http_code > 0) {
+    host.m_throttled = 0;
+  }
+
+  // Download slot is free now, so we start downloading of next feeds
+  // and hand obtained data over to parsing stage.
+  updateAvailableFeeds();
+
+  // Server tells us how often the feed should be downloaded.
+  Feed::UpdateHints hints = feed->updateHints();
+
+  hints.m_cacheInterval = NetworkFactory::cacheControlMaxAge(downloader->lastRawHeader(HTTP_HEADERS_CACHE_CONTROL));
+  hints.m_retryAfter = NetworkFactory::retryAfterTime(downloader->lastRawHeader(HTTP_HEADERS_RETRY_AFTER));
+
+  if (status == QNetworkReply::NoError && downloader->lastHttpStatusCode() == HTTP_CODE_NOT_MODIFIED) {
+    hints.m_idleUpdates++;
+  }
+
+  feed->setUpdateHints(hints);
+
+  if (status == QNetworkReply::NoError && downloader->lastHttpStatusCode() == HTTP_CODE_NOT_MODIFIED) {
+    // Feed did not change since last update, there is nothing to parse or store.
+    qDebug("Feed '%s' was not modified since last update.", qPrintable(feed->url()));
+    m_results.appendConditionalHit();
+
+    if (feed->status() != Feed::Normal && feed->status() != Feed::NewMessages) {
+      feed->setStatus(Feed::Normal);
+      feed->getParentServiceRoot()->itemChanged(QList<RootItem*>() << feed);
+    }
+
+    oneFeedFinished(feed);
+    return;
+  }
+  else if (status == QNetworkReply::NoError) {
+    m_results.appendConditionalMiss();
+  }
+
+  auto* task = new FeedParsingTask(feed, status, contents, downloader->lastContentType().toString());
+
+  task->setHttpValidators(QString::fromLatin1(downloader->lastRawHeader(HTTP_HEADERS_ETAG)),
+                          QString::fromLatin1(downloader->lastRawHeader(HTTP_HEADERS_LAST_MODIFIED)));
+  connect(task, &FeedParsingTask::parsed, this, &FeedDownloader::oneFeedParsingFinished);
+  m_parserPool->start(task);
+}
+
+void FeedDownloader::oneFeedParsingFinished() {
+  QMutexLocker locker(m_mutex);
+  auto* task = qobject_cast<FeedParsingTask*>(sender());
+
+  task->deleteLater();
+
+  if (m_updateStopped) {
+    // Update was stopped while the feed was being parsed.
+    oneFeedFinished(task->feed());
+    return;
+  }
+
+  task->feed()->applyObtainedHints(task->hints());
+
+  PendingFeedUpdate update;
+
+  update.m_feed = task->feed();
+  update.m_messages = task->messages();
+  update.m_errorDuringObtaining = task->errorDuringObtaining();
+  update.m_httpETag = task->httpETag();
+  update.m_httpLastModified = task->httpLastModified();
+
+  storeMessages(update);
+}
+
+void FeedDownloader::onCommitTimeout() {
+  QMutexLocker locker(m_mutex);
+
+  commitPendingUpdates();
+}
+
+void FeedDownloader::onDispatchTimeout() {
+  QMutexLocker locker(m_mutex);
 
-  int updated_messages = feed->updateMessages(messages, error_during_obtaining);
+  updateAvailableFeeds();
+}
+
+void FeedDownloader::storeMessages(PendingFeedUpdate update) {
+  Feed* feed = update.m_feed;
+
+  update.m_feedId = feed->id();
+  update.m_feedCustomId = feed->customId();
+  update.m_feedUrl = feed->url();
+  update.m_accountId = feed->getParentServiceRoot()->accountId();
+  update.m_retentionPolicy = feed->effectiveRetentionPolicy();
+  update.m_storedHttpETag = feed->httpETag();
+  update.m_storedHttpLastModified = feed->httpLastModified();
+
+  m_pendingUpdates.append(update);
+  m_pendingMessagesCount += update.m_messages.size();
+
+  // Batch is committed if it is big enough or if there are
+  // no other feeds which could still join it.
+  if (m_pendingMessagesCount >= FEED_DOWNLOADER_COMMIT_MESSAGES ||
+      m_pendingUpdates.size() >= FEED_DOWNLOADER_COMMIT_FEEDS ||
+      (m_feeds.isEmpty() && m_pendingUpdates.size() >= m_feedsUpdating)) {
+    commitPendingUpdates();
+  }
+  else if (!m_commitTimer->isActive()) {
+    m_commitTimer->start();
+  }
+}
+
+void FeedDownloader::commitPendingUpdates() {
+  m_commitTimer->stop();
+
+  if (m_pendingUpdates.isEmpty() || m_commitRunning) {
+    // Updates which arrive while writer commits previous
+    // batch are committed right after it.
+    return;
+  }
+
+  const bool use_transactions = qApp->settings()->value(GROUP(Database), SETTING(Database::UseTransactions)).toBool();
+
+  m_commitRunning = true;
+  emit commitRequested(m_pendingUpdates, use_transactions);
+
+  m_pendingUpdates.clear();
+  m_pendingMessagesCount = 0;
+}
+
+void FeedDownloader::onUpdatesCommitted(const QList<PendingFeedUpdate>& updates) {
+  QMutexLocker locker(m_mutex);
 
-  qDebug("%d messages for feed %s stored in DB.", updated_messages, qPrintable(feed->customId()));
+  m_commitRunning = false;
+
+  for (const PendingFeedUpdate& update : updates) {
+    if (!update.m_errorDuringObtaining && !update.m_stored) {
+      // Writer cleared validators of the feed in DB.
+      update.m_feed->setHttpValidators(QString(), QString());
+    }
+  }
+
+  refreshUpdatedFeeds(updates);
+
+  for (const PendingFeedUpdate& update : updates) {
+    if (update.m_updatedMessages > 0) {
+      m_results.appendUpdatedFeed(QPair<QString, int>(update.m_feed->title(), update.m_updatedMessages));
+    }
+
+    oneFeedFinished(update.m_feed);
+  }
+
+  commitPendingUpdates();
+}
+
+void FeedDownloader::refreshUpdatedFeeds(const QList<PendingFeedUpdate>& updates) {
+  QHash<ServiceRoot*, QList<Feed*>> feeds_to_count;
+  QList<RootItem*> changed_items;
+
+  for (const PendingFeedUpdate& update : updates) {
+    Feed* feed = update.m_feed;
+    ServiceRoot* root = feed->getParentServiceRoot();
+
+    if (update.m_errorDuringObtaining) {
+      qCritical("There is indication that there was error during messages obtaining of feed '%s'.", qPrintable(feed->customId()));
+    }
+    else if (update.m_stored) {
+      Feed::UpdateHints hints = feed->updateHints();
+
+      hints.m_idleUpdates = update.m_anythingUpdated ? 0 : hints.m_idleUpdates + 1;
+      feed->setUpdateHints(hints);
+      feed->setStatus(update.m_updatedMessages > 0 ? Feed::NewMessages : Feed::Normal);
+      feed->setHttpValidators(update.m_httpETag, update.m_httpLastModified);
+
+      if (update.m_anythingUpdated) {
+        // Only feeds whose messages changed need new counts.
+        feeds_to_count[root].append(feed);
+
+        if (root->recycleBin() != nullptr && !changed_items.contains(root->recycleBin())) {
+          changed_items.append(root->recycleBin());
+        }
+      }
+    }
 
-  if (updated_messages > 0) {
-    m_results.appendUpdatedFeed(QPair<QString, int>(feed->title(), updated_messages));
+    changed_items.append(feed);
   }
 
+  // Counts of all touched feeds of each account are obtained
+  // by single query.
+  for (auto i = feeds_to_count.constBegin(); i != feeds_to_count.constEnd(); i++) {
+    i.key()->updateFeedCounts(i.value(), true);
+
+    if (i.key()->recycleBin() != nullptr) {
+      i.key()->recycleBin()->updateCounts(true);
+    }
+  }
+
+  // Model is notified about all changed items at once.
+  FeedsModel* feeds_model = qApp->feedReader()->feedsModel();
+
+  feeds_model->reloadChangedItems(changed_items);
+  feeds_model->notifyWithCounts();
+}
+
+void FeedDownloader::oneFeedFinished(Feed* feed) {
+  m_feedsUpdated++;
+  m_feedsUpdating--;
+
   qDebug("Made progress in feed updates, total feeds count %d/%d (id of feed is %d).", m_feedsUpdated, m_feedsOriginalCount, feed->id());
   emit updateProgress(feed, m_feedsUpdated, m_feedsOriginalCount);
 
   if (m_feeds.isEmpty() && m_feedsUpdating <= 0) {
     finalizeUpdate();
   }
+  else if (m_feeds.isEmpty() && !m_pendingUpdates.isEmpty() && m_pendingUpdates.size() >= m_feedsUpdating) {
+    // Feed finished without storing any messages, for example it was not
+    // modified, and all remaining feeds just wait for commit.
+    commitPendingUpdates();
+  }
 }
 
 void FeedDownloader::finalizeUpdate() {
-  qDebug().nospace() << "Finished feed updates in thread: \'" << QThread::currentThreadId() << "\'.";
+  qDebug().nospace() << "Finished feed updates in thread: \'" << QThread::currentThreadId() << "\', took "
+                     << (m_updateTimer.isValid() ? m_updateTimer.elapsed() : 0) << " ms.";
+  qDebug("Conditional requests: %d feeds not modified, %d feeds downloaded.",
+         m_results.conditionalHits(), m_results.conditionalMisses());
+  qDebug("Shared network managers served %d requests over %d new secure connections so far.",
+         SilentNetworkAccessManager::requestsServed(), SilentNetworkAccessManager::connectionsOpened());
   m_results.sort();
 
   // Update of feeds has finished.
@@ -129,6 +586,177 @@ void FeedDownloader::finalizeUpdate() {
   emit updateFinished(m_results);
 }
 
+FeedUpdateWriter::FeedUpdateWriter(QObject* parent) : QObject(parent) {}
+
+void FeedUpdateWriter::storeUpdates(QList<PendingFeedUpdate> updates, bool use_transactions) {
+  QSqlDatabase database = qApp->database()->connection(metaObject()->className());
+  QSqlQuery query_begin_transaction(database);
+  QElapsedTimer commit_timer;
+
+  commit_timer.start();
+
+  // Now make sure, that messages are actually stored to SQL in a locked state.
+  qDebug().nospace() << "Saving messages of " << updates.size() << " feeds in thread: \'"
+                     << QThread::currentThreadId() << "\'.";
+
+  const bool in_transaction = use_transactions && query_begin_transaction.exec(qApp->database()->obtainBeginTransactionSql());
+
+  if (use_transactions && !in_transaction) {
+    qCritical("Transaction start for batch of feed updates failed: '%s'.", qPrintable(query_begin_transaction.lastError().text()));
+  }
+
+  for (PendingFeedUpdate& update : updates) {
+    if (update.m_errorDuringObtaining) {
+      continue;
+    }
+
+    update.m_updatedMessages = storeMessages(database, update, &update.m_anythingUpdated, &update.m_stored);
+
+    // Remember validators so that next update of the feed can be conditional.
+    // Validators are stored only if all messages of the feed were stored.
+    if (update.m_stored && (update.m_httpETag != update.m_storedHttpETag ||
+                            update.m_httpLastModified != update.m_storedHttpLastModified)) {
+      DatabaseQueries::updateFeedHttpValidators(database, update.m_feedId, update.m_httpETag, update.m_httpLastModified);
+    }
+
+    update.m_messages.clear();
+  }
+
+  if (in_transaction && !database.commit()) {
+    qCritical("Transaction commit for batch of feed updates failed: '%s'.", qPrintable(database.lastError().text()));
+    database.rollback();
+
+    for (PendingFeedUpdate& update : updates) {
+      update.m_stored = false;
+      update.m_updatedMessages = 0;
+    }
+  }
+
+  // Feeds whose messages were not stored completely lose their validators,
+  // so that their next download is unconditional and does not end with
+  // "not modified" response.
+  for (const PendingFeedUpdate& update : updates) {
+    if (!update.m_errorDuringObtaining && !update.m_stored &&
+        (!update.m_storedHttpETag.isEmpty() || !update.m_storedHttpLastModified.isEmpty())) {
+      qWarning("Messages of feed '%s' were not stored completely, its HTTP validators are cleared.",
+               qPrintable(update.m_feedUrl));
+      DatabaseQueries::updateFeedHttpValidators(database, update.m_feedId, QString(), QString());
+    }
+  }
+
+  qDebug("Messages of %d feeds stored in DB in %lld ms.", updates.size(), commit_timer.elapsed());
+
+  // Retention policies are applied only after messages are committed,
+  // each feed removes just limited number of its old messages.
+  for (PendingFeedUpdate& update : updates) {
+    if (update.m_stored && update.m_retentionPolicy.isActive() &&
+        DatabaseQueries::applyRetentionPolicy(database, update.m_feedCustomId, update.m_accountId, update.m_retentionPolicy) > 0) {
+      update.m_anythingUpdated = true;
+    }
+  }
+
+  emit updatesStored(updates);
+}
+
+int FeedUpdateWriter::storeMessages(const QSqlDatabase& database, const PendingFeedUpdate& update,
+                                    bool* anything_updated, bool* ok) const {
+  QList<Message> messages_to_store = update.m_messages;
+
+  // Messages which would be removed by retention policy right away
+  // are not stored at all, so that they are not added again and again.
+  if (update.m_retentionPolicy.m_maxAgeDays > 0) {
+    const QDateTime oldest_date = QDateTime::currentDateTimeUtc().addDays(-update.m_retentionPolicy.m_maxAgeDays);
+
+    for (int i = messages_to_store.size() - 1; i >= 0; i--) {
+      const Message& message = messages_to_store.at(i);
+
+      if (message.m_created < oldest_date && !(update.m_retentionPolicy.m_keepImportant && message.m_isImportant)) {
+        messages_to_store.removeAt(i);
+      }
+    }
+  }
+
+  // Same goes for messages which are older than the newest messages
+  // allowed by the policy.
+  if (update.m_retentionPolicy.m_keepCount > 0 && messages_to_store.size() > update.m_retentionPolicy.m_keepCount) {
+    QVector<qint64> dates;
+
+    dates.reserve(messages_to_store.size());
+
+    for (const Message& message : messages_to_store) {
+      dates.append(message.m_created.toMSecsSinceEpoch());
+    }
+
+    std::nth_element(dates.begin(), dates.begin() + update.m_retentionPolicy.m_keepCount - 1, dates.end(), std::greater<qint64>());
+
+    const qint64 oldest_date = dates.at(update.m_retentionPolicy.m_keepCount - 1);
+
+    for (int i = messages_to_store.size() - 1; i >= 0; i--) {
+      const Message& message = messages_to_store.at(i);
+
+      if (message.m_created.toMSecsSinceEpoch() < oldest_date &&
+          !(update.m_retentionPolicy.m_keepImportant && message.m_isImportant)) {
+        messages_to_store.removeAt(i);
+      }
+    }
+  }
+
+  if (messages_to_store.isEmpty()) {
+    qWarning("There are no messages for update.");
+    *anything_updated = false;
+    *ok = true;
+    return 0;
+  }
+
+  qDebug("There are some messages to be updated/added to DB.");
+  return DatabaseQueries::updateMessages(database, messages_to_store, update.m_feedCustomId, update.m_accountId,
+                                         update.m_feedUrl, anything_updated, ok);
+}
+
+FeedParsingTask::FeedParsingTask(Feed* feed, QNetworkReply::NetworkError network_error,
+                                 const QByteArray& data, const QString& content_type, QObject* parent)
+  : QObject(parent), m_feed(feed), m_networkError(network_error), m_data(data), m_contentType(content_type),
+  m_errorDuringObtaining(false) {
+  setAutoDelete(false);
+}
+
+Feed* FeedParsingTask::feed() const {
+  return m_feed;
+}
+
+QList<Message> FeedParsingTask::messages() const {
+  return m_messages;
+}
+
+bool FeedParsingTask::errorDuringObtaining() const {
+  return m_errorDuringObtaining;
+}
+
+Feed::ObtainedHints FeedParsingTask::hints() const {
+  return m_hints;
+}
+
+QString FeedParsingTask::httpETag() const {
+  return m_httpETag;
+}
+
+QString FeedParsingTask::httpLastModified() const {
+  return m_httpLastModified;
+}
+
+void FeedParsingTask::setHttpValidators(const QString& etag, const QString& last_modified) {
+  m_httpETag = etag;
+  m_httpLastModified = last_modified;
+}
+
+void FeedParsingTask::run() {
+  m_messages = m_feed->messagesFromDownloadedData(m_networkError, m_data, m_contentType, &m_errorDuringObtaining, &m_hints);
+
+  // Raw data are not needed anymore.
+  m_data.clear();
+  emit parsed();
+}
+
 QString FeedDownloadResults::overview(int how_many_feeds) const {
   QStringList result;
 
@@ -159,6 +787,23 @@ bool FeedDownloadResults::lessThan(const QPair<QString, int>& lhs, const QPair<Q
 
 void FeedDownloadResults::clear() {
   m_updatedFeeds.clear();
+  m_conditionalHits = m_conditionalMisses = 0;
+}
+
+int FeedDownloadResults::conditionalHits() const {
+  return m_conditionalHits;
+}
+
+int FeedDownloadResults::conditionalMisses() const {
+  return m_conditionalMisses;
+}
+
+void FeedDownloadResults::appendConditionalHit() {
+  m_conditionalHits++;
+}
+
+void FeedDownloadResults::appendConditionalMiss() {
+  m_conditionalMisses++;
 }
 
 QList<QPair<QString, int>> FeedDownloadResults::updatedFeeds() const {
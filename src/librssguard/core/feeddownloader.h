@@ -5,13 +5,24 @@
 
 #include <QObject>
 
+#include <QElapsedTimer>
+#include <QHash>
+#include <QNetworkReply>
 #include <QPair>
+#include <QRunnable>
+#include <QSet>
+#include <QSqlDatabase>
 
 #include "core/message.h"
+#include "services/abstract/feed.h"
 
-class Feed;
+#include <random>
+
+class Downloader;
+class QThread;
 class QThreadPool;
 class QMutex;
+class QTimer;
 
 // Represents results of batch feed updates.
 class FeedDownloadResults {
@@ -23,16 +34,122 @@ class FeedDownloadResults {
     void sort();
     void clear();
 
+    // Conditional requests statistics. Hit means that feed was not
+    // modified and its data were not downloaded at all.
+    int conditionalHits() const;
+    int conditionalMisses() const;
+    void appendConditionalHit();
+    void appendConditionalMiss();
+
     static bool lessThan(const QPair<QString, int>& lhs, const QPair<QString, int>& rhs);
 
   private:
 
     // QString represents title if the feed, int represents count of newly downloaded messages.
     QList<QPair<QString, int>> m_updatedFeeds;
+    int m_conditionalHits = 0;
+    int m_conditionalMisses = 0;
+};
+
+// Parses data of single asynchronously downloaded feed in worker thread.
+class FeedParsingTask : public QObject, public QRunnable {
+  Q_OBJECT
+
+  public:
+    explicit FeedParsingTask(Feed* feed, QNetworkReply::NetworkError network_error,
+                             const QByteArray& data, const QString& content_type, QObject* parent = nullptr);
+
+    Feed* feed() const;
+    QList<Message> messages() const;
+    bool errorDuringObtaining() const;
+    Feed::ObtainedHints hints() const;
+
+    QString httpETag() const;
+    QString httpLastModified() const;
+    void setHttpValidators(const QString& etag, const QString& last_modified);
+
+    void run();
+
+  signals:
+    void parsed();
+
+  private:
+    Feed* m_feed;
+    QNetworkReply::NetworkError m_networkError;
+    QByteArray m_data;
+    QString m_contentType;
+    QList<Message> m_messages;
+    bool m_errorDuringObtaining;
+    Feed::ObtainedHints m_hints;
+    QString m_httpETag;
+    QString m_httpLastModified;
+};
+
+// Parsed data of single feed waiting for being committed to DB.
+// Data of the feed which are needed for storing of its messages are
+// copied in main thread, so that writer thread never touches the feed.
+struct PendingFeedUpdate {
+  Feed* m_feed = nullptr;
+  int m_feedId = 0;
+  QString m_feedCustomId;
+  QString m_feedUrl;
+  int m_accountId = 0;
+  Feed::RetentionPolicy m_retentionPolicy;
+  QList<Message> m_messages;
+  bool m_errorDuringObtaining = false;
+
+  // Validators sent by server and validators which are currently stored.
+  QString m_httpETag;
+  QString m_httpLastModified;
+  QString m_storedHttpETag;
+  QString m_storedHttpLastModified;
+
+  // Results of commit.
+  int m_updatedMessages = 0;
+  bool m_anythingUpdated = false;
+  bool m_stored = false;
+};
+
+Q_DECLARE_METATYPE(PendingFeedUpdate)
+
+// Commits batches of parsed feed updates to DB in its own thread,
+// so that large commits do not block main thread.
+class FeedUpdateWriter : public QObject {
+  Q_OBJECT
+
+  public:
+    explicit FeedUpdateWriter(QObject* parent = nullptr);
+
+  public slots:
+    void storeUpdates(QList<PendingFeedUpdate> updates, bool use_transactions);
+
+  signals:
+    void updatesStored(QList<PendingFeedUpdate> updates);
+
+  private:
+    int storeMessages(const QSqlDatabase& database, const PendingFeedUpdate& update, bool* anything_updated, bool* ok) const;
 };
 
 // This class offers means to "update" feeds and "special" categories.
-// NOTE: This class is used within separate thread.
+//
+// Update runs in three stages:
+//   1. Feeds which support it are downloaded via non-blocking requests, many
+//      of them are in flight at once. Other feeds are updated in thread pool.
+//   2. Downloaded data are parsed in worker threads.
+//   3. Parsed messages of many feeds are collected and then committed
+//      to DB in one transaction by FeedUpdateWriter in its own thread.
+//      Batch is handed over to the writer when it is big enough or
+//      when FEED_DOWNLOADER_COMMIT_INTERVAL passes. Writer commits one
+//      batch at a time, feeds which finish meanwhile form next batch.
+//      Counts and model are refreshed in main thread once per batch.
+//
+// Downloads are polite to servers. Each host has limited number of
+// parallel downloads and token bucket which limits rate of new
+// downloads, their starts are jittered. Hosts which respond with
+// 429 or 503 are not contacted for a while. Total download speed
+// can be limited by user.
+// NOTE: This class lives in main thread, only its downloads
+// are asynchronous and its parsing and commits run in other threads.
 class FeedDownloader : public QObject {
   Q_OBJECT
 
@@ -49,14 +166,22 @@ class FeedDownloader : public QObject {
     // Performs update of all feeds from the "feeds" parameter.
     // New messages are downloaded for each feed and they
     // are stored persistently in the database.
+    // If update is already running, feeds are added to it.
     // Appropriate signals are emitted.
     void updateFeeds(const QList<Feed*>& feeds);
 
-    // Stops running update.
+    // Stops running update. Active downloads are aborted and results
+    // of feeds which are still being obtained are dropped, already
+    // obtained messages are committed.
     void stopRunningUpdate();
 
   private slots:
-    void oneFeedUpdateFinished(const QList<Message>& messages, bool error_during_obtaining);
+    void oneFeedUpdateFinished(const QList<Message>& messages, bool error_during_obtaining, const Feed::ObtainedHints& hints);
+    void oneFeedDownloadFinished(QNetworkReply::NetworkError status, const QByteArray& contents);
+    void oneFeedParsingFinished();
+    void onUpdatesCommitted(const QList<PendingFeedUpdate>& updates);
+    void onCommitTimeout();
+    void onDispatchTimeout();
 
   signals:
 
@@ -73,17 +198,68 @@ class FeedDownloader : public QObject {
     // which were in the initial queue.
     void updateProgress(const Feed* feed, int current, int total);
 
+    // Emitted when batch of updates is handed over to writer thread.
+    void commitRequested(QList<PendingFeedUpdate> updates, bool use_transactions);
+
   private:
+
+    // Politeness state of single host.
+    struct HostState {
+      int m_downloads = 0;
+      double m_tokens = 0.0;
+      qint64 m_lastRefill = 0;
+
+      // Host is not contacted before this time (msecs since epoch).
+      qint64 m_notBefore = 0;
+
+      // Number of consecutive responses which asked us to slow down.
+      int m_throttled = 0;
+    };
+
     void updateAvailableFeeds();
+    void saveCaches(const QList<Feed*>& feeds);
+
+    // Returns number of msecs to wait before download from the host can start.
+    qint64 hostWaitTime(HostState& host, qint64 now) const;
+
+    // Returns number of msecs to wait until bandwidth budget allows new downloads.
+    qint64 bandwidthWaitTime(qint64 now);
+
+    // Remembers that host asked us to slow down, returns
+    // number of msecs for which the host is not contacted.
+    qint64 holdOffHost(HostState& host, const Downloader* downloader, qint64 now);
+    static QString hostOfFeed(const Feed* feed);
+
+    void storeMessages(PendingFeedUpdate update);
+    void commitPendingUpdates();
+    void refreshUpdatedFeeds(const QList<PendingFeedUpdate>& updates);
+    void oneFeedFinished(Feed* feed);
     void finalizeUpdate();
 
     QList<Feed*> m_feeds;
+    QHash<Downloader*, Feed*> m_downloads;
     QMutex* m_mutex;
     QThreadPool* m_threadPool;
+    QThreadPool* m_parserPool;
+    QElapsedTimer m_updateTimer;
+    QList<PendingFeedUpdate> m_pendingUpdates;
+    int m_pendingMessagesCount;
+    QTimer* m_commitTimer;
+    QThread* m_writerThread;
+    FeedUpdateWriter* m_writer;
+    bool m_commitRunning;
     FeedDownloadResults m_results;
     int m_feedsUpdated;
     int m_feedsUpdating;
     int m_feedsOriginalCount;
+    QHash<QString, HostState> m_hosts;
+    QSet<Feed*> m_retriedFeeds;
+    bool m_updateStopped;
+    QTimer* m_dispatchTimer;
+    std::mt19937 m_random;
+    qint64 m_bandwidthLimit;
+    double m_bandwidthTokens;
+    qint64 m_bandwidthRefill;
 };
 
 #endif // FEEDDOWNLOADER_H
@@ -16,8 +16,10 @@
 #include "services/standard/standardserviceentrypoint.h"
 #include "services/standard/standardserviceroot.h"
 
+#include <QHash>
 #include <QMimeData>
 #include <QPair>
+#include <QSet>
 #include <QSqlError>
 #include <QSqlRecord>
 #include <QStack>
@@ -324,47 +326,6 @@ StandardServiceRoot* FeedsModel::standardServiceRoot() const {
   return nullptr;
 }
 
-QList<Feed*>FeedsModel::feedsForScheduledUpdate(bool auto_update_now) {
-  QList<Feed*>feeds_for_update;
-
-  foreach (Feed* feed, m_rootItem->getSubTreeFeeds()) {
-    switch (feed->autoUpdateType()) {
-      case Feed::DontAutoUpdate:
-
-        // Do not auto-update this feed ever.
-        continue;
-
-      case Feed::DefaultAutoUpdate:
-
-        if (auto_update_now) {
-          feeds_for_update.append(feed);
-        }
-
-        break;
-
-      case Feed::SpecificAutoUpdate:
-      default:
-        int remaining_interval = feed->autoUpdateRemainingInterval();
-
-        if (--remaining_interval <= 0) {
-          // Interval of this feed passed, include this feed in the output list
-          // and reset the interval.
-          feeds_for_update.append(feed);
-          feed->setAutoUpdateRemainingInterval(feed->autoUpdateInitialInterval());
-        }
-        else {
-          // Interval did not pass, set new decremented interval and do NOT
-          // include this feed in the output list.
-          feed->setAutoUpdateRemainingInterval(remaining_interval);
-        }
-
-        break;
-    }
-  }
-
-  return feeds_for_update;
-}
-
 QList<Message>FeedsModel::messagesForItem(RootItem* item) const {
   return item->undeletedMessages();
 }
@@ -444,23 +405,47 @@ void FeedsModel::reloadChangedItem(RootItem* item) {
   reloadChangedLayout(QModelIndexList() << indexForItem(item));
 }
 
-void FeedsModel::notifyWithCounts() {
-  emit messageCountsChanged(countOfUnreadMessages(), hasAnyFeedNewMessages());
-}
+void FeedsModel::reloadChangedItems(const QList<RootItem*>& items) {
+  QHash<RootItem*, QPair<int, int>> changed_rows;
+  QSet<RootItem*> visited_items;
 
-void FeedsModel::onItemDataChanged(const QList<RootItem*>& items) {
-  if (items.size() > RELOAD_MODEL_BORDER_NUM) {
-    qDebug("There is request to reload feed model for more than %d items, reloading model fully.", RELOAD_MODEL_BORDER_NUM);
-    reloadWholeLayout();
-  }
-  else {
-    qDebug("There is request to reload feed model, reloading the %d items individually.", items.size());
+  foreach (RootItem* item, items) {
+    for (RootItem* it = item; it != nullptr && it != m_rootItem && !visited_items.contains(it); it = it->parent()) {
+      RootItem* parent = it->parent();
+
+      if (parent == nullptr) {
+        break;
+      }
+
+      const int row = parent->childItems().indexOf(it);
+      auto rows = changed_rows.find(parent);
 
-    foreach (RootItem* item, items) {
-      reloadChangedItem(item);
+      visited_items.insert(it);
+
+      if (rows == changed_rows.end()) {
+        changed_rows.insert(parent, QPair<int, int>(row, row));
+      }
+      else {
+        rows.value().first = qMin(rows.value().first, row);
+        rows.value().second = qMax(rows.value().second, row);
+      }
     }
   }
 
+  for (auto i = changed_rows.constBegin(); i != changed_rows.constEnd(); i++) {
+    const QModelIndex parent_index = indexForItem(i.key());
+
+    emit dataChanged(index(i.value().first, 0, parent_index), index(i.value().second, FDS_MODEL_COUNTS_INDEX, parent_index));
+  }
+}
+
+void FeedsModel::notifyWithCounts() {
+  emit messageCountsChanged(countOfUnreadMessages(), hasAnyFeedNewMessages());
+}
+
+void FeedsModel::onItemDataChanged(const QList<RootItem*>& items) {
+  qDebug("There is request to reload feed model, reloading the %d items.", items.size());
+  reloadChangedItems(items);
   notifyWithCounts();
 }
 
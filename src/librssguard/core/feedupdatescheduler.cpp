@@ -0,0 +1,322 @@
+// For license of this file, see <project-root-folder>/LICENSE.md.
+
+#include "core/feedupdatescheduler.h"
+
+#include "core/feedsmodel.h"
+#include "definitions/definitions.h"
+#include "services/abstract/rootitem.h"
+
+#include <QDateTime>
+#include <QSet>
+#include <QTimer>
+
+#include <algorithm>
+#include <cmath>
+
+FeedUpdateScheduler::FeedUpdateScheduler(FeedsModel* feeds_model, QObject* parent)
+  : QObject(parent), m_feedsModel(feeds_model), m_timer(new QTimer(this)), m_dirty(true),
+  m_globalAutoUpdateEnabled(false), m_globalAutoUpdateInterval(DEFAULT_AUTO_UPDATE_INTERVAL) {
+  m_timer->setSingleShot(true);
+
+  connect(m_timer, &QTimer::timeout, this, &FeedUpdateScheduler::onTimeout);
+  connect(m_feedsModel, &FeedsModel::rowsInserted, this, &FeedUpdateScheduler::invalidate);
+  connect(m_feedsModel, &FeedsModel::rowsRemoved, this, &FeedUpdateScheduler::invalidate);
+  connect(m_feedsModel, &FeedsModel::modelReset, this, &FeedUpdateScheduler::invalidate);
+  connect(m_feedsModel, &FeedsModel::layoutChanged, this, &FeedUpdateScheduler::invalidate);
+  connect(m_feedsModel, &FeedsModel::dataChanged, this, &FeedUpdateScheduler::invalidate);
+
+  m_timer->start(AUTO_UPDATE_INTERVAL);
+}
+
+FeedUpdateScheduler::~FeedUpdateScheduler() {
+  qDebug("Destroying FeedUpdateScheduler instance.");
+}
+
+void FeedUpdateScheduler::setGlobalAutoUpdate(bool enabled, int interval) {
+  if (m_globalAutoUpdateEnabled == enabled && m_globalAutoUpdateInterval == interval) {
+    return;
+  }
+
+  m_globalAutoUpdateEnabled = enabled;
+  m_globalAutoUpdateInterval = interval;
+
+  const qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+  for (auto i = m_feeds.begin(); i != m_feeds.end();) {
+    if (i.value().m_feed.isNull()) {
+      // Feed was deleted and model was not synchronized yet.
+      i = m_feeds.erase(i);
+    }
+    else {
+      if (i.value().m_type == Feed::DefaultAutoUpdate) {
+        schedule(i.key(), now, true);
+      }
+
+      i++;
+    }
+  }
+
+  arm();
+}
+
+int FeedUpdateScheduler::remainingInterval(const Feed* feed) const {
+  const auto scheduled = m_feeds.constFind(feed);
+
+  if (scheduled == m_feeds.constEnd() || scheduled.value().m_due <= 0) {
+    return updateInterval(feed) / 60;
+  }
+  else {
+    return int(qMax(qint64(0), (scheduled.value().m_due - QDateTime::currentMSecsSinceEpoch() + 59999) / 60000));
+  }
+}
+
+void FeedUpdateScheduler::rescheduleFeed(const Feed* feed) {
+  if (m_feeds.contains(feed) && !m_feeds[feed].m_feed.isNull()) {
+    schedule(feed, QDateTime::currentMSecsSinceEpoch(), false);
+    arm();
+  }
+}
+
+void FeedUpdateScheduler::rescheduleUnfinishedFeeds() {
+  const qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+  for (auto i = m_feeds.constBegin(); i != m_feeds.constEnd(); i++) {
+    if (i.value().m_due <= 0 && !i.value().m_feed.isNull()) {
+      schedule(i.key(), now, false);
+    }
+  }
+
+  arm();
+}
+
+void FeedUpdateScheduler::postpone(const QList<Feed*>& feeds, int msecs) {
+  const qint64 due = QDateTime::currentMSecsSinceEpoch() + msecs;
+
+  foreach (const Feed* feed, feeds) {
+    if (m_feeds.contains(feed)) {
+      push(feed, adjustedDueTime(feed, due));
+    }
+  }
+
+  arm();
+}
+
+void FeedUpdateScheduler::onTimeout() {
+  if (m_dirty && (!m_lastSynchronization.isValid() || m_lastSynchronization.elapsed() >= FEED_SCHEDULER_SYNC_INTERVAL)) {
+    synchronize();
+  }
+
+  // Feeds which are due very soon are updated together with
+  // due feeds, so that updates are done in fewer batches.
+  const qint64 limit = QDateTime::currentMSecsSinceEpoch() + FEED_SCHEDULER_BATCH_SLACK;
+  QList<Feed*> due_feeds;
+
+  while (!m_heap.isEmpty() && m_heap.first().m_due <= limit) {
+    const HeapEntry entry = m_heap.first();
+
+    std::pop_heap(m_heap.begin(), m_heap.end(), FeedUpdateScheduler::laterThan);
+    m_heap.removeLast();
+
+    if (isStale(entry)) {
+      continue;
+    }
+
+    ScheduledFeed& scheduled = m_feeds[entry.m_feed];
+
+    // Feed is planned again when its update finishes.
+    scheduled.m_due = 0;
+
+    if (!scheduled.m_feed.isNull()) {
+      due_feeds.append(scheduled.m_feed.data());
+    }
+  }
+
+  arm();
+
+  if (!due_feeds.isEmpty()) {
+    qDebug("Scheduler found %d feeds due for auto-update, %d feeds are scheduled.", due_feeds.size(), m_feeds.size());
+    emit feedsDue(due_feeds);
+  }
+}
+
+void FeedUpdateScheduler::invalidate() {
+  m_dirty = true;
+}
+
+bool FeedUpdateScheduler::laterThan(const HeapEntry& lhs, const HeapEntry& rhs) {
+  return lhs.m_due > rhs.m_due;
+}
+
+void FeedUpdateScheduler::synchronize() {
+  const qint64 now = QDateTime::currentMSecsSinceEpoch();
+  const QList<Feed*> feeds = m_feedsModel->rootItem()->getSubTreeFeeds();
+  QSet<const Feed*> current_feeds;
+  int added = 0;
+
+  m_dirty = false;
+  m_lastSynchronization.start();
+
+  foreach (Feed* feed, feeds) {
+    auto scheduled = m_feeds.find(feed);
+
+    current_feeds.insert(feed);
+
+    if (scheduled == m_feeds.end() || scheduled.value().m_feed.isNull()) {
+      ScheduledFeed new_feed;
+
+      new_feed.m_feed = feed;
+      new_feed.m_type = feed->autoUpdateType();
+      new_feed.m_interval = feed->autoUpdateInitialInterval();
+      m_feeds.insert(feed, new_feed);
+      schedule(feed, now, true);
+      added++;
+    }
+    else if (scheduled.value().m_type != feed->autoUpdateType() ||
+             scheduled.value().m_interval != feed->autoUpdateInitialInterval()) {
+      scheduled.value().m_type = feed->autoUpdateType();
+      scheduled.value().m_interval = feed->autoUpdateInitialInterval();
+      schedule(feed, now, false);
+    }
+  }
+
+  for (auto i = m_feeds.begin(); i != m_feeds.end();) {
+    if (current_feeds.contains(i.key())) {
+      i++;
+    }
+    else {
+      i = m_feeds.erase(i);
+    }
+  }
+
+  // Heap is rebuilt if it contains too many stale entries.
+  if (m_heap.size() > 2 * m_feeds.size() + 64) {
+    QVector<HeapEntry> heap;
+
+    heap.reserve(m_feeds.size());
+
+    for (const HeapEntry& entry : m_heap) {
+      if (!isStale(entry)) {
+        heap.append(entry);
+      }
+    }
+
+    std::make_heap(heap.begin(), heap.end(), FeedUpdateScheduler::laterThan);
+    m_heap = heap;
+  }
+
+  qDebug("Scheduler synchronized with feeds model, %d feeds added, %d feeds scheduled.", added, m_feeds.size());
+}
+
+void FeedUpdateScheduler::schedule(const Feed* feed, qint64 from, bool staggered) {
+  const int interval = updateInterval(feed);
+
+  if (interval <= 0) {
+    // Feed is not auto-updated, its queued entries become stale.
+    m_feeds[feed].m_due = 0;
+    return;
+  }
+
+  qint64 delay = qint64(interval) * 1000;
+
+  if (staggered) {
+    delay = delay * (50 + qHash(feed->url()) % 50) / 100;
+  }
+
+  push(feed, adjustedDueTime(feed, from + delay));
+}
+
+void FeedUpdateScheduler::push(const Feed* feed, qint64 due) {
+  HeapEntry entry;
+
+  entry.m_due = due;
+  entry.m_feed = feed;
+  m_feeds[feed].m_due = due;
+  m_heap.append(entry);
+  std::push_heap(m_heap.begin(), m_heap.end(), FeedUpdateScheduler::laterThan);
+}
+
+bool FeedUpdateScheduler::isStale(const HeapEntry& entry) const {
+  const auto scheduled = m_feeds.constFind(entry.m_feed);
+
+  return scheduled == m_feeds.constEnd() || scheduled.value().m_due != entry.m_due;
+}
+
+void FeedUpdateScheduler::arm() {
+  while (!m_heap.isEmpty() && isStale(m_heap.first())) {
+    std::pop_heap(m_heap.begin(), m_heap.end(), FeedUpdateScheduler::laterThan);
+    m_heap.removeLast();
+  }
+
+  // Timer fires at least once per AUTO_UPDATE_INTERVAL so
+  // that changes in feeds model are noticed.
+  qint64 delay = AUTO_UPDATE_INTERVAL;
+
+  if (!m_heap.isEmpty()) {
+    delay = qBound(qint64(FEED_SCHEDULER_MIN_DELAY),
+                   m_heap.first().m_due - QDateTime::currentMSecsSinceEpoch(),
+                   qint64(AUTO_UPDATE_INTERVAL));
+  }
+
+  m_timer->start(int(delay));
+}
+
+int FeedUpdateScheduler::updateInterval(const Feed* feed) const {
+  int base;
+
+  switch (feed->autoUpdateType()) {
+    case Feed::DefaultAutoUpdate:
+      if (!m_globalAutoUpdateEnabled) {
+        return 0;
+      }
+
+      base = m_globalAutoUpdateInterval * 60;
+      break;
+
+    case Feed::SpecificAutoUpdate:
+      base = feed->autoUpdateInitialInterval() * 60;
+      break;
+
+    case Feed::DontAutoUpdate:
+    default:
+      return 0;
+  }
+
+  base = qMax(base, 60);
+
+  const Feed::UpdateHints hints = feed->updateHints();
+  const double max_interval = qMax(qMin(base * FEED_SCHEDULER_MAX_BACKOFF, FEED_SCHEDULER_MAX_INTERVAL), base);
+
+  // Feeds which publish rarely or did not bring anything new
+  // recently are updated less often, but never more rarely
+  // than some multiple of interval chosen by user.
+  double interval = qMax(base, hints.m_publishInterval / 2);
+
+  interval *= std::pow(FEED_SCHEDULER_IDLE_BACKOFF, qMin(hints.m_idleUpdates, 32));
+  interval = qMin(interval, max_interval);
+
+  // Feed and its server may ask for even longer interval.
+  interval = qMax(interval, double(qMin(qMax(hints.m_feedInterval, hints.m_cacheInterval), FEED_SCHEDULER_MAX_INTERVAL)));
+
+  return int(interval);
+}
+
+qint64 FeedUpdateScheduler::adjustedDueTime(const Feed* feed, qint64 due) const {
+  const Feed::UpdateHints hints = feed->updateHints();
+
+  if (hints.m_retryAfter.isValid()) {
+    due = qMax(due, hints.m_retryAfter.toMSecsSinceEpoch());
+  }
+
+  // Each skipped hour moves update to the start of next hour.
+  for (int i = 0; i < 24 && hints.m_skipHours != 0; i++) {
+    const int hour = QDateTime::fromMSecsSinceEpoch(due, Qt::UTC).time().hour();
+
+    if ((hints.m_skipHours & (1u << hour)) == 0) {
+      break;
+    }
+
+    due = (due / 3600000 + 1) * 3600000;
+  }
+
+  return due;
+}
@@ -0,0 +1,111 @@
+// For license of this file, see <project-root-folder>/LICENSE.md.
+
+#ifndef FEEDUPDATESCHEDULER_H
+#define FEEDUPDATESCHEDULER_H
+
+#include <QObject>
+
+#include "services/abstract/feed.h"
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QPointer>
+#include <QVector>
+
+class FeedsModel;
+class QTimer;
+
+// Plans automatic updates of feeds.
+//
+// Feeds are kept in priority queue ordered by time of their next
+// update, so only feeds which are really due are touched. Interval
+// of each feed is derived from its auto-update settings and then
+// adjusted according to how often the feed publishes messages, how
+// many recent updates brought nothing new and what feed itself
+// or its server ask for ("ttl", "sy:updatePeriod", "skipHours",
+// "Cache-Control" and "Retry-After").
+class FeedUpdateScheduler : public QObject {
+  Q_OBJECT
+
+  public:
+    explicit FeedUpdateScheduler(FeedsModel* feeds_model, QObject* parent = nullptr);
+    virtual ~FeedUpdateScheduler();
+
+    // Sets global auto-update settings, interval is in minutes.
+    // Feeds with default auto-update strategy are rescheduled.
+    void setGlobalAutoUpdate(bool enabled, int interval);
+
+    // Returns number of minutes remaining to next auto-update of the feed.
+    int remainingInterval(const Feed* feed) const;
+
+  public slots:
+
+    // Plans next update of the feed which was just updated.
+    void rescheduleFeed(const Feed* feed);
+
+    // Plans next update of all due feeds which were not updated,
+    // for example because their update was stopped.
+    void rescheduleUnfinishedFeeds();
+
+    // Delays update of given due feeds.
+    void postpone(const QList<Feed*>& feeds, int msecs);
+
+  private slots:
+    void onTimeout();
+    void invalidate();
+
+  signals:
+
+    // Emitted when feeds should be updated.
+    // Each of them is rescheduled once its update finishes.
+    void feedsDue(const QList<Feed*>& feeds);
+
+  private:
+    struct ScheduledFeed {
+      QPointer<Feed> m_feed;
+
+      // Time of next update in msecs since epoch, zero if not scheduled.
+      qint64 m_due = 0;
+
+      // Settings of the feed at the time it was scheduled.
+      Feed::AutoUpdateType m_type = Feed::DontAutoUpdate;
+      int m_interval = 0;
+    };
+
+    struct HeapEntry {
+      qint64 m_due;
+      const Feed* m_feed;
+    };
+
+    static bool laterThan(const HeapEntry& lhs, const HeapEntry& rhs);
+
+    // Adds new feeds from the model, forgets removed feeds and
+    // reschedules feeds whose auto-update settings changed.
+    void synchronize();
+
+    // Plans next update of the feed. If "staggered" is true, then
+    // first update is spread over the interval, so that feeds
+    // added at once are not all updated at once.
+    void schedule(const Feed* feed, qint64 from, bool staggered);
+    void push(const Feed* feed, qint64 due);
+    bool isStale(const HeapEntry& entry) const;
+    void arm();
+
+    // Returns update interval of the feed in seconds, zero if
+    // the feed should not be auto-updated.
+    int updateInterval(const Feed* feed) const;
+
+    // Moves due time so that it respects server and feed wishes.
+    qint64 adjustedDueTime(const Feed* feed, qint64 due) const;
+
+    FeedsModel* m_feedsModel;
+    QTimer* m_timer;
+    QVector<HeapEntry> m_heap;
+    QHash<const Feed*, ScheduledFeed> m_feeds;
+    QElapsedTimer m_lastSynchronization;
+    bool m_dirty;
+    bool m_globalAutoUpdateEnabled;
+    int m_globalAutoUpdateInterval;
+};
+
+#endif // FEEDUPDATESCHEDULER_H
@@ -86,6 +86,19 @@ Message Message::fromSqlRecord(const QSqlRecord& record, bool* result) {
   return message;
 }
 
+void Message::computeHashes() {
+  m_identityHash = identityHash(m_title, m_url, m_author);
+  m_contentHash = contentHash(m_contents);
+}
+
+qint64 Message::identityHash(const QString& title, const QString& url, const QString& author) {
+  return qint64(TextFactory::hash64(title + QL1C('\x1F') + url + QL1C('\x1F') + author));
+}
+
+qint64 Message::contentHash(const QString& contents) {
+  return qint64(TextFactory::hash64(contents));
+}
+
 QDataStream& operator<<(QDataStream& out, const Message& myObj) {
   out << myObj.m_accountId
       << myObj.m_customHash
@@ -34,6 +34,14 @@ class Message {
     // Creates Message from given record, which contains
     // row from query SELECT * FROM Messages WHERE ....;
     static Message fromSqlRecord(const QSqlRecord& record, bool* result = nullptr);
+
+    // Calculates identity and content hashes from current
+    // title, URL, author and contents.
+    void computeHashes();
+
+    static qint64 identityHash(const QString& title, const QString& url, const QString& author);
+    static qint64 contentHash(const QString& contents);
+
     QString m_title;
     QString m_url;
     QString m_author;
@@ -47,6 +55,11 @@ class Message {
     bool m_isRead;
     bool m_isImportant;
 
+    // Hashes used to match message with its stored copy
+    // and to detect changes of its contents, zero if not computed.
+    qint64 m_identityHash = 0;
+    qint64 m_contentHash = 0;
+
     QList<Enclosure> m_enclosures;
 
     // Is true if "created" date was obtained directly
@@ -15,10 +15,19 @@
 
 #include <QSqlError>
 #include <QSqlField>
+#include <QSqlQuery>
+#include <QTimer>
+
+#include <algorithm>
 
 MessagesModel::MessagesModel(QObject* parent)
-  : QSqlQueryModel(parent), m_cache(new MessagesModelCache(this)), m_messageHighlighter(NoHighlighting),
-  m_customDateFormat(QString()), m_selectedItem(nullptr), m_itemHeight(-1) {
+  : QAbstractTableModel(parent), m_cache(new MessagesModelCache(this)), m_rowCount(0), m_sortedInMemory(false),
+  m_bodies(MESSAGES_MODEL_BODY_CACHE_SIZE), m_bodyPrefetchTimer(new QTimer(this)), m_bodyPrefetchRow(-1),
+  m_messageHighlighter(NoHighlighting), m_customDateFormat(QString()), m_selectedItem(nullptr), m_itemHeight(-1) {
+  m_bodyPrefetchTimer->setSingleShot(true);
+  m_bodyPrefetchTimer->setInterval(0);
+  connect(m_bodyPrefetchTimer, &QTimer::timeout, this, &MessagesModel::prefetchBodies);
+
   setupFonts();
   setupIcons();
   setupHeaderData();
@@ -38,22 +47,308 @@ void MessagesModel::setupIcons() {
 }
 
 void MessagesModel::repopulate() {
+  beginResetModel();
   m_cache->clear();
-  setQuery(selectStatement(), m_db);
+  m_pages.clear();
+  m_recentPages.clear();
+  m_messageRows.clear();
+  m_bodies.clear();
+  m_bodyPrefetchTimer->stop();
+
+  if (!m_store.load(m_readDb, storeStatement())) {
+    m_store.clear();
+  }
+
+  m_rowCount = m_store.size();
+  m_sortedInMemory = MessagesModelStore::canSort(sortKeys());
+
+  if (m_sortedInMemory) {
+    m_store.sort(sortKeys());
+  }
+
+  endResetModel();
+}
+
+void MessagesModel::resort() {
+  if (!MessagesModelStore::canSort(sortKeys())) {
+    repopulate();
+    return;
+  }
+
+  emit layoutAboutToBeChanged();
+
+  // Messages keep their flags changed in the model, because they are
+  // changed in the store too. Loaded pages are dropped, rows of
+  // messages are loaded again by their IDs when they are displayed.
+  const QModelIndexList old_indexes = persistentIndexList();
+  QModelIndexList new_indexes;
+  QList<int> ids;
+
+  for (const QModelIndex& old_index : old_indexes) {
+    ids.append(messageId(old_index.row()));
+  }
+
+  m_cache->clear();
+  m_pages.clear();
+  m_recentPages.clear();
+  m_messageRows.clear();
+  m_sortedInMemory = true;
+  m_store.sort(sortKeys());
+
+  for (int i = 0; i < old_indexes.size(); i++) {
+    new_indexes.append(index(m_store.row(ids.at(i)), old_indexes.at(i).column()));
+  }
+
+  changePersistentIndexList(old_indexes, new_indexes);
+  emit layoutChanged();
+}
+
+int MessagesModel::rowCount(const QModelIndex& parent) const {
+  return parent.isValid() ? 0 : m_rowCount;
+}
+
+int MessagesModel::columnCount(const QModelIndex& parent) const {
+  return parent.isValid() ? 0 : m_headerData.size();
+}
+
+QSqlRecord MessagesModel::record(int row_index) const {
+  if (row_index < 0 || row_index >= m_rowCount) {
+    return QSqlRecord();
+  }
+
+  const int page = row_index / MESSAGES_MODEL_PAGE_SIZE;
+  const int page_row = row_index % MESSAGES_MODEL_PAGE_SIZE;
+
+  if (!m_pages.contains(page)) {
+    loadPage(page);
+  }
+  else if (m_recentPages.last() != page) {
+    m_recentPages.removeOne(page);
+    m_recentPages.append(page);
+  }
+
+  const QSqlRecord record = m_pages.value(page).value(page_row);
+
+  // Neighbouring page is loaded in advance when the view
+  // gets close to the edge of the page.
+  if (page_row >= MESSAGES_MODEL_PAGE_SIZE - MESSAGES_MODEL_PREFETCH_ROWS) {
+    if ((page + 1) * MESSAGES_MODEL_PAGE_SIZE < m_rowCount && !m_pages.contains(page + 1)) {
+      loadPage(page + 1);
+    }
+  }
+  else if (page_row < MESSAGES_MODEL_PREFETCH_ROWS && page > 0 && !m_pages.contains(page - 1)) {
+    loadPage(page - 1);
+  }
+
+  return record;
+}
+
+QVariant MessagesModel::rawData(const QModelIndex& index) const {
+  return record(index.row()).value(index.column());
+}
+
+void MessagesModel::loadPage(int page) const {
+  const int page_rows = qMin(MESSAGES_MODEL_PAGE_SIZE, m_rowCount - page * MESSAGES_MODEL_PAGE_SIZE);
+
+  if (m_sortedInMemory) {
+    loadPageByIds(page, page_rows);
+    return;
+  }
+
+  int previous = -1;
+  int next = -1;
+
+  // Page is loaded with keyset pagination relatively to
+  // the nearest loaded page, so that database does not have
+  // to skip all preceding messages.
+  for (auto i = m_pages.constBegin(); i != m_pages.constEnd(); i++) {
+    if (i.value().isEmpty()) {
+      continue;
+    }
+    else if (i.key() < page && i.key() > previous) {
+      previous = i.key();
+    }
+    else if (i.key() > page && (next < 0 || i.key() < next)) {
+      next = i.key();
+    }
+  }
+
+  QSqlQuery q(m_readDb);
+  QVector<QSqlRecord> rows;
+  QVariantList values;
+  bool backwards = false;
+
+  q.setForwardOnly(true);
+
+  if (previous >= 0 && (next < 0 || page - previous <= next - page)) {
+    q.prepare(selectStatement(keysetCondition(false), false, page_rows, (page - previous - 1) * MESSAGES_MODEL_PAGE_SIZE));
+    values = keysetValues(m_pages.value(previous).last());
+  }
+  else if (next >= 0 && next - page - 1 < page) {
+    backwards = true;
+    q.prepare(selectStatement(keysetCondition(true), true, page_rows, (next - page - 1) * MESSAGES_MODEL_PAGE_SIZE));
+    values = keysetValues(m_pages.value(next).first());
+  }
+  else {
+    q.prepare(selectStatement(QString(), false, page_rows, page * MESSAGES_MODEL_PAGE_SIZE));
+  }
+
+  foreach (const QVariant& value, values) {
+    q.addBindValue(value);
+  }
+
+  if (q.exec()) {
+    rows.reserve(page_rows);
+
+    while (q.next()) {
+      rows.append(q.record());
+    }
+
+    if (backwards) {
+      std::reverse(rows.begin(), rows.end());
+    }
+
+    for (int i = 0; i < rows.size(); i++) {
+      m_messageRows.insert(rows.at(i).value(MSG_DB_ID_INDEX).toInt(), page * MESSAGES_MODEL_PAGE_SIZE + i);
+    }
+  }
+  else {
+    qCritical("Error when loading page %d of messages for msg view: '%s'.", page, qPrintable(q.lastError().text()));
+  }
+
+  // NOTE: Page is remembered even if its loading failed, so that
+  // database is not queried again each time the view is painted.
+  m_pages.insert(page, rows);
+  m_recentPages.append(page);
+  evictPages();
+}
+
+void MessagesModel::loadPageByIds(int page, int page_rows) const {
+  QSqlQuery q(m_readDb);
+  QVector<QSqlRecord> rows(page_rows);
+  QList<int> ids;
+
+  for (int i = 0; i < page_rows; i++) {
+    ids.append(m_store.messageId(page * MESSAGES_MODEL_PAGE_SIZE + i));
+  }
+
+  q.setForwardOnly(true);
+
+  if (q.exec(selectStatement(ids))) {
+    while (q.next()) {
+      const int row = m_store.row(q.value(MSG_DB_ID_INDEX).toInt());
+
+      if (row < page * MESSAGES_MODEL_PAGE_SIZE || row >= page * MESSAGES_MODEL_PAGE_SIZE + page_rows) {
+        continue;
+      }
+
+      QSqlRecord rec = q.record();
+
+      // Flags of messages could be changed in the model
+      // since they were loaded, the store has them up-to-date.
+      for (int column : { MSG_DB_READ_INDEX, MSG_DB_DELETED_INDEX, MSG_DB_PDELETED_INDEX, MSG_DB_IMPORTANT_INDEX }) {
+        rec.setValue(column, m_store.hasFlag(row, MessagesModelStore::flagOfColumn(column)) ? 1 : 0);
+      }
 
-  if (lastError().isValid()) {
-    qCritical() << "Error when setting new msg view query:" << lastError().text();
+      m_messageRows.insert(ids.at(row % MESSAGES_MODEL_PAGE_SIZE), row);
+      rows[row % MESSAGES_MODEL_PAGE_SIZE] = rec;
+    }
+  }
+  else {
+    qCritical("Error when loading page %d of messages for msg view: '%s'.", page, qPrintable(q.lastError().text()));
   }
 
-  while (canFetchMore()) {
-    fetchMore();
+  m_pages.insert(page, rows);
+  m_recentPages.append(page);
+  evictPages();
+}
+
+void MessagesModel::evictPages() const {
+  for (int i = 0; m_pages.size() > MESSAGES_MODEL_MAX_PAGES && i < m_recentPages.size() - 1;) {
+    const int page = m_recentPages.at(i);
+
+    // Pages with messages changed in the model are kept, because
+    // messages could move when reloaded from database, for example
+    // when they are deleted. Messages sorted in memory do not move.
+    if (!m_sortedInMemory && isPageModified(page)) {
+      i++;
+    }
+    else {
+      foreach (const QSqlRecord& rec, m_pages.value(page)) {
+        m_messageRows.remove(rec.value(MSG_DB_ID_INDEX).toInt());
+      }
+
+      m_recentPages.removeAt(i);
+      m_pages.remove(page);
+    }
   }
 }
 
+bool MessagesModel::isPageModified(int page) const {
+  for (int i = page * MESSAGES_MODEL_PAGE_SIZE; i < (page + 1) * MESSAGES_MODEL_PAGE_SIZE; i++) {
+    if (m_cache->containsData(i)) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+int MessagesModel::loadedMessageRow(int id) const {
+  return m_messageRows.value(id, -1);
+}
+
+int MessagesModel::messageRow(int id) const {
+  const int loaded_row = loadedMessageRow(id);
+
+  if (loaded_row >= 0) {
+    return loaded_row;
+  }
+  else if (m_sortedInMemory) {
+    return m_store.row(id);
+  }
+
+  // Row of the message is number of messages
+  // which precede it in current sort order.
+  QSqlQuery q(m_readDb);
+
+  q.setForwardOnly(true);
+  q.prepare(selectStatement(QSL("Messages.id = ?"), false, 1));
+  q.addBindValue(id);
+
+  if (!q.exec() || !q.next()) {
+    return -1;
+  }
+
+  const QVariantList values = keysetValues(q.record());
+
+  q.prepare(countStatement(keysetCondition(true)));
+
+  foreach (const QVariant& value, values) {
+    q.addBindValue(value);
+  }
+
+  if (!q.exec() || !q.next()) {
+    qWarning("Error when obtaining row of message in msg view: '%s'.", qPrintable(q.lastError().text()));
+    return -1;
+  }
+
+  const int row = q.value(0).toInt();
+
+  return row < m_rowCount ? row : -1;
+}
+
 bool MessagesModel::setData(const QModelIndex& index, const QVariant& value, int role) {
   Q_UNUSED(role)
-  m_cache->setData(index, value, record(index.row()));
-  return true;
+
+  // Page of the message is loaded first, so that
+  // it is kept in memory while the message is changed.
+  const int id = record(index.row()).value(MSG_DB_ID_INDEX).toInt();
+
+  m_store.setFlag(m_sortedInMemory ? index.row() : m_store.row(id),
+                  MessagesModelStore::flagOfColumn(index.column()),
+                  value.toInt() != 0);
+  return m_cache->setData(index, value);
 }
 
 void MessagesModel::setupFonts() {
@@ -95,27 +390,51 @@ void MessagesModel::loadMessages(RootItem* item) {
                            qApp->mainFormWidget(),
                            true);
     }
+    else if (!m_searchPattern.isEmpty()) {
+      // Only messages of the item are searched, so that search
+      // in feed or in recycle bin stays within it.
+      const QList<int> ids = DatabaseQueries::searchMessages(m_readDb, m_searchPattern, filter(), MESSAGES_SEARCH_LIMIT);
+      QStringList textual_ids;
+
+      foreach (int id, ids) {
+        textual_ids.append(QString::number(id));
+      }
+
+      setFilter(ids.isEmpty() ?
+                QSL(DEFAULT_SQL_MESSAGES_FILTER) :
+                QString(QSL("(%1) AND Messages.id IN (%2)")).arg(filter(), textual_ids.join(QSL(", "))));
+    }
   }
 
   repopulate();
 }
 
+void MessagesModel::searchMessages(const QString& pattern) {
+  const QString simplified_pattern = pattern.simplified();
+
+  if (simplified_pattern != m_searchPattern) {
+    m_searchPattern = simplified_pattern;
+    loadMessages(m_selectedItem);
+  }
+}
+
 bool MessagesModel::setMessageImportantById(int id, RootItem::Importance important) {
-  for (int i = 0; i < rowCount(); i++) {
-    int found_id = data(i, MSG_DB_ID_INDEX, Qt::EditRole).toInt();
+  const int row = loadedMessageRow(id);
 
-    if (found_id == id) {
-      bool set = setData(index(i, MSG_DB_IMPORTANT_INDEX), important);
+  if (row < 0) {
+    // Messages which are not loaded are read from database later,
+    // their flags are then taken from the store, so it must be updated.
+    m_store.setFlag(m_store.row(id), MessagesModelStore::flagOfColumn(MSG_DB_IMPORTANT_INDEX), important != 0);
+    return true;
+  }
 
-      if (set) {
-        emit dataChanged(index(i, 0), index(i, MSG_DB_CUSTOM_HASH_INDEX));
-      }
+  const bool set = setData(index(row, MSG_DB_IMPORTANT_INDEX), important);
 
-      return set;
-    }
+  if (set) {
+    emit dataChanged(index(row, 0), index(row, MSG_DB_CUSTOM_HASH_INDEX));
   }
 
-  return false;
+  return set;
 }
 
 void MessagesModel::highlightMessages(MessagesModel::MessageHighlighter highlight) {
@@ -151,7 +470,69 @@ void MessagesModel::reloadWholeLayout() {
 }
 
 Message MessagesModel::messageAt(int row_index) const {
-  return Message::fromSqlRecord(m_cache->containsData(row_index) ? m_cache->record(row_index) : record(row_index));
+  Message message = messageHeaderAt(row_index);
+
+  if (message.m_id > 0) {
+    const MessageBody* body = messageBody(message.m_id);
+
+    if (body != nullptr) {
+      message.m_contents = body->m_contents;
+      message.m_enclosures = Enclosures::decodeEnclosuresFromString(body->m_enclosures);
+    }
+
+    // Bodies of following messages are loaded when application
+    // is idle, so that they are ready when user moves to them.
+    m_bodyPrefetchRow = row_index;
+    m_bodyPrefetchTimer->start();
+  }
+
+  return message;
+}
+
+Message MessagesModel::messageHeaderAt(int row_index) const {
+  return Message::fromSqlRecord(m_cache->containsData(row_index) ? m_cache->record(row_index, record(row_index)) : record(row_index));
+}
+
+const MessagesModel::MessageBody* MessagesModel::messageBody(int id) const {
+  if (!m_bodies.contains(id)) {
+    loadBodies(QList<int>() << id);
+  }
+
+  return m_bodies.object(id);
+}
+
+void MessagesModel::loadBodies(const QList<int>& ids) const {
+  bool ok;
+  const QMap<int, QPair<QString, QString>> bodies = DatabaseQueries::getMessagesContents(m_readDb, ids, &ok);
+
+  if (!ok) {
+    qWarning("Contents of %d messages were not loaded for msg view.", ids.size());
+  }
+
+  for (auto i = bodies.constBegin(); i != bodies.constEnd(); i++) {
+    MessageBody* body = new MessageBody();
+
+    body->m_contents = i.value().first;
+    body->m_enclosures = i.value().second;
+    m_bodies.insert(i.key(), body);
+  }
+}
+
+void MessagesModel::prefetchBodies() {
+  QList<int> ids;
+  const int last_row = qMin(m_rowCount - 1, m_bodyPrefetchRow + MESSAGES_MODEL_BODY_PREFETCH_ROWS);
+
+  for (int i = qMax(0, m_bodyPrefetchRow - 1); i <= last_row; i++) {
+    const int id = messageId(i);
+
+    if (id > 0 && !m_bodies.contains(id)) {
+      ids.append(id);
+    }
+  }
+
+  if (!ids.isEmpty()) {
+    loadBodies(ids);
+  }
 }
 
 void MessagesModel::setupHeaderData() {
@@ -220,7 +601,7 @@ QVariant MessagesModel::data(const QModelIndex& idx, int role) const {
       int index_column = idx.column();
 
       if (index_column == MSG_DB_DCREATED_INDEX) {
-        QDateTime dt = TextFactory::parseDateTime(QSqlQueryModel::data(idx, role).value<qint64>()).toLocalTime();
+        QDateTime dt = TextFactory::parseDateTime(rawData(idx).value<qint64>()).toLocalTime();
 
         if (m_customDateFormat.isEmpty()) {
           return dt.toString(Qt::DefaultLocaleShortDate);
@@ -231,17 +612,17 @@ QVariant MessagesModel::data(const QModelIndex& idx, int role) const {
       }
       else if (index_column == MSG_DB_CONTENTS_INDEX) {
         // Do not display full contents here.
-        QString contents = data(idx, Qt::EditRole).toString().mid(0, 64).simplified() + QL1S("...");
+        const MessageBody* body = messageBody(messageId(idx.row()));
 
-        return contents;
+        return body == nullptr ? QString() : body->m_contents.mid(0, 64).simplified() + QL1S("...");
       }
       else if (index_column == MSG_DB_AUTHOR_INDEX) {
-        const QString author_name = QSqlQueryModel::data(idx, role).toString();
+        const QString author_name = rawData(idx).toString();
 
         return author_name.isEmpty() ? QSL("-") : author_name;
       }
       else if (index_column != MSG_DB_IMPORTANT_INDEX && index_column != MSG_DB_READ_INDEX && index_column != MSG_DB_HAS_ENCLOSURES) {
-        return QSqlQueryModel::data(idx, role);
+        return rawData(idx);
       }
       else {
         return QVariant();
@@ -249,7 +630,7 @@ QVariant MessagesModel::data(const QModelIndex& idx, int role) const {
     }
 
     case Qt::EditRole:
-      return m_cache->containsData(idx.row()) ? m_cache->data(idx) : QSqlQueryModel::data(idx, role);
+      return m_cache->containsData(idx) ? m_cache->data(idx) : rawData(idx);
 
     case Qt::FontRole: {
       QModelIndex idx_read = index(idx.row(), MSG_DB_READ_INDEX);
@@ -282,14 +663,14 @@ QVariant MessagesModel::data(const QModelIndex& idx, int role) const {
       switch (m_messageHighlighter) {
         case HighlightImportant: {
           QModelIndex idx_important = index(idx.row(), MSG_DB_IMPORTANT_INDEX);
-          QVariant dta = m_cache->containsData(idx_important.row()) ? m_cache->data(idx_important) : QSqlQueryModel::data(idx_important);
+          QVariant dta = m_cache->containsData(idx_important) ? m_cache->data(idx_important) : rawData(idx_important);
 
           return dta.toInt() == 1 ? qApp->skins()->currentSkin().m_colorPalette[Skin::PaletteColors::Highlight] : QVariant();
         }
 
         case HighlightUnread: {
           QModelIndex idx_read = index(idx.row(), MSG_DB_READ_INDEX);
-          QVariant dta = m_cache->containsData(idx_read.row()) ? m_cache->data(idx_read) : QSqlQueryModel::data(idx_read);
+          QVariant dta = m_cache->containsData(idx_read) ? m_cache->data(idx_read) : rawData(idx_read);
 
           return dta.toInt() == 0 ? qApp->skins()->currentSkin().m_colorPalette[Skin::PaletteColors::Highlight] : QVariant();
         }
@@ -304,19 +685,19 @@ QVariant MessagesModel::data(const QModelIndex& idx, int role) const {
 
       if (index_column == MSG_DB_READ_INDEX) {
         QModelIndex idx_read = index(idx.row(), MSG_DB_READ_INDEX);
-        QVariant dta = m_cache->containsData(idx_read.row()) ? m_cache->data(idx_read) : QSqlQueryModel::data(idx_read);
+        QVariant dta = m_cache->containsData(idx_read) ? m_cache->data(idx_read) : rawData(idx_read);
 
         return dta.toInt() == 1 ? m_readIcon : m_unreadIcon;
       }
       else if (index_column == MSG_DB_IMPORTANT_INDEX) {
         QModelIndex idx_important = index(idx.row(), MSG_DB_IMPORTANT_INDEX);
-        QVariant dta = m_cache->containsData(idx_important.row()) ? m_cache->data(idx_important) : QSqlQueryModel::data(idx_important);
+        QVariant dta = m_cache->containsData(idx_important) ? m_cache->data(idx_important) : rawData(idx_important);
 
         return dta.toInt() == 1 ? m_favoriteIcon : QVariant();
       }
       else if (index_column == MSG_DB_HAS_ENCLOSURES) {
         QModelIndex idx_important = index(idx.row(), MSG_DB_HAS_ENCLOSURES);
-        QVariant dta = QSqlQueryModel::data(idx_important);
+        QVariant dta = rawData(idx_important);
 
         return dta.toBool() ? m_enclosuresIcon : QVariant();
       }
@@ -337,7 +718,7 @@ bool MessagesModel::setMessageRead(int row_index, RootItem::ReadStatus read) {
     return true;
   }
 
-  Message message = messageAt(row_index);
+  Message message = messageHeaderAt(row_index);
 
   if (!m_selectedItem->getParentServiceRoot()->onBeforeSetMessagesRead(m_selectedItem, QList<Message>() << message, read)) {
     // Cannot change read status of the item. Abort.
@@ -362,21 +743,22 @@ bool MessagesModel::setMessageRead(int row_index, RootItem::ReadStatus read) {
 }
 
 bool MessagesModel::setMessageReadById(int id, RootItem::ReadStatus read) {
-  for (int i = 0; i < rowCount(); i++) {
-    int found_id = data(i, MSG_DB_ID_INDEX, Qt::EditRole).toInt();
+  const int row = loadedMessageRow(id);
 
-    if (found_id == id) {
-      bool set = setData(index(i, MSG_DB_READ_INDEX), read);
+  if (row < 0) {
+    // Messages which are not loaded are read from database later,
+    // their flags are then taken from the store, so it must be updated.
+    m_store.setFlag(m_store.row(id), MessagesModelStore::flagOfColumn(MSG_DB_READ_INDEX), read != 0);
+    return true;
+  }
 
-      if (set) {
-        emit dataChanged(index(i, 0), index(i, MSG_DB_CUSTOM_HASH_INDEX));
-      }
+  const bool set = setData(index(row, MSG_DB_READ_INDEX), read);
 
-      return set;
-    }
+  if (set) {
+    emit dataChanged(index(row, 0), index(row, MSG_DB_CUSTOM_HASH_INDEX));
   }
 
-  return false;
+  return set;
 }
 
 bool MessagesModel::switchMessageImportance(int row_index) {
@@ -384,7 +766,7 @@ bool MessagesModel::switchMessageImportance(int row_index) {
   const RootItem::Importance current_importance = (RootItem::Importance) data(target_index, Qt::EditRole).toInt();
   const RootItem::Importance next_importance = current_importance == RootItem::Important ?
                                                RootItem::NotImportant : RootItem::Important;
-  const Message message = messageAt(row_index);
+  const Message message = messageHeaderAt(row_index);
   const QPair<Message, RootItem::Importance> pair(message, next_importance);
 
   if (!m_selectedItem->getParentServiceRoot()->onBeforeSwitchMessageImportance(m_selectedItem,
@@ -420,7 +802,7 @@ bool MessagesModel::switchBatchMessageImportance(const QModelIndexList& messages
 
   // Obtain IDs of all desired messages.
   foreach (const QModelIndex& message, messages) {
-    const Message msg = messageAt(message.row());
+    const Message msg = messageHeaderAt(message.row());
 
     RootItem::Importance message_importance = messageImportance((message.row()));
     message_states.append(QPair<Message, RootItem::Importance>(msg, message_importance == RootItem::Important ?
@@ -455,7 +837,7 @@ bool MessagesModel::setBatchMessagesDeleted(const QModelIndexList& messages) {
 
   // Obtain IDs of all desired messages.
   foreach (const QModelIndex& message, messages) {
-    const Message msg = messageAt(message.row());
+    const Message msg = messageHeaderAt(message.row());
 
     msgs.append(msg);
     message_ids.append(QString::number(msg.m_id));
@@ -498,7 +880,7 @@ bool MessagesModel::setBatchMessagesRead(const QModelIndexList& messages, RootIt
 
   // Obtain IDs of all desired messages.
   foreach (const QModelIndex& message, messages) {
-    Message msg = messageAt(message.row());
+    Message msg = messageHeaderAt(message.row());
 
     msgs.append(msg);
     message_ids.append(QString::number(msg.m_id));
@@ -526,7 +908,7 @@ bool MessagesModel::setBatchMessagesRestored(const QModelIndexList& messages) {
 
   // Obtain IDs of all desired messages.
   foreach (const QModelIndex& message, messages) {
-    const Message msg = messageAt(message.row());
+    const Message msg = messageHeaderAt(message.row());
 
     msgs.append(msg);
     message_ids.append(QString::number(msg.m_id));
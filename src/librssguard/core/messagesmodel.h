@@ -4,18 +4,24 @@
 #define MESSAGESMODEL_H
 
 #include "core/messagesmodelsqllayer.h"
-#include <QSqlQueryModel>
+#include <QAbstractTableModel>
 
 #include "core/message.h"
+#include "core/messagesmodelstore.h"
 #include "definitions/definitions.h"
 #include "services/abstract/rootitem.h"
 
+#include <QCache>
 #include <QFont>
+#include <QHash>
 #include <QIcon>
+#include <QSqlRecord>
+#include <QVector>
 
 class MessagesModelCache;
+class QTimer;
 
-class MessagesModel : public QSqlQueryModel, public MessagesModelSqlLayer {
+class MessagesModel : public QAbstractTableModel, public MessagesModelSqlLayer {
   Q_OBJECT
 
   public:
@@ -32,20 +38,34 @@ class MessagesModel : public QSqlQueryModel, public MessagesModelSqlLayer {
     explicit MessagesModel(QObject* parent = nullptr);
     virtual ~MessagesModel();
 
-    // Fetches ALL available data to the model.
-    // NOTE: This activates the SQL query and populates the model with new data.
+    // Loads metadata of messages matching current filter and resets the model.
+    // NOTE: Messages themselves are loaded later by pages, when
+    // they are needed, so that only visible part of possibly huge
+    // list of messages is kept in memory.
     void repopulate();
 
+    // Sorts messages by current sort state. Messages are sorted in memory
+    // if they are sorted only by columns held in MessagesModelStore,
+    // otherwise they are loaded from database again.
+    void resort();
+
     // Model implementation.
+    int rowCount(const QModelIndex& parent = QModelIndex()) const;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const;
     bool setData(const QModelIndex& index, const QVariant& value, int role = Qt::EditRole);
     QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const;
     QVariant data(int row, int column, int role = Qt::DisplayRole) const;
     QVariant headerData(int section, Qt::Orientation orientation, int role) const;
     Qt::ItemFlags flags(const QModelIndex& index) const;
 
-    // Returns message at given index.
+    // Returns message at given index, including its contents
+    // and enclosures, which are loaded from database on demand.
     Message messageAt(int row_index) const;
     int messageId(int row_index) const;
+
+    // Returns row of message with given ID or -1 if
+    // the message is not in the model.
+    int messageRow(int id) const;
     RootItem::Importance messageImportance(int row_index) const;
 
     RootItem* loadedItem() const;
@@ -70,6 +90,10 @@ class MessagesModel : public QSqlQueryModel, public MessagesModelSqlLayer {
     // Loads messages of given feeds.
     void loadMessages(RootItem* item);
 
+    // Displays messages of whole account of loaded item which match
+    // the pattern, empty pattern displays messages of the item again.
+    void searchMessages(const QString& pattern);
+
   public slots:
 
     // NOTE: These methods DO NOT actually change data in the DB, just in the model.
@@ -77,14 +101,62 @@ class MessagesModel : public QSqlQueryModel, public MessagesModelSqlLayer {
     bool setMessageImportantById(int id, RootItem::Importance important);
     bool setMessageReadById(int id, RootItem::ReadStatus read);
 
+  private slots:
+    void prefetchBodies();
+
   private:
+    struct MessageBody {
+      QString m_contents;
+      QString m_enclosures;
+    };
+
     void setupHeaderData();
     void setupIcons();
 
+    // Returns message at given index without contents and enclosures.
+    Message messageHeaderAt(int row_index) const;
+
+    // Returns contents and enclosures of message, nullptr if they cannot be loaded.
+    const MessageBody* messageBody(int id) const;
+    void loadBodies(const QList<int>& ids) const;
+
+    // Returns message record as loaded from database.
+    QSqlRecord record(int row_index) const;
+    QVariant rawData(const QModelIndex& index) const;
+
+    // Returns row of message with given ID if it is loaded, -1 otherwise.
+    int loadedMessageRow(int id) const;
+
+    void loadPage(int page) const;
+    void loadPageByIds(int page, int page_rows) const;
+    void evictPages() const;
+    bool isPageModified(int page) const;
+
     MessagesModelCache* m_cache;
+    MessagesModelStore m_store;
+    int m_rowCount;
+
+    // If true, order of messages is given by m_store
+    // and pages of messages are loaded by their IDs.
+    bool m_sortedInMemory;
+
+    // Loaded pages of messages and their indexes, least
+    // recently used page is first.
+    mutable QHash<int, QVector<QSqlRecord>> m_pages;
+    mutable QList<int> m_recentPages;
+
+    // Rows of messages from loaded pages, indexed by their IDs.
+    mutable QHash<int, int> m_messageRows;
+
+    // Contents and enclosures of recently previewed messages.
+    mutable QCache<int, MessageBody> m_bodies;
+    QTimer* m_bodyPrefetchTimer;
+    mutable int m_bodyPrefetchRow;
     MessageHighlighter m_messageHighlighter;
     QString m_customDateFormat;
+
     RootItem* m_selectedItem;
+    QString m_searchPattern;
 
     QList<QString> m_headerData;
     QList<QString> m_tooltipData;
@@ -2,18 +2,55 @@
 
 #include "core/messagesmodelcache.h"
 
-#include "miscellaneous/textfactory.h"
+#include "definitions/definitions.h"
+
+using MessageFlag = MessagesModelStore::MessageFlag;
 
 MessagesModelCache::MessagesModelCache(QObject* parent) : QObject(parent) {}
 
-void MessagesModelCache::setData(const QModelIndex& index, const QVariant& value, const QSqlRecord& record) {
-  if (!m_msgCache.contains(index.row())) {
-    m_msgCache[index.row()] = record;
+bool MessagesModelCache::containsData(const QModelIndex& idx) const {
+  const MessageFlag flag = MessagesModelStore::flagOfColumn(idx.column());
+
+  return flag != MessagesModelStore::NoFlag && (m_msgFlags.value(idx.row()).m_changed & flag) != 0;
+}
+
+bool MessagesModelCache::setData(const QModelIndex& index, const QVariant& value) {
+  const MessageFlag flag = MessagesModelStore::flagOfColumn(index.column());
+
+  if (flag == MessagesModelStore::NoFlag) {
+    return false;
   }
 
-  m_msgCache[index.row()].setValue(index.column(), value);
+  MessageFlags& flags = m_msgFlags[index.row()];
+
+  flags.m_changed |= flag;
+
+  if (value.toInt() != 0) {
+    flags.m_values |= flag;
+  }
+  else {
+    flags.m_values &= ~flag;
+  }
+
+  return true;
+}
+
+QVariant MessagesModelCache::data(const QModelIndex& idx) const {
+  const MessageFlag flag = MessagesModelStore::flagOfColumn(idx.column());
+
+  return (m_msgFlags.value(idx.row()).m_values & flag) != 0 ? 1 : 0;
 }
 
-QVariant MessagesModelCache::data(const QModelIndex& idx) {
-  return m_msgCache[idx.row()].value(idx.column());
+QSqlRecord MessagesModelCache::record(int row_idx, QSqlRecord record) const {
+  const MessageFlags flags = m_msgFlags.value(row_idx);
+
+  for (int column : { MSG_DB_READ_INDEX, MSG_DB_DELETED_INDEX, MSG_DB_PDELETED_INDEX, MSG_DB_IMPORTANT_INDEX }) {
+    const MessageFlag flag = MessagesModelStore::flagOfColumn(column);
+
+    if ((flags.m_changed & flag) != 0) {
+      record.setValue(column, (flags.m_values & flag) != 0 ? 1 : 0);
+    }
+  }
+
+  return record;
 }
@@ -5,11 +5,16 @@
 
 #include <QObject>
 
-#include "core/message.h"
+#include "core/messagesmodelstore.h"
 
+#include <QHash>
 #include <QModelIndex>
+#include <QSqlRecord>
 #include <QVariant>
 
+// Holds changes of messages done in the model but not reloaded from database yet.
+// NOTE: Only flags of messages can be changed, so just the flags are
+// stored for each changed row instead of copy of whole message record.
 class MessagesModelCache : public QObject {
   Q_OBJECT
 
@@ -17,24 +22,34 @@ class MessagesModelCache : public QObject {
     explicit MessagesModelCache(QObject* parent = nullptr);
     virtual ~MessagesModelCache() = default;
 
+    // Returns true if any flag of message in given row was changed.
     inline bool containsData(int row_idx) const {
-      return m_msgCache.contains(row_idx);
+      return m_msgFlags.contains(row_idx);
     }
 
-    inline QSqlRecord record(int row_idx) const {
-      return m_msgCache.value(row_idx);
-    }
+    // Returns true if value at given index was changed.
+    bool containsData(const QModelIndex& idx) const;
 
     inline void clear() {
-      m_msgCache.clear();
+      m_msgFlags.clear();
     }
 
-    void setData(const QModelIndex& index, const QVariant& value, const QSqlRecord& record);
+    // Changes value at given index, returns false if
+    // value in given column cannot be changed.
+    bool setData(const QModelIndex& index, const QVariant& value);
+
+    QVariant data(const QModelIndex& idx) const;
 
-    QVariant data(const QModelIndex& idx);
+    // Returns record with changed values of message in given row.
+    QSqlRecord record(int row_idx, QSqlRecord record) const;
 
   private:
-    QHash<int, QSqlRecord> m_msgCache;
+    struct MessageFlags {
+      quint8 m_changed = MessagesModelStore::NoFlag;
+      quint8 m_values = MessagesModelStore::NoFlag;
+    };
+
+    QHash<int, MessageFlags> m_msgFlags;
 };
 
 #endif // MESSAGESMODELCACHE_H
@@ -7,6 +7,7 @@
 
 MessagesModelSqlLayer::MessagesModelSqlLayer() : m_filter(QSL(DEFAULT_SQL_MESSAGES_FILTER)) {
   m_db = qApp->database()->connection(QSL("MessagesModel"));
+  m_readDb = qApp->database()->readOnlyConnection(QSL("MessagesModel"));
 
   // Used in <x>: SELECT <x1>, <x2> FROM ....;
   m_fieldNames[MSG_DB_ID_INDEX] = "Messages.id";
@@ -25,26 +26,28 @@ MessagesModelSqlLayer::MessagesModelSqlLayer() : m_filter(QSL(DEFAULT_SQL_MESSAG
   m_fieldNames[MSG_DB_CUSTOM_ID_INDEX] = "Messages.custom_id";
   m_fieldNames[MSG_DB_CUSTOM_HASH_INDEX] = "Messages.custom_hash";
   m_fieldNames[MSG_DB_FEED_CUSTOM_ID_INDEX] = "Messages.feed";
-  m_fieldNames[MSG_DB_HAS_ENCLOSURES] = "CASE WHEN length(Messages.enclosures) > 10 THEN 'true' ELSE 'false' END AS has_enclosures";
+  m_fieldNames[MSG_DB_HAS_ENCLOSURES] = "CASE WHEN Messages.enclosures IS NULL OR Messages.enclosures = '' THEN 'false' ELSE 'true' END AS has_enclosures";
 
   // Used in <x>: SELECT ... FROM ... ORDER BY <x1> DESC, <x2> ASC;
   m_orderByNames[MSG_DB_ID_INDEX] = "Messages.id";
   m_orderByNames[MSG_DB_READ_INDEX] = "Messages.is_read";
   m_orderByNames[MSG_DB_DELETED_INDEX] = "Messages.is_deleted";
   m_orderByNames[MSG_DB_IMPORTANT_INDEX] = "Messages.is_important";
-  m_orderByNames[MSG_DB_FEED_TITLE_INDEX] = "Feeds.title";
+  // NOTE: Nullable columns are coalesced, because they are
+  // also compared in WHERE clauses of keyset pagination.
+  m_orderByNames[MSG_DB_FEED_TITLE_INDEX] = "COALESCE(Feeds.title, '')";
   m_orderByNames[MSG_DB_TITLE_INDEX] = "Messages.title";
-  m_orderByNames[MSG_DB_URL_INDEX] = "Messages.url";
-  m_orderByNames[MSG_DB_AUTHOR_INDEX] = "Messages.author";
+  m_orderByNames[MSG_DB_URL_INDEX] = "COALESCE(Messages.url, '')";
+  m_orderByNames[MSG_DB_AUTHOR_INDEX] = "COALESCE(Messages.author, '')";
   m_orderByNames[MSG_DB_DCREATED_INDEX] = "Messages.date_created";
-  m_orderByNames[MSG_DB_CONTENTS_INDEX] = "Messages.contents";
+  m_orderByNames[MSG_DB_CONTENTS_INDEX] = "COALESCE(Messages.contents, '')";
   m_orderByNames[MSG_DB_PDELETED_INDEX] = "Messages.is_pdeleted";
-  m_orderByNames[MSG_DB_ENCLOSURES_INDEX] = "Messages.enclosures";
+  m_orderByNames[MSG_DB_ENCLOSURES_INDEX] = "COALESCE(Messages.enclosures, '')";
   m_orderByNames[MSG_DB_ACCOUNT_ID_INDEX] = "Messages.account_id";
-  m_orderByNames[MSG_DB_CUSTOM_ID_INDEX] = "Messages.custom_id";
-  m_orderByNames[MSG_DB_CUSTOM_HASH_INDEX] = "Messages.custom_hash";
+  m_orderByNames[MSG_DB_CUSTOM_ID_INDEX] = "COALESCE(Messages.custom_id, '')";
+  m_orderByNames[MSG_DB_CUSTOM_HASH_INDEX] = "COALESCE(Messages.custom_hash, '')";
   m_orderByNames[MSG_DB_FEED_CUSTOM_ID_INDEX] = "Messages.feed";
-  m_orderByNames[MSG_DB_HAS_ENCLOSURES] = "has_enclosures";
+  m_orderByNames[MSG_DB_HAS_ENCLOSURES] = "CASE WHEN Messages.enclosures IS NULL OR Messages.enclosures = '' THEN 'false' ELSE 'true' END";
 }
 
 void MessagesModelSqlLayer::addSortState(int column, Qt::SortOrder order) {
@@ -76,12 +79,29 @@ void MessagesModelSqlLayer::addSortState(int column, Qt::SortOrder order) {
   qDebug("Added sort state, select statement is now:\n'%s'", qPrintable(selectStatement()));
 }
 
+QString MessagesModelSqlLayer::filter() const {
+  return m_filter;
+}
+
 void MessagesModelSqlLayer::setFilter(const QString& filter) {
   m_filter = filter;
 }
 
 QString MessagesModelSqlLayer::formatFields() const {
-  return m_fieldNames.values().join(QSL(", "));
+  QStringList fields = m_fieldNames.values();
+
+  // Contents and enclosures are not displayed in the list, they are
+  // loaded separately for previewed messages. They are selected only
+  // if they are needed for keyset pagination.
+  if (!m_sortColumns.contains(MSG_DB_CONTENTS_INDEX)) {
+    fields[MSG_DB_CONTENTS_INDEX] = QSL("NULL AS contents");
+  }
+
+  if (!m_sortColumns.contains(MSG_DB_ENCLOSURES_INDEX)) {
+    fields[MSG_DB_ENCLOSURES_INDEX] = QSL("NULL AS enclosures");
+  }
+
+  return fields.join(QSL(", "));
 }
 
 QString MessagesModelSqlLayer::selectStatement() const {
@@ -91,19 +111,117 @@ QString MessagesModelSqlLayer::selectStatement() const {
          m_filter + orderByClause() + QL1C(';');
 }
 
-QString MessagesModelSqlLayer::orderByClause() const {
-  if (m_sortColumns.isEmpty()) {
-    return QString();
+QString MessagesModelSqlLayer::selectStatement(const QString& condition, bool backwards, int limit, int offset) const {
+  QString statement = QL1S("SELECT ") + formatFields() + QL1C(' ') +
+                      QL1S("FROM Messages LEFT JOIN Feeds ON Messages.feed = Feeds.custom_id AND Messages.account_id = Feeds.account_id "
+                           "WHERE (") + m_filter + QL1C(')');
+
+  if (!condition.isEmpty()) {
+    statement += QL1S(" AND ") + condition;
   }
-  else {
-    QStringList sorts;
 
-    for (int i = 0; i < m_sortColumns.size(); i++) {
-      QString field_name(m_orderByNames[m_sortColumns[i]]);
+  statement += orderByClause(backwards) + QString(QSL(" LIMIT %1")).arg(limit);
+
+  if (offset > 0) {
+    statement += QString(QSL(" OFFSET %1")).arg(offset);
+  }
+
+  return statement + QL1C(';');
+}
+
+QString MessagesModelSqlLayer::countStatement(const QString& condition) const {
+  QString statement = QL1S("SELECT count(*) "
+                           "FROM Messages LEFT JOIN Feeds ON Messages.feed = Feeds.custom_id AND Messages.account_id = Feeds.account_id "
+                           "WHERE (") + m_filter + QL1C(')');
+
+  if (!condition.isEmpty()) {
+    statement += QL1S(" AND ") + condition;
+  }
 
-      sorts.append(field_name + (m_sortOrders[i] == Qt::AscendingOrder ? QSL(" ASC") : QSL(" DESC")));
+  return statement + QL1C(';');
+}
+
+QString MessagesModelSqlLayer::selectStatement(const QList<int>& ids) const {
+  QStringList id_strings;
+
+  for (int id : ids) {
+    id_strings.append(QString::number(id));
+  }
+
+  return QL1S("SELECT ") + formatFields() + QL1C(' ') +
+         QL1S("FROM Messages LEFT JOIN Feeds ON Messages.feed = Feeds.custom_id AND Messages.account_id = Feeds.account_id "
+              "WHERE Messages.id IN (") + id_strings.join(QL1C(',')) + QL1S(");");
+}
+
+QString MessagesModelSqlLayer::storeStatement() const {
+  return QL1S("SELECT Messages.id, Messages.is_read, Messages.is_deleted, Messages.is_pdeleted, Messages.is_important, "
+              "CASE WHEN Messages.enclosures IS NULL OR Messages.enclosures = '' THEN 0 ELSE 1 END, "
+              "Messages.date_created, Feeds.title, Messages.author "
+              "FROM Messages LEFT JOIN Feeds ON Messages.feed = Feeds.custom_id AND Messages.account_id = Feeds.account_id "
+              "WHERE (") + m_filter + QL1S(");");
+}
+
+QString MessagesModelSqlLayer::keysetCondition(bool backwards) const {
+  const QList<QPair<int, Qt::SortOrder>> keys = sortKeys();
+  QStringList alternatives;
+
+  // Message follows the key if it has equal values of all
+  // more important sort columns and "greater" value of the current one.
+  for (int i = 0; i < keys.size(); i++) {
+    QStringList parts;
+
+    for (int j = 0; j < i; j++) {
+      parts.append(m_orderByNames[keys[j].first] + QSL(" = ?"));
     }
 
-    return QL1S(" ORDER BY ") + sorts.join(QSL(", "));
+    const bool ascending = (keys[i].second == Qt::AscendingOrder) != backwards;
+
+    parts.append(m_orderByNames[keys[i].first] + (ascending ? QSL(" > ?") : QSL(" < ?")));
+    alternatives.append(QL1C('(') + parts.join(QSL(" AND ")) + QL1C(')'));
   }
+
+  return QL1C('(') + alternatives.join(QSL(" OR ")) + QL1C(')');
+}
+
+QVariantList MessagesModelSqlLayer::keysetValues(const QSqlRecord& record) const {
+  const QList<QPair<int, Qt::SortOrder>> keys = sortKeys();
+  QVariantList values;
+
+  for (int i = 0; i < keys.size(); i++) {
+    for (int j = 0; j <= i; j++) {
+      const QVariant value = record.value(keys[j].first);
+
+      // Nullable columns are coalesced to empty strings.
+      values.append(value.isNull() ? QVariant(QString()) : value);
+    }
+  }
+
+  return values;
+}
+
+QList<QPair<int, Qt::SortOrder>> MessagesModelSqlLayer::sortKeys() const {
+  QList<QPair<int, Qt::SortOrder>> keys;
+
+  for (int i = 0; i < m_sortColumns.size(); i++) {
+    keys.append(QPair<int, Qt::SortOrder>(m_sortColumns[i], m_sortOrders[i]));
+  }
+
+  if (!m_sortColumns.contains(MSG_DB_ID_INDEX)) {
+    keys.append(QPair<int, Qt::SortOrder>(MSG_DB_ID_INDEX, Qt::AscendingOrder));
+  }
+
+  return keys;
+}
+
+QString MessagesModelSqlLayer::orderByClause(bool backwards) const {
+  const QList<QPair<int, Qt::SortOrder>> keys = sortKeys();
+  QStringList sorts;
+
+  for (const QPair<int, Qt::SortOrder>& key : keys) {
+    const bool ascending = (key.second == Qt::AscendingOrder) != backwards;
+
+    sorts.append(m_orderByNames[key.first] + (ascending ? QSL(" ASC") : QSL(" DESC")));
+  }
+
+  return QL1S(" ORDER BY ") + sorts.join(QSL(", "));
 }
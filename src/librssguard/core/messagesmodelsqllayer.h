@@ -7,6 +7,8 @@
 
 #include <QList>
 #include <QMap>
+#include <QSqlRecord>
+#include <QVariantList>
 
 class MessagesModelSqlLayer {
   public:
@@ -16,16 +18,44 @@ class MessagesModelSqlLayer {
     void addSortState(int column, Qt::SortOrder order);
 
     // Sets SQL WHERE clause, without "WHERE" keyword.
+    QString filter() const;
     void setFilter(const QString& filter);
 
   protected:
-    QString orderByClause() const;
+    QString orderByClause(bool backwards = false) const;
     QString selectStatement() const;
     QString formatFields() const;
 
+    // Statements for loading of messages by windows. Each of them
+    // can be restricted by additional "condition".
+    QString selectStatement(const QString& condition, bool backwards, int limit, int offset = 0) const;
+    QString countStatement(const QString& condition = QString()) const;
+
+    // Keyset pagination. Returns condition which matches messages
+    // following (or preceding if "backwards" is true) the message
+    // in current sort order and values to be bound to it.
+    QString keysetCondition(bool backwards) const;
+    QVariantList keysetValues(const QSqlRecord& record) const;
+
+    // Selects messages with given IDs regardless of filter, in no particular order.
+    QString selectStatement(const QList<int>& ids) const;
+
+    // Selects metadata of all messages matching the filter for MessagesModelStore:
+    // ID, read, deleted, permanently deleted, important and has enclosures flags,
+    // date of creation, feed title and author.
+    QString storeStatement() const;
+
+    // Returns sort columns with ID of message appended
+    // as last one, so that order of messages is total.
+    QList<QPair<int, Qt::SortOrder>> sortKeys() const;
+
     QSqlDatabase m_db;
 
+    // Connection for loading of messages, see DatabaseFactory::readOnlyConnection().
+    QSqlDatabase m_readDb;
+
   private:
+
     QString m_filter;
 
     // NOTE: These two lists contain data for multicolumn sorting.
@@ -0,0 +1,278 @@
+// For license of this file, see <project-root-folder>/LICENSE.md.
+
+#include "core/messagesmodelstore.h"
+
+#include "definitions/definitions.h"
+
+#include <QElapsedTimer>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QStringList>
+#include <QThread>
+
+#include <algorithm>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+MessagesModelStore::MessagesModelStore() {}
+
+bool MessagesModelStore::load(QSqlDatabase db, const QString& statement) {
+  QSqlQuery q(db);
+  QHash<QString, int> feed_titles;
+  QHash<QString, int> authors;
+
+  clear();
+  q.setForwardOnly(true);
+
+  if (!q.exec(statement)) {
+    qCritical("Error when loading messages for msg view: '%s'.", qPrintable(q.lastError().text()));
+    return false;
+  }
+
+  while (q.next()) {
+    quint8 flags = NoFlag;
+
+    if (q.value(1).toInt() == 1) {
+      flags |= Read;
+    }
+
+    if (q.value(2).toInt() == 1) {
+      flags |= Deleted;
+    }
+
+    if (q.value(3).toInt() == 1) {
+      flags |= PermanentlyDeleted;
+    }
+
+    if (q.value(4).toInt() == 1) {
+      flags |= Important;
+    }
+
+    if (q.value(5).toInt() == 1) {
+      flags |= HasEnclosures;
+    }
+
+    m_ids.append(q.value(0).toInt());
+    m_flags.append(flags);
+    m_dates.append(q.value(6).value<qint64>());
+    m_feedTitles.append(internString(q.value(7).toString(), feed_titles));
+    m_authors.append(internString(q.value(8).toString(), authors));
+  }
+
+  rankStrings(feed_titles, m_feedTitles);
+  rankStrings(authors, m_authors);
+
+  m_order.resize(m_ids.size());
+  m_rows.resize(m_ids.size());
+  m_idOrder.resize(m_ids.size());
+  std::iota(m_order.begin(), m_order.end(), 0);
+  std::iota(m_rows.begin(), m_rows.end(), 0);
+  std::iota(m_idOrder.begin(), m_idOrder.end(), 0);
+  std::sort(m_idOrder.begin(), m_idOrder.end(), [this](int left, int right) {
+    return m_ids.at(left) < m_ids.at(right);
+  });
+
+  return true;
+}
+
+void MessagesModelStore::clear() {
+  m_ids.clear();
+  m_flags.clear();
+  m_dates.clear();
+  m_feedTitles.clear();
+  m_authors.clear();
+  m_order.clear();
+  m_rows.clear();
+  m_idOrder.clear();
+}
+
+int MessagesModelStore::row(int id) const {
+  auto message = std::lower_bound(m_idOrder.constBegin(), m_idOrder.constEnd(), id, [this](int message, int id) {
+    return m_ids.at(message) < id;
+  });
+
+  if (message == m_idOrder.constEnd() || m_ids.at(*message) != id) {
+    return -1;
+  }
+  else {
+    return m_rows.at(*message);
+  }
+}
+
+bool MessagesModelStore::hasFlag(int row, MessagesModelStore::MessageFlag flag) const {
+  return (m_flags.at(m_order.at(row)) & flag) != 0;
+}
+
+void MessagesModelStore::setFlag(int row, MessagesModelStore::MessageFlag flag, bool value) {
+  if (row < 0 || row >= size() || flag == NoFlag) {
+    return;
+  }
+
+  quint8& flags = m_flags[m_order.at(row)];
+
+  if (value) {
+    flags |= flag;
+  }
+  else {
+    flags &= ~flag;
+  }
+}
+
+void MessagesModelStore::sort(const QList<QPair<int, Qt::SortOrder>>& keys) {
+  auto less_than = [this, &keys](int left, int right) {
+    return lessThan(left, right, keys);
+  };
+  const int chunks = QThread::idealThreadCount();
+  int* order = m_order.data();
+  QElapsedTimer tmr;
+
+  tmr.start();
+
+  if (chunks > 1 && size() >= MESSAGES_MODEL_PARALLEL_SORT_ROWS) {
+    // Very long lists are sorted in chunks by multiple
+    // threads, sorted chunks are then merged together.
+    std::vector<std::thread> workers;
+    QVector<int> bounds;
+
+    for (int i = 0; i <= chunks; i++) {
+      bounds.append(int(qint64(size()) * i / chunks));
+    }
+
+    for (int i = 0; i < chunks; i++) {
+      workers.emplace_back([order, &bounds, &less_than, i]() {
+        std::sort(order + bounds.at(i), order + bounds.at(i + 1), less_than);
+      });
+    }
+
+    for (std::thread& worker : workers) {
+      worker.join();
+    }
+
+    for (int step = 1; step < chunks; step *= 2) {
+      for (int i = 0; i + step < chunks; i += 2 * step) {
+        std::inplace_merge(order + bounds.at(i), order + bounds.at(i + step),
+                           order + bounds.at(qMin(i + 2 * step, chunks)), less_than);
+      }
+    }
+  }
+  else {
+    std::sort(order, order + size(), less_than);
+  }
+
+  for (int i = 0; i < m_order.size(); i++) {
+    m_rows[m_order.at(i)] = i;
+  }
+
+  qDebug("Sorted %d messages in memory in %lld ms.", size(), tmr.elapsed());
+}
+
+bool MessagesModelStore::canSort(const QList<QPair<int, Qt::SortOrder>>& keys) {
+  for (const QPair<int, Qt::SortOrder>& key : keys) {
+    switch (key.first) {
+      case MSG_DB_ID_INDEX:
+      case MSG_DB_DCREATED_INDEX:
+      case MSG_DB_FEED_TITLE_INDEX:
+      case MSG_DB_AUTHOR_INDEX:
+        break;
+
+      default:
+        if (flagOfColumn(key.first) == NoFlag) {
+          return false;
+        }
+    }
+  }
+
+  return true;
+}
+
+MessagesModelStore::MessageFlag MessagesModelStore::flagOfColumn(int column) {
+  switch (column) {
+    case MSG_DB_READ_INDEX:
+      return Read;
+
+    case MSG_DB_DELETED_INDEX:
+      return Deleted;
+
+    case MSG_DB_PDELETED_INDEX:
+      return PermanentlyDeleted;
+
+    case MSG_DB_IMPORTANT_INDEX:
+      return Important;
+
+    case MSG_DB_HAS_ENCLOSURES:
+      return HasEnclosures;
+
+    default:
+      return NoFlag;
+  }
+}
+
+bool MessagesModelStore::lessThan(int left, int right, const QList<QPair<int, Qt::SortOrder>>& keys) const {
+  for (const QPair<int, Qt::SortOrder>& key : keys) {
+    const qint64 left_value = sortValue(left, key.first);
+    const qint64 right_value = sortValue(right, key.first);
+
+    if (left_value != right_value) {
+      return key.second == Qt::AscendingOrder ? left_value < right_value : left_value > right_value;
+    }
+  }
+
+  return false;
+}
+
+qint64 MessagesModelStore::sortValue(int message, int column) const {
+  switch (column) {
+    case MSG_DB_ID_INDEX:
+      return m_ids.at(message);
+
+    case MSG_DB_DCREATED_INDEX:
+      return m_dates.at(message);
+
+    case MSG_DB_FEED_TITLE_INDEX:
+      return m_feedTitles.at(message);
+
+    case MSG_DB_AUTHOR_INDEX:
+      return m_authors.at(message);
+
+    default:
+      return (m_flags.at(message) & flagOfColumn(column)) != 0 ? 1 : 0;
+  }
+}
+
+int MessagesModelStore::internString(const QString& string, QHash<QString, int>& strings) {
+  auto existing = strings.constFind(string);
+
+  if (existing != strings.constEnd()) {
+    return existing.value();
+  }
+  else {
+    const int index = strings.size();
+
+    strings.insert(string, index);
+    return index;
+  }
+}
+
+void MessagesModelStore::rankStrings(const QHash<QString, int>& strings, QVector<int>& values) {
+  QStringList sorted_strings = strings.keys();
+  QVector<int> ranks(strings.size());
+  int rank = 0;
+
+  std::sort(sorted_strings.begin(), sorted_strings.end(), [](const QString& left, const QString& right) {
+    return left.compare(right, Qt::CaseInsensitive) < 0;
+  });
+
+  // Strings which differ only in case have same rank.
+  for (int i = 0; i < sorted_strings.size(); i++) {
+    if (i > 0 && sorted_strings.at(i).compare(sorted_strings.at(i - 1), Qt::CaseInsensitive) != 0) {
+      rank++;
+    }
+
+    ranks[strings.value(sorted_strings.at(i))] = rank;
+  }
+
+  for (int& value : values) {
+    value = ranks.at(value);
+  }
+}
@@ -0,0 +1,82 @@
+// For license of this file, see <project-root-folder>/LICENSE.md.
+
+#ifndef MESSAGESMODELSTORE_H
+#define MESSAGESMODELSTORE_H
+
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QSqlDatabase>
+#include <QVector>
+
+// Holds compact metadata of all messages displayed in the message list,
+// so that they can be counted, sorted and found without database.
+// NOTE: Metadata are stored column by column. Feed titles and authors
+// are stored as their ranks among all distinct titles and authors,
+// because they are only needed for comparisons.
+class MessagesModelStore {
+  public:
+    enum MessageFlag {
+      NoFlag = 0,
+      Read = 1,
+      Deleted = 2,
+      PermanentlyDeleted = 4,
+      Important = 8,
+      HasEnclosures = 16
+    };
+
+    explicit MessagesModelStore();
+
+    // Loads metadata of messages with given statement. Statement
+    // must select columns listed in MessagesModelSqlLayer::storeStatement().
+    bool load(QSqlDatabase db, const QString& statement);
+    void clear();
+
+    inline int size() const {
+      return m_ids.size();
+    }
+
+    inline int messageId(int row) const {
+      return m_ids.at(m_order.at(row));
+    }
+
+    // Returns row of message with given ID or -1
+    // if the message is not in the store.
+    int row(int id) const;
+
+    bool hasFlag(int row, MessageFlag flag) const;
+    void setFlag(int row, MessageFlag flag, bool value);
+
+    // Sorts messages by given columns, most important column first.
+    // Messages can be sorted only if all columns are stored.
+    void sort(const QList<QPair<int, Qt::SortOrder>>& keys);
+
+    static bool canSort(const QList<QPair<int, Qt::SortOrder>>& keys);
+    static MessageFlag flagOfColumn(int column);
+
+  private:
+    bool lessThan(int left, int right, const QList<QPair<int, Qt::SortOrder>>& keys) const;
+    qint64 sortValue(int message, int column) const;
+
+    // Returns index of string in "strings", string is added if it is not there yet.
+    static int internString(const QString& string, QHash<QString, int>& strings);
+
+    // Replaces indexes of strings in "values" with ranks of strings.
+    static void rankStrings(const QHash<QString, int>& strings, QVector<int>& values);
+
+    // Metadata of messages, one item per message in each vector.
+    QVector<int> m_ids;
+    QVector<quint8> m_flags;
+    QVector<qint64> m_dates;
+    QVector<int> m_feedTitles;
+    QVector<int> m_authors;
+
+    // Messages in current sort order and rows of messages.
+    QVector<int> m_order;
+    QVector<int> m_rows;
+
+    // Messages in ascending order of their IDs.
+    QVector<int> m_idOrder;
+};
+
+#endif // MESSAGESMODELSTORE_H
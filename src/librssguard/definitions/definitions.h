@@ -47,11 +47,29 @@
 #define MESSAGES_VIEW_MINIMUM_COL             16
 #define FEEDS_VIEW_COLUMN_COUNT               2
 #define FEED_DOWNLOADER_MAX_THREADS           3
+#define FEED_DOWNLOADER_MAX_DOWNLOADS         256
+#define FEED_DOWNLOADER_COMMIT_MESSAGES       2000
+#define FEED_DOWNLOADER_COMMIT_FEEDS          100
+#define FEED_DOWNLOADER_COMMIT_INTERVAL       1000
+#define FEED_DOWNLOADER_MAX_HOST_DOWNLOADS    4
+#define FEED_DOWNLOADER_HOST_RATE             2
+#define FEED_DOWNLOADER_HOST_BURST            4
+#define FEED_DOWNLOADER_HOST_JITTER           500
+#define FEED_DOWNLOADER_HOLD_OFF              30000
+#define FEED_DOWNLOADER_MAX_HOLD_OFF          120000
 #define DEFAULT_DAYS_TO_DELETE_MSG            14
 #define ELLIPSIS_LENGTH                       3
 #define MIN_CATEGORY_NAME_LENGTH              1
 #define DEFAULT_AUTO_UPDATE_INTERVAL          15
 #define AUTO_UPDATE_INTERVAL                  60000
+#define FEED_SCHEDULER_MIN_SAMPLES            3
+#define FEED_SCHEDULER_MAX_INTERVAL           86400
+#define FEED_SCHEDULER_IDLE_BACKOFF           1.5
+#define FEED_SCHEDULER_MAX_BACKOFF            8
+#define FEED_SCHEDULER_MIN_DELAY              1000
+#define FEED_SCHEDULER_BATCH_SLACK            5000
+#define FEED_SCHEDULER_SYNC_INTERVAL          60000
+#define FEED_SCHEDULER_BLOCKED_DELAY          30000
 #define STARTUP_UPDATE_DELAY                  30000
 #define TIMEZONE_OFFSET_LIMIT                 6
 #define CHANGE_EVENT_DELAY                    250
@@ -69,7 +87,32 @@
 #define GOOGLE_SEARCH_URL                     "https://www.google.com/search?q=%1&ie=utf-8&oe=utf-8"
 #define GOOGLE_SUGGEST_URL                    "http://suggestqueries.google.com/complete/search?output=toolbar&hl=en&q=%1"
 #define ENCRYPTION_FILE_NAME                  "key.private"
-#define RELOAD_MODEL_BORDER_NUM               10
+
+// Keep number of bound values per statement
+// under 999, which is default limit of SQLite.
+#define MESSAGES_INSERT_BATCH_SIZE            66
+#define MESSAGES_SELECT_BATCH_SIZE            500
+
+// Retention policies remove messages in small batches, so
+// that feed updates never lock database for long.
+#define MESSAGES_RETENTION_BATCH_SIZE         200
+#define MESSAGES_RETENTION_MAX_BATCHES        5
+
+// Only message bodies larger than this many bytes
+// are worth compressing.
+#define MESSAGES_COMPRESSION_THRESHOLD        1024
+#define MESSAGES_COMPRESSION_BATCH_SIZE       100
+
+// Messages list loads messages by pages and keeps
+// only limited number of recently used pages.
+#define MESSAGES_MODEL_PAGE_SIZE              256
+#define MESSAGES_MODEL_MAX_PAGES              24
+#define MESSAGES_MODEL_PREFETCH_ROWS          64
+#define MESSAGES_MODEL_BODY_CACHE_SIZE        64
+#define MESSAGES_MODEL_BODY_PREFETCH_ROWS     4
+#define MESSAGES_MODEL_PARALLEL_SORT_ROWS     100000
+#define MESSAGES_SEARCH_LIMIT                 1000
+#define MESSAGES_SEARCH_DELAY                 300
 #define EXTERNAL_TOOL_SEPARATOR               "###"
 #define EXTERNAL_TOOL_PARAM_SEPARATOR         "|||"
 
@@ -77,6 +120,16 @@
 #define HTTP_HEADERS_CONTENT_TYPE   "Content-Type"
 #define HTTP_HEADERS_AUTHORIZATION  "Authorization"
 #define HTTP_HEADERS_USER_AGENT     "User-Agent"
+#define HTTP_HEADERS_ETAG           "ETag"
+#define HTTP_HEADERS_LAST_MODIFIED  "Last-Modified"
+#define HTTP_HEADERS_IF_NONE_MATCH  "If-None-Match"
+#define HTTP_HEADERS_IF_MOD_SINCE   "If-Modified-Since"
+#define HTTP_HEADERS_CACHE_CONTROL  "Cache-Control"
+#define HTTP_HEADERS_RETRY_AFTER    "Retry-After"
+
+#define HTTP_CODE_NOT_MODIFIED      304
+#define HTTP_CODE_TOO_MANY_REQUESTS 429
+#define HTTP_CODE_UNAVAILABLE       503
 
 #define MAX_ZOOM_FACTOR     5.0f
 #define MIN_ZOOM_FACTOR     0.25f
@@ -113,10 +166,14 @@
 #define APP_DB_SQLITE_FILE            "database.db"
 
 // Keep this in sync with schema versions declared in SQL initialization code.
-#define APP_DB_SCHEMA_VERSION         "11"
+#define APP_DB_SCHEMA_VERSION         "18"
 #define APP_DB_UPDATE_FILE_PATTERN    "db_update_%1_%2_%3.sql"
 #define APP_DB_COMMENT_SPLIT          "-- !\n"
 #define APP_DB_NAME_PLACEHOLDER       "##"
+#define APP_DB_SQLITE_WAL_SUFFIX      "-wal"
+#define APP_DB_SQLITE_WAL_CHECKPOINT  300000
+#define APP_DB_PREPARED_QUERIES       64
+#define APP_DB_COMPRESSION_INTERVAL   2000
 
 #define APP_CFG_PATH        "config"
 #define APP_CFG_FILE        "config.ini"
@@ -182,6 +239,9 @@
 #define CAT_DB_ICON_INDEX         5
 #define CAT_DB_ACCOUNT_ID_INDEX   6
 #define CAT_DB_CUSTOM_ID_INDEX    7
+#define CAT_DB_RETENTION_COUNT_INDEX  8
+#define CAT_DB_RETENTION_DAYS_INDEX   9
+#define CAT_DB_RETENTION_KEEP_IMPORTANT_INDEX 10
 
 // Indexes of columns as they are DEFINED IN THE TABLE for FEEDS.
 #define FDS_DB_ID_INDEX               0
@@ -200,6 +260,11 @@
 #define FDS_DB_TYPE_INDEX             13
 #define FDS_DB_ACCOUNT_ID_INDEX       14
 #define FDS_DB_CUSTOM_ID_INDEX        15
+#define FDS_DB_HTTP_ETAG_INDEX        16
+#define FDS_DB_HTTP_LAST_MOD_INDEX    17
+#define FDS_DB_RETENTION_COUNT_INDEX  18
+#define FDS_DB_RETENTION_DAYS_INDEX   19
+#define FDS_DB_RETENTION_KEEP_IMPORTANT_INDEX 20
 
 // Indexes of columns for feed models.
 #define FDS_MODEL_TITLE_INDEX           0
@@ -24,9 +24,9 @@
 #include "miscellaneous/databasefactory.h"
 #include "miscellaneous/feedreader.h"
 #include "miscellaneous/iconfactory.h"
-#include "miscellaneous/mutex.h"
 #include "miscellaneous/settings.h"
 #include "miscellaneous/systemfactory.h"
+#include "miscellaneous/updatelock.h"
 #include "network-web/webfactory.h"
 #include "services/abstract/recyclebin.h"
 #include "services/abstract/serviceroot.h"
@@ -101,13 +101,13 @@ StatusBar* FormMain::statusBar() const {
 }
 
 void FormMain::showDbCleanupAssistant() {
-  if (qApp->feedUpdateLock()->tryLock()) {
+  if (qApp->feedUpdateLock()->tryLockAll()) {
     FormDatabaseCleanup form(this);
 
     form.exec();
 
     // Reload needed stuff.
-    qApp->feedUpdateLock()->unlock();
+    qApp->feedUpdateLock()->unlockAll();
     tabWidget()->feedMessageViewer()->messagesView()->reloadSelections();
     qApp->feedReader()->feedsModel()->reloadCountsOfWholeModel();
   }
@@ -398,7 +398,8 @@ void FormMain::updateMessageButtonsAvailability() {
 
 void FormMain::updateFeedButtonsAvailability() {
   const bool is_update_running = qApp->feedReader()->isFeedUpdateRunning();
-  const bool critical_action_running = qApp->feedUpdateLock()->isLocked();
+  const bool critical_action_running = qApp->feedUpdateLock()->isAllLocked();
+  const bool anything_locked = qApp->feedUpdateLock()->isAnythingLocked();
   const RootItem* selected_item = tabWidget()->feedMessageViewer()->feedsView()->selectedItem();
   const bool anything_selected = selected_item != nullptr;
   const bool feed_selected = anything_selected && selected_item->kind() == RootItemKind::Feed;
@@ -406,8 +407,8 @@ void FormMain::updateFeedButtonsAvailability() {
   const bool service_selected = anything_selected && selected_item->kind() == RootItemKind::ServiceRoot;
 
   m_ui->m_actionStopRunningItemsUpdate->setEnabled(is_update_running);
-  m_ui->m_actionBackupDatabaseSettings->setEnabled(!critical_action_running);
-  m_ui->m_actionCleanupDatabase->setEnabled(!critical_action_running);
+  m_ui->m_actionBackupDatabaseSettings->setEnabled(!anything_locked);
+  m_ui->m_actionCleanupDatabase->setEnabled(!anything_locked);
   m_ui->m_actionClearSelectedItems->setEnabled(anything_selected);
   m_ui->m_actionDeleteSelectedItem->setEnabled(!critical_action_running && anything_selected);
   m_ui->m_actionEditSelectedItem->setEnabled(!critical_action_running && anything_selected);
@@ -647,8 +648,7 @@ void FormMain::createConnections() {
   connect(m_ui->m_actionTabsCloseAll, &QAction::triggered, m_ui->m_tabWidget, &TabWidget::closeAllTabs);
   connect(m_ui->m_actionTabNewWebBrowser, &QAction::triggered, m_ui->m_tabWidget, &TabWidget::addEmptyBrowser);
   connect(tabWidget()->feedMessageViewer()->feedsView(), &FeedsView::itemSelected, this, &FormMain::updateFeedButtonsAvailability);
-  connect(qApp->feedUpdateLock(), &Mutex::locked, this, &FormMain::updateFeedButtonsAvailability);
-  connect(qApp->feedUpdateLock(), &Mutex::unlocked, this, &FormMain::updateFeedButtonsAvailability);
+  connect(qApp->feedUpdateLock(), &UpdateLock::lockChanged, this, &FormMain::updateFeedButtonsAvailability);
   connect(tabWidget()->feedMessageViewer()->messagesView(), &MessagesView::currentMessageRemoved,
           this, &FormMain::updateMessageButtonsAvailability);
   connect(tabWidget()->feedMessageViewer()->messagesView(), &MessagesView::currentMessageChanged,
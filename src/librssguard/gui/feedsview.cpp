@@ -10,8 +10,8 @@
 #include "gui/styleditemdelegatewithoutfocus.h"
 #include "gui/systemtrayicon.h"
 #include "miscellaneous/feedreader.h"
-#include "miscellaneous/mutex.h"
 #include "miscellaneous/systemfactory.h"
+#include "miscellaneous/updatelock.h"
 #include "services/abstract/feed.h"
 #include "services/abstract/rootitem.h"
 #include "services/abstract/serviceroot.h"
@@ -201,12 +201,14 @@ void FeedsView::clearAllFeeds() {
 }
 
 void FeedsView::editSelectedItem() {
-  if (!qApp->feedUpdateLock()->tryLock()) {
+  const ServiceRoot* account = selectedItem()->getParentServiceRoot();
+
+  if (!qApp->feedUpdateLock()->tryLockAccount(account)) {
     // Lock was not obtained because
-    // it is used probably by feed updater or application
+    // account is probably being updated or application
     // is quitting.
     qApp->showGuiMessage(tr("Cannot edit item"),
-                         tr("Selected item cannot be edited because another critical operation is ongoing."),
+                         tr("Selected item cannot be edited because its account is being updated or edited."),
                          QSystemTrayIcon::Warning, qApp->mainFormWidget(), true);
 
     // Thus, cannot delete and quit the method.
@@ -224,31 +226,30 @@ void FeedsView::editSelectedItem() {
                          true);
   }
 
-  // Changes are done, unlock the update master lock.
-  qApp->feedUpdateLock()->unlock();
+  // Changes are done, unlock the account.
+  qApp->feedUpdateLock()->unlockAccount(account);
 }
 
 void FeedsView::deleteSelectedItem() {
-  if (!qApp->feedUpdateLock()->tryLock()) {
+  if (!currentIndex().isValid()) {
+    return;
+  }
+
+  RootItem* selected_item = selectedItem();
+  const ServiceRoot* account = selected_item != nullptr ? selected_item->getParentServiceRoot() : nullptr;
+
+  if (!qApp->feedUpdateLock()->tryLockAccount(account)) {
     // Lock was not obtained because
-    // it is used probably by feed updater or application
+    // account is probably being updated or application
     // is quitting.
     qApp->showGuiMessage(tr("Cannot delete item"),
-                         tr("Selected item cannot be deleted because another critical operation is ongoing."),
+                         tr("Selected item cannot be deleted because its account is being updated or edited."),
                          QSystemTrayIcon::Warning, qApp->mainFormWidget(), true);
 
     // Thus, cannot delete and quit the method.
     return;
   }
 
-  if (!currentIndex().isValid()) {
-    // Changes are done, unlock the update master lock and exit.
-    qApp->feedUpdateLock()->unlock();
-    return;
-  }
-
-  RootItem* selected_item = selectedItem();
-
   if (selected_item != nullptr) {
     if (selected_item->canBeDeleted()) {
       // Ask user first.
@@ -259,7 +260,7 @@ void FeedsView::deleteSelectedItem() {
                            tr("Are you sure?"),
                            QString(), QMessageBox::Yes | QMessageBox::No, QMessageBox::Yes) == QMessageBox::No) {
         // User refused.
-        qApp->feedUpdateLock()->unlock();
+        qApp->feedUpdateLock()->unlockAccount(account);
         return;
       }
 
@@ -281,8 +282,8 @@ void FeedsView::deleteSelectedItem() {
     }
   }
 
-  // Changes are done, unlock the update master lock.
-  qApp->feedUpdateLock()->unlock();
+  // Changes are done, unlock the account.
+  qApp->feedUpdateLock()->unlockAccount(account);
 }
 
 void FeedsView::markSelectedItemReadStatus(RootItem::ReadStatus read) {
@@ -36,9 +36,13 @@
 #include <QScrollBar>
 #include <QTimer>
 
-MessagesView::MessagesView(QWidget* parent) : QTreeView(parent), m_contextMenu(nullptr), m_columnsAdjusted(false) {
+MessagesView::MessagesView(QWidget* parent)
+  : QTreeView(parent), m_contextMenu(nullptr), m_columnsAdjusted(false), m_searchTimer(new QTimer(this)) {
   m_sourceModel = qApp->feedReader()->messagesModel();
   m_proxyModel = qApp->feedReader()->messagesProxyModel();
+  m_searchTimer->setSingleShot(true);
+  m_searchTimer->setInterval(MESSAGES_SEARCH_DELAY);
+  connect(m_searchTimer, &QTimer::timeout, this, &MessagesView::performSearch);
 
   // Forward count changes to the view.
   createConnections();
@@ -98,7 +102,7 @@ void MessagesView::reloadSelections() {
   const QDateTime dt1 = QDateTime::currentDateTime();
   QModelIndex current_index = selectionModel()->currentIndex();
   const QModelIndex mapped_current_index = m_proxyModel->mapToSource(current_index);
-  const Message selected_message = m_sourceModel->messageAt(mapped_current_index.row());
+  const int selected_message_id = m_sourceModel->messageId(mapped_current_index.row());
   const int col = header()->sortIndicatorSection();
   const Qt::SortOrder ord = header()->sortIndicatorOrder();
 
@@ -106,25 +110,12 @@ void MessagesView::reloadSelections() {
   sort(col, ord, true, false, false);
 
   // Now, we must find the same previously focused message.
-  if (selected_message.m_id > 0) {
-    if (m_proxyModel->rowCount() == 0) {
-      current_index = QModelIndex();
-    }
-    else {
-      for (int i = 0; i < m_proxyModel->rowCount(); i++) {
-        QModelIndex msg_idx = m_proxyModel->index(i, MSG_DB_TITLE_INDEX);
-        Message msg = m_sourceModel->messageAt(m_proxyModel->mapToSource(msg_idx).row());
-
-        if (msg.m_id == selected_message.m_id) {
-          current_index = msg_idx;
-          break;
-        }
+  if (selected_message_id > 0) {
+    const int row = m_sourceModel->messageRow(selected_message_id);
 
-        if (i == m_proxyModel->rowCount() - 1) {
-          current_index = QModelIndex();
-        }
-      }
-    }
+    current_index = row >= 0 ?
+                    m_proxyModel->mapFromSource(m_sourceModel->index(row, MSG_DB_TITLE_INDEX)) :
+                    QModelIndex();
   }
 
   if (current_index.isValid()) {
@@ -518,7 +509,12 @@ void MessagesView::selectNextUnreadItem() {
 }
 
 void MessagesView::searchMessages(const QString& pattern) {
-  m_proxyModel->setFilterRegExp(pattern);
+  m_searchPattern = pattern;
+  m_searchTimer->start();
+}
+
+void MessagesView::performSearch() {
+  m_sourceModel->searchMessages(m_searchPattern);
 
   if (selectionModel()->selectedRows().size() == 0) {
     emit currentMessageRemoved();
@@ -584,8 +580,9 @@ void MessagesView::adjustColumns() {
 }
 
 void MessagesView::onSortIndicatorChanged(int column, Qt::SortOrder order) {
-  // Repopulate the shit.
-  sort(column, order, true, false, false);
+  // Messages are sorted in memory when possible.
+  m_sourceModel->addSortState(column, order);
+  m_sourceModel->resort();
 
   emit currentMessageRemoved();
 }
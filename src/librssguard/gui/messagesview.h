@@ -11,6 +11,7 @@
 #include <QTreeView>
 
 class MessagesProxyModel;
+class QTimer;
 
 class MessagesView : public QTreeView {
   Q_OBJECT
@@ -57,12 +58,13 @@ class MessagesView : public QTreeView {
     void selectPreviousItem();
     void selectNextUnreadItem();
 
-    // Searchs the visible message according to given pattern.
+    // Searchs messages according to given pattern.
     void searchMessages(const QString& pattern);
     void filterMessages(MessagesModel::MessageHighlighter filter);
 
   private slots:
     void openSelectedMessagesWithExternalTool();
+    void performSearch();
 
     // Marks given indexes as selected.
     void reselectIndexes(const QModelIndexList& indexes);
@@ -105,6 +107,10 @@ class MessagesView : public QTreeView {
     MessagesProxyModel* m_proxyModel;
     MessagesModel* m_sourceModel;
     bool m_columnsAdjusted;
+
+    // Search is performed only after user stops typing.
+    QTimer* m_searchTimer;
+    QString m_searchPattern;
 };
 
 #endif // MESSAGESVIEW_H
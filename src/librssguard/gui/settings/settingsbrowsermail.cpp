@@ -225,7 +225,7 @@ void SettingsBrowserMail::saveSettings() {
   ExternalTool::setToolsToSettings(tools);
 
   // Reload settings for all network access managers.
-  SilentNetworkAccessManager::instance()->loadSettings();
+  SilentNetworkAccessManager::loadSettingsOfSharedInstances();
   onEndSaveSettings();
 }
 
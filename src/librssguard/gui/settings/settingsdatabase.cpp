@@ -16,10 +16,12 @@ SettingsDatabase::SettingsDatabase(Settings* settings, QWidget* parent)
   connect(m_ui->m_cmbDatabaseDriver, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged), this,
           &SettingsDatabase::dirtifySettings);
   connect(m_ui->m_checkSqliteUseInMemoryDatabase, &QCheckBox::toggled, this, &SettingsDatabase::dirtifySettings);
+  connect(m_ui->m_checkSqliteUseWal, &QCheckBox::toggled, this, &SettingsDatabase::dirtifySettings);
   connect(m_ui->m_txtMysqlDatabase->lineEdit(), &QLineEdit::textChanged, this, &SettingsDatabase::dirtifySettings);
   connect(m_ui->m_txtMysqlHostname->lineEdit(), &QLineEdit::textChanged, this, &SettingsDatabase::dirtifySettings);
   connect(m_ui->m_txtMysqlPassword->lineEdit(), &QLineEdit::textChanged, this, &SettingsDatabase::dirtifySettings);
   connect(m_ui->m_checkUseTransactions, &QCheckBox::toggled, this, &SettingsDatabase::dirtifySettings);
+  connect(m_ui->m_checkCompressContents, &QCheckBox::toggled, this, &SettingsDatabase::dirtifySettings);
   connect(m_ui->m_txtMysqlUsername->lineEdit(), &QLineEdit::textChanged, this, &SettingsDatabase::dirtifySettings);
   connect(m_ui->m_spinMysqlPort, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged), this, &SettingsDatabase::dirtifySettings);
   connect(m_ui->m_cmbDatabaseDriver, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged), this,
@@ -33,6 +35,7 @@ SettingsDatabase::SettingsDatabase(Settings* settings, QWidget* parent)
   connect(m_ui->m_cmbDatabaseDriver, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged), this,
           &SettingsDatabase::requireRestart);
   connect(m_ui->m_checkSqliteUseInMemoryDatabase, &QCheckBox::toggled, this, &SettingsDatabase::requireRestart);
+  connect(m_ui->m_checkSqliteUseWal, &QCheckBox::toggled, this, &SettingsDatabase::requireRestart);
   connect(m_ui->m_spinMysqlPort, &QSpinBox::editingFinished, this, &SettingsDatabase::requireRestart);
   connect(m_ui->m_txtMysqlHostname->lineEdit(), &BaseLineEdit::textEdited, this, &SettingsDatabase::requireRestart);
   connect(m_ui->m_txtMysqlPassword->lineEdit(), &BaseLineEdit::textEdited, this, &SettingsDatabase::requireRestart);
@@ -120,6 +123,7 @@ void SettingsDatabase::switchMysqlPasswordVisiblity(bool visible) {
 void SettingsDatabase::loadSettings() {
   onBeginLoadSettings();
   m_ui->m_checkUseTransactions->setChecked(qApp->settings()->value(GROUP(Database), SETTING(Database::UseTransactions)).toBool());
+  m_ui->m_checkCompressContents->setChecked(qApp->settings()->value(GROUP(Database), SETTING(Database::CompressContents)).toBool());
   m_ui->m_lblMysqlTestResult->setStatus(WidgetWithStatus::Information, tr("No connection test triggered so far."),
                                         tr("You did not executed any connection test yet."));
 
@@ -129,6 +133,14 @@ void SettingsDatabase::loadSettings() {
   // Load in-memory database status.
   m_ui->m_checkSqliteUseInMemoryDatabase->setChecked(settings()->value(GROUP(Database), SETTING(Database::UseInMemory)).toBool());
 
+  // Load write-ahead log status.
+  const qint64 wal_size = qApp->database()->getDatabaseWalSize();
+
+  m_ui->m_checkSqliteUseWal->setChecked(settings()->value(GROUP(Database), SETTING(Database::UseWal)).toBool());
+  m_ui->m_lblSqliteWalSize->setText(tr("Size of write-ahead log: %1").arg(wal_size > 0 ?
+                                                                          QString::number(wal_size / 1000000.0) + QL1S(" MB") :
+                                                                          tr("empty")));
+
   if (QSqlDatabase::isDriverAvailable(APP_DB_MYSQL_DRIVER)) {
     onMysqlHostnameChanged(QString());
     onMysqlUsernameChanged(QString());
@@ -170,6 +182,8 @@ void SettingsDatabase::saveSettings() {
   const bool new_inmemory = m_ui->m_checkSqliteUseInMemoryDatabase->isChecked();
 
   qApp->settings()->setValue(GROUP(Database), Database::UseTransactions, m_ui->m_checkUseTransactions->isChecked());
+  qApp->settings()->setValue(GROUP(Database), Database::CompressContents, m_ui->m_checkCompressContents->isChecked());
+  qApp->database()->setContentsCompressionEnabled(m_ui->m_checkCompressContents->isChecked());
 
   // Save data storage settings.
   QString original_db_driver = settings()->value(GROUP(Database), SETTING(Database::ActiveDriver)).toString();
@@ -177,6 +191,7 @@ void SettingsDatabase::saveSettings() {
 
   // Save SQLite.
   settings()->setValue(GROUP(Database), Database::UseInMemory, new_inmemory);
+  settings()->setValue(GROUP(Database), Database::UseWal, m_ui->m_checkSqliteUseWal->isChecked());
 
   if (QSqlDatabase::isDriverAvailable(APP_DB_MYSQL_DRIVER)) {
     // Save MySQL.
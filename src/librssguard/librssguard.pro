@@ -32,9 +32,11 @@ RESOURCES += ../../resources/sql.qrc \
 HEADERS += core/feeddownloader.h \
            core/feedsmodel.h \
            core/feedsproxymodel.h \
+           core/feedupdatescheduler.h \
            core/message.h \
            core/messagesmodel.h \
            core/messagesmodelcache.h \
+           core/messagesmodelstore.h \
            core/messagesmodelsqllayer.h \
            core/messagesproxymodel.h \
            definitions/definitions.h \
@@ -107,6 +109,7 @@ HEADERS += core/feeddownloader.h \
            miscellaneous/skinfactory.h \
            miscellaneous/systemfactory.h \
            miscellaneous/textfactory.h \
+           miscellaneous/updatelock.h \
            network-web/basenetworkaccessmanager.h \
            network-web/downloader.h \
            network-web/downloadmanager.h \
@@ -174,9 +177,11 @@ HEADERS += core/feeddownloader.h \
 SOURCES += core/feeddownloader.cpp \
            core/feedsmodel.cpp \
            core/feedsproxymodel.cpp \
+           core/feedupdatescheduler.cpp \
            core/message.cpp \
            core/messagesmodel.cpp \
            core/messagesmodelcache.cpp \
+           core/messagesmodelstore.cpp \
            core/messagesmodelsqllayer.cpp \
            core/messagesproxymodel.cpp \
            dynamic-shortcuts/dynamicshortcuts.cpp \
@@ -247,6 +252,7 @@ SOURCES += core/feeddownloader.cpp \
            miscellaneous/skinfactory.cpp \
            miscellaneous/systemfactory.cpp \
            miscellaneous/textfactory.cpp \
+           miscellaneous/updatelock.cpp \
            network-web/basenetworkaccessmanager.cpp \
            network-web/downloader.cpp \
            network-web/downloadmanager.cpp \
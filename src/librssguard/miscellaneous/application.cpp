@@ -13,7 +13,7 @@
 #include "miscellaneous/feedreader.h"
 #include "miscellaneous/iconfactory.h"
 #include "miscellaneous/iofactory.h"
-#include "miscellaneous/mutex.h"
+#include "miscellaneous/updatelock.h"
 #include "network-web/webfactory.h"
 #include "services/abstract/serviceroot.h"
 #include "services/owncloud/owncloudserviceentrypoint.h"
@@ -45,7 +45,7 @@ Application::Application(const QString& id, int& argc, char** argv)
 #endif
 
   m_feedReader(nullptr),
-  m_updateFeedsLock(new Mutex()), m_mainForm(nullptr),
+  m_updateFeedsLock(new UpdateLock()), m_mainForm(nullptr),
   m_trayIcon(nullptr), m_settings(Settings::setupSettings(this)), m_webFactory(new WebFactory(this)),
   m_system(new SystemFactory(this)), m_skins(new SkinFactory(this)),
   m_localization(new Localization(this)), m_icons(new IconFactory(this)),
@@ -198,7 +198,7 @@ Settings* Application::settings() const {
   return m_settings;
 }
 
-Mutex* Application::feedUpdateLock() {
+UpdateLock* Application::feedUpdateLock() {
   return m_updateFeedsLock.data();
 }
 
@@ -411,7 +411,7 @@ void Application::onAboutToQuit() {
 #endif
 
   // Make sure that we obtain close lock BEFORE even trying to quit the application.
-  const bool locked_safely = feedUpdateLock()->tryLock(4 * CLOSE_LOCK_TIMEOUT);
+  const bool locked_safely = feedUpdateLock()->tryLockAll(4 * CLOSE_LOCK_TIMEOUT);
 
   processEvents();
   qDebug("Cleaning up resources and saving application state.");
@@ -432,7 +432,7 @@ void Application::onAboutToQuit() {
     qDebug("Close lock was obtained safely.");
 
     // We locked the lock to exit peacefully, unlock it to avoid warnings.
-    feedUpdateLock()->unlock();
+    feedUpdateLock()->unlockAll();
   }
   else {
     // Request for write lock timed-out. This means
@@ -31,7 +31,7 @@
 class FormMain;
 class IconFactory;
 class QAction;
-class Mutex;
+class UpdateLock;
 class QWebEngineDownloadItem;
 class WebFactory;
 
@@ -74,7 +74,7 @@ class RSSGUARD_DLLSPEC Application : public QtSingleApplication {
     IconFactory* icons();
     DownloadManager* downloadManager();
     Settings* settings() const;
-    Mutex* feedUpdateLock();
+    UpdateLock* feedUpdateLock();
     FormMain* mainForm();
     QWidget* mainFormWidget();
     SystemTrayIcon* trayIcon();
@@ -158,12 +158,11 @@ class RSSGUARD_DLLSPEC Application : public QtSingleApplication {
     // for reading and won't be executed, so no critical action
     // will be running when application quits
     //
-    // EACH critical action locks this lock for READING.
-    // Several actions can lock this lock for reading.
-    // But of user decides to close the application (in other words,
-    // tries to lock the lock for writing), then no other
-    // action will be allowed to lock for reading.
-    QScopedPointer<Mutex> m_updateFeedsLock;
+    // Feed updates lock only their feeds and edits lock only their accounts.
+    // But if user decides to close the application (in other words,
+    // tries to lock everything), then no other
+    // action will be allowed to lock anything.
+    QScopedPointer<UpdateLock> m_updateFeedsLock;
 
     QList<QAction*> m_userActions;
     FormMain* m_mainForm;
@@ -54,6 +54,10 @@ void DatabaseCleaner::purgeDatabaseData(const CleanerOrders& which_data) {
     progress += difference;
     emit purgeProgress(progress, tr("Shrinking database file..."));
 
+    // Message counters are verified only here, because
+    // it needs to aggregate all messages.
+    result &= DatabaseQueries::checkFeedCounters(database);
+
     // Call driver-specific vacuuming function.
     result &= qApp->database()->vacuumDatabase();
     progress += difference;
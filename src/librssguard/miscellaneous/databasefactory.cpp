@@ -4,22 +4,76 @@
 
 #include "gui/messagebox.h"
 #include "miscellaneous/application.h"
+#include "miscellaneous/databasequeries.h"
 #include "miscellaneous/iofactory.h"
 #include "miscellaneous/textfactory.h"
 
 #include <QDir>
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <QSet>
 #include <QSqlError>
 #include <QSqlQuery>
+#include <QThread>
+#include <QTimer>
 #include <QVariant>
 
+PreparedQuery::PreparedQuery(DatabaseFactory* factory, QSqlQuery* query, const QString& cache_key, const QString& statement)
+  : m_factory(factory), m_query(query), m_cacheKey(cache_key), m_statement(statement) {}
+
+PreparedQuery::PreparedQuery(PreparedQuery&& other) noexcept
+  : m_factory(other.m_factory), m_query(other.m_query), m_cacheKey(other.m_cacheKey), m_statement(other.m_statement) {
+  other.m_query = nullptr;
+}
+
+PreparedQuery::~PreparedQuery() {
+  if (m_query != nullptr) {
+    m_factory->releasePreparedQuery(m_query, m_cacheKey, m_statement);
+  }
+}
+
+QSqlQuery& PreparedQuery::operator*() const {
+  return *m_query;
+}
+
+QSqlQuery* PreparedQuery::operator->() const {
+  return m_query;
+}
+
 DatabaseFactory::DatabaseFactory(QObject* parent)
   : QObject(parent),
+  m_preparedQueryHits(0),
+  m_preparedQueryMisses(0),
   m_activeDatabaseDriver(UsedDriver::SQLITE),
+  m_searchIndexAvailable(false),
+  m_contentsCompressionEnabled(false),
+  m_lastCompressedMessageId(0),
+  m_contentsCompressionTimer(new QTimer(this)),
   m_mysqlDatabaseInitialized(false),
   m_sqliteFileBasedDatabaseinitialized(false),
-  m_sqliteInMemoryDatabaseInitialized(false) {
+  m_sqliteInMemoryDatabaseInitialized(false),
+  m_sqliteWalEnabled(false),
+  m_sqliteWalCheckpointTimer(new QTimer(this)) {
   setObjectName(QSL("DatabaseFactory"));
   determineDriver();
+
+  // Write-ahead log is copied into database file regularly,
+  // so that it does not grow too much.
+  if (m_sqliteWalEnabled) {
+    m_sqliteWalCheckpointTimer->setInterval(APP_DB_SQLITE_WAL_CHECKPOINT);
+    connect(m_sqliteWalCheckpointTimer, &QTimer::timeout, this, [this]() {
+      sqliteCheckpointWal(false);
+    });
+    m_sqliteWalCheckpointTimer->start();
+  }
+
+  m_contentsCompressionTimer->setInterval(APP_DB_COMPRESSION_INTERVAL);
+  connect(m_contentsCompressionTimer, &QTimer::timeout, this, &DatabaseFactory::compressMessagesContents);
+  setContentsCompressionEnabled(qApp->settings()->value(GROUP(Database), SETTING(Database::CompressContents)).toBool());
+}
+
+DatabaseFactory::~DatabaseFactory() {
+  qDeleteAll(m_preparedQueries);
 }
 
 qint64 DatabaseFactory::getDatabaseFileSize() const {
@@ -31,6 +85,15 @@ qint64 DatabaseFactory::getDatabaseFileSize() const {
   }
 }
 
+qint64 DatabaseFactory::getDatabaseWalSize() const {
+  if (m_activeDatabaseDriver == UsedDriver::SQLITE || m_activeDatabaseDriver == UsedDriver::SQLITE_MEMORY) {
+    return QFileInfo(sqliteDatabaseFilePath() + QSL(APP_DB_SQLITE_WAL_SUFFIX)).size();
+  }
+  else {
+    return 0;
+  }
+}
+
 qint64 DatabaseFactory::getDatabaseDataSize() const {
   if (m_activeDatabaseDriver == UsedDriver::SQLITE || m_activeDatabaseDriver == UsedDriver::SQLITE_MEMORY) {
     QSqlDatabase database = qApp->database()->connection(metaObject()->className(), DesiredType::FromSettings);
@@ -229,6 +292,9 @@ QSqlDatabase DatabaseFactory::sqliteInitializeInMemoryDatabase() {
       qDebug("In-memory SQLite database has version '%s'.", qPrintable(query_db.value(0).toString()));
     }
 
+    // Search index is filled by triggers when messages are copied.
+    m_searchIndexAvailable = sqliteCheckSearchIndex(database);
+
     // Loading messages from file-based database.
     QSqlDatabase file_database = sqliteConnection(objectName(), DesiredType::StrictlyFileBased);
     QSqlQuery copy_contents(database);
@@ -239,7 +305,8 @@ QSqlDatabase DatabaseFactory::sqliteInitializeInMemoryDatabase() {
     // Copy all stuff.
     QStringList tables;
 
-    if (copy_contents.exec(QSL("SELECT name FROM storage.sqlite_master WHERE type='table';"))) {
+    // NOTE: Tables of search index are maintained by triggers, they are not copied.
+    if (copy_contents.exec(QSL("SELECT name FROM storage.sqlite_master WHERE type='table' AND name NOT LIKE 'MessagesSearch%';"))) {
       while (copy_contents.next()) {
         tables.append(copy_contents.value(0).toString());
       }
@@ -248,16 +315,25 @@ QSqlDatabase DatabaseFactory::sqliteInitializeInMemoryDatabase() {
       qFatal("Cannot obtain list of table names from file-base SQLite database.");
     }
 
+    // Message counters are filled by triggers when messages are copied.
+    tables.removeAll(QSL("FeedCounters"));
+
+    database.transaction();
+
     foreach (const QString& table, tables) {
       copy_contents.exec(QString("INSERT INTO main.%1 SELECT * FROM storage.%1;").arg(table));
     }
 
+    database.commit();
     qDebug("Copying data from file-based database into working in-memory database.");
 
     // Detach database and finish.
     copy_contents.exec(QSL("DETACH 'storage'"));
     copy_contents.finish();
     query_db.finish();
+
+    // Changes are tracked only after data are loaded, file-based database has them.
+    sqliteTrackMemoryDatabaseChanges(database);
   }
 
   // Everything is initialized now.
@@ -298,8 +374,18 @@ QSqlDatabase DatabaseFactory::sqliteInitializeFileBasedDatabase(const QString& c
 
     query_db.setForwardOnly(true);
     query_db.exec(QSL("PRAGMA encoding = \"UTF-8\""));
-    query_db.exec(QSL("PRAGMA synchronous = OFF"));
-    query_db.exec(QSL("PRAGMA journal_mode = MEMORY"));
+
+    if (m_sqliteWalEnabled) {
+      // NOTE: With write-ahead log, readers are not blocked by other connections which
+      // write and commits survive crashes even when they are not synced one by one.
+      query_db.exec(QSL("PRAGMA journal_mode = WAL"));
+      query_db.exec(QSL("PRAGMA synchronous = NORMAL"));
+    }
+    else {
+      query_db.exec(QSL("PRAGMA synchronous = OFF"));
+      query_db.exec(QSL("PRAGMA journal_mode = MEMORY"));
+    }
+
     query_db.exec(QSL("PRAGMA page_size = 4096"));
     query_db.exec(QSL("PRAGMA cache_size = 16384"));
     query_db.exec(QSL("PRAGMA count_changes = OFF"));
@@ -358,6 +444,9 @@ QSqlDatabase DatabaseFactory::sqliteInitializeFileBasedDatabase(const QString& c
              qPrintable(QDir::toNativeSeparators(database.databaseName())));
       qDebug("File-based SQLite database has version '%s'.", qPrintable(installed_db_schema));
     }
+
+    sqliteCheckIndexes(database);
+    m_searchIndexAvailable = sqliteCheckSearchIndex(database);
   }
 
   // Everything is initialized now.
@@ -365,6 +454,113 @@ QSqlDatabase DatabaseFactory::sqliteInitializeFileBasedDatabase(const QString& c
   return database;
 }
 
+void DatabaseFactory::sqliteCheckIndexes(const QSqlDatabase& database) {
+  const QList<QPair<QString, QString>> required_indexes = {
+    { QSL("idx_messages_feed"),
+      QSL("CREATE INDEX IF NOT EXISTS idx_messages_feed ON Messages (account_id, feed, is_deleted, is_pdeleted, is_read);") },
+    { QSL("idx_messages_custom_id"),
+      QSL("CREATE INDEX IF NOT EXISTS idx_messages_custom_id ON Messages (account_id, custom_id);") },
+    { QSL("idx_feeds_custom_id"),
+      QSL("CREATE INDEX IF NOT EXISTS idx_feeds_custom_id ON Feeds (account_id, custom_id);") },
+    { QSL("idx_messages_identity_hash"),
+      QSL("CREATE INDEX IF NOT EXISTS idx_messages_identity_hash ON Messages (account_id, feed, identity_hash);") }
+  };
+  QSqlQuery query(database);
+  QSet<QString> existing_indexes;
+
+  query.setForwardOnly(true);
+
+  if (!query.exec(QSL("SELECT name FROM sqlite_master WHERE type = 'index';"))) {
+    qWarning("Cannot obtain list of indexes from SQLite database: '%s'.", qPrintable(query.lastError().text()));
+    return;
+  }
+
+  while (query.next()) {
+    existing_indexes.insert(query.value(0).toString());
+  }
+
+  for (const QPair<QString, QString>& index : required_indexes) {
+    if (!existing_indexes.contains(index.first)) {
+      qWarning("SQLite database is missing index '%s'. Creating it now.", qPrintable(index.first));
+
+      if (!query.exec(index.second)) {
+        qCritical("SQLite index '%s' was not created: '%s'.", qPrintable(index.first), qPrintable(query.lastError().text()));
+      }
+    }
+  }
+}
+
+bool DatabaseFactory::sqliteCheckSearchIndex(const QSqlDatabase& database) {
+  const QStringList triggers = {
+    QSL("trg_messages_search_insert"), QSL("trg_messages_search_delete"), QSL("trg_messages_search_update")
+  };
+  QSqlQuery query(database);
+
+  query.setForwardOnly(true);
+
+  if (!query.exec(QSL("CREATE VIRTUAL TABLE IF NOT EXISTS temp.MessagesSearchProbe USING fts5(probe);"))) {
+    qWarning("SQLite does not support FTS5, messages will be searched without index: '%s'.", qPrintable(query.lastError().text()));
+
+    foreach (const QString& trigger, triggers) {
+      query.exec(QString(QSL("DROP TRIGGER IF EXISTS %1;")).arg(trigger));
+    }
+
+    return false;
+  }
+
+  query.exec(QSL("DROP TABLE temp.MessagesSearchProbe;"));
+
+  QSet<QString> existing_objects;
+
+  if (query.exec(QSL("SELECT name FROM sqlite_master WHERE type IN ('table', 'trigger');"))) {
+    while (query.next()) {
+      existing_objects.insert(query.value(0).toString());
+    }
+  }
+
+  if (existing_objects.contains(QSL("MessagesSearch")) && existing_objects.contains(triggers.toSet())) {
+    return true;
+  }
+
+  qWarning("SQLite database is missing search index of messages. Creating it now.");
+
+  const QStringList statements = {
+    QSL("CREATE VIRTUAL TABLE IF NOT EXISTS MessagesSearch USING fts5(title, author, contents, "
+        "content = 'Messages', content_rowid = 'id', prefix = '2 3');"),
+    QSL("CREATE TRIGGER IF NOT EXISTS trg_messages_search_insert AFTER INSERT ON Messages "
+        "BEGIN "
+        "  INSERT INTO MessagesSearch (rowid, title, author, contents) VALUES (NEW.id, NEW.title, NEW.author, NEW.contents); "
+        "END;"),
+    QSL("CREATE TRIGGER IF NOT EXISTS trg_messages_search_delete AFTER DELETE ON Messages "
+        "BEGIN "
+        "  INSERT INTO MessagesSearch (MessagesSearch, rowid, title, author, contents) "
+        "    VALUES ('delete', OLD.id, OLD.title, OLD.author, OLD.contents); "
+        "END;"),
+    QSL("CREATE TRIGGER IF NOT EXISTS trg_messages_search_update AFTER UPDATE OF title, author, contents ON Messages "
+        "WHEN OLD.title IS NOT NEW.title OR OLD.author IS NOT NEW.author OR OLD.contents IS NOT NEW.contents "
+        "BEGIN "
+        "  INSERT INTO MessagesSearch (MessagesSearch, rowid, title, author, contents) "
+        "    VALUES ('delete', OLD.id, OLD.title, OLD.author, OLD.contents); "
+        "  INSERT INTO MessagesSearch (rowid, title, author, contents) VALUES (NEW.id, NEW.title, NEW.author, NEW.contents); "
+        "END;"),
+    QSL("INSERT INTO MessagesSearch (MessagesSearch) VALUES ('rebuild');")
+  };
+  QSqlDatabase db = database;
+
+  db.transaction();
+
+  foreach (const QString& statement, statements) {
+    if (!query.exec(statement)) {
+      qCritical("SQLite search index was not created: '%s'.", qPrintable(query.lastError().text()));
+      db.rollback();
+      return false;
+    }
+  }
+
+  db.commit();
+  return true;
+}
+
 QString DatabaseFactory::sqliteDatabaseFilePath() const {
   return m_sqliteDatabaseFilePath + QDir::separator() + APP_DB_SQLITE_FILE;
 }
@@ -458,15 +654,109 @@ bool DatabaseFactory::mysqlUpdateDatabaseSchema(const QSqlDatabase& database,
 QSqlDatabase DatabaseFactory::connection(const QString& connection_name, DesiredType desired_type) {
   switch (m_activeDatabaseDriver) {
     case UsedDriver::MYSQL:
-      return mysqlConnection(connection_name);
+      return mysqlConnection(threadConnectionName(connection_name));
 
     case UsedDriver::SQLITE:
     case UsedDriver::SQLITE_MEMORY:
-    default:
-      return sqliteConnection(connection_name, desired_type);
+    default: {
+      // NOTE: There is only one connection to in-memory database.
+      const bool in_memory = desired_type == DesiredType::StrictlyInMemory ||
+                             (desired_type == DesiredType::FromSettings && m_activeDatabaseDriver == UsedDriver::SQLITE_MEMORY);
+
+      return sqliteConnection(in_memory ? connection_name : threadConnectionName(connection_name), desired_type);
+    }
   }
 }
 
+QString DatabaseFactory::threadConnectionName(const QString& connection_name) {
+  QThread* thread = QThread::currentThread();
+
+  if (thread == qApp->thread()) {
+    return connection_name;
+  }
+
+  const QString thread_connection_name = QString(QSL("%1_%2")).arg(connection_name,
+                                                                   QString::number(quintptr(QThread::currentThreadId())));
+  QMutexLocker locker(&m_connectionsMutex);
+
+  if (!m_threadConnections.contains(thread_connection_name)) {
+    m_threadConnections.insert(thread_connection_name);
+
+    // Threads of thread pools come and go, their connections
+    // are removed when they finish.
+    connect(thread, &QThread::finished, this, [this, thread_connection_name]() {
+      removeConnection(thread_connection_name);
+    }, Qt::DirectConnection);
+  }
+
+  return thread_connection_name;
+}
+
+PreparedQuery DatabaseFactory::preparedQuery(const QSqlDatabase& database, const QString& statement) {
+  QMutexLocker locker(&m_connectionsMutex);
+  const QString key = preparedQueriesKey(database.connectionName());
+  QCache<QString, QSqlQuery>*& queries = m_preparedQueries[key];
+
+  if (queries == nullptr) {
+    queries = new QCache<QString, QSqlQuery>(APP_DB_PREPARED_QUERIES);
+  }
+
+  // Query is taken out of the cache while it is used, so that
+  // it is not evicted or handed out to nested callers.
+  QSqlQuery* query = queries->take(statement);
+
+  if (query != nullptr) {
+    m_preparedQueryHits++;
+    return PreparedQuery(this, query, key, statement);
+  }
+
+  m_preparedQueryMisses++;
+  query = new QSqlQuery(database);
+  query->setForwardOnly(true);
+
+  if (query->prepare(statement)) {
+    return PreparedQuery(this, query, key, statement);
+  }
+  else {
+    // Query which cannot be prepared is not cached.
+    qWarning("Query preparation failed: '%s'.", qPrintable(query->lastError().text()));
+    return PreparedQuery(this, query, QString(), statement);
+  }
+}
+
+void DatabaseFactory::releasePreparedQuery(QSqlQuery* query, const QString& cache_key, const QString& statement) {
+  // Statement is reset, so that it does not hold any locks until it is used again.
+  query->finish();
+
+  QMutexLocker locker(&m_connectionsMutex);
+  QCache<QString, QSqlQuery>* queries = cache_key.isEmpty() ? nullptr : m_preparedQueries.value(cache_key);
+
+  if (queries != nullptr) {
+    queries->insert(statement, query);
+  }
+  else {
+    delete query;
+  }
+}
+
+qint64 DatabaseFactory::preparedQueryHits() const {
+  QMutexLocker locker(&m_connectionsMutex);
+
+  return m_preparedQueryHits;
+}
+
+qint64 DatabaseFactory::preparedQueryMisses() const {
+  QMutexLocker locker(&m_connectionsMutex);
+
+  return m_preparedQueryMisses;
+}
+
+QString DatabaseFactory::preparedQueriesKey(const QString& connection_name) const {
+  // NOTE: Connection to in-memory database is shared by all threads,
+  // so prepared queries are kept separately for each thread.
+  return QString(QSL("%1/%2")).arg(connection_name, QString::number(quintptr(QThread::currentThreadId())));
+}
+
 QString DatabaseFactory::humanDriverName(DatabaseFactory::UsedDriver driver) const {
   switch (driver) {
     case UsedDriver::MYSQL:
@@ -493,6 +783,24 @@ QString DatabaseFactory::humanDriverName(const QString& driver_code) const {
 
 void DatabaseFactory::removeConnection(const QString& connection_name) {
   qDebug("Removing database connection '%s'.", qPrintable(connection_name));
+
+  {
+    // Prepared queries must be destroyed before their connection.
+    QMutexLocker locker(&m_connectionsMutex);
+
+    for (auto i = m_preparedQueries.begin(); i != m_preparedQueries.end();) {
+      if (i.key().startsWith(connection_name + QL1C('/'))) {
+        delete i.value();
+        i = m_preparedQueries.erase(i);
+      }
+      else {
+        i++;
+      }
+    }
+
+    m_threadConnections.remove(connection_name);
+  }
+
   QSqlDatabase::removeDatabase(connection_name);
 }
 
@@ -510,25 +818,71 @@ void DatabaseFactory::sqliteSaveMemoryDatabase() {
   QSqlDatabase database = sqliteConnection(objectName(), DesiredType::StrictlyInMemory);
   QSqlDatabase file_database = sqliteConnection(objectName(), DesiredType::StrictlyFileBased);
   QSqlQuery copy_contents(database);
+  QElapsedTimer tmr;
 
-  // Attach database.
-  copy_contents.exec(QString(QSL("ATTACH DATABASE '%1' AS 'storage';")).arg(file_database.databaseName()));
+  tmr.start();
+  copy_contents.setForwardOnly(true);
 
-  // Copy all stuff.
+  // Find out what was changed.
   QStringList tables;
+  int messages = 0;
 
-  if (copy_contents.exec(QSL("SELECT name FROM storage.sqlite_master WHERE type='table';"))) {
+  if (copy_contents.exec(QSL("SELECT name FROM temp.ChangedTables;"))) {
     while (copy_contents.next()) {
       tables.append(copy_contents.value(0).toString());
     }
   }
-  else {
-    qFatal("Cannot obtain list of table names from file-base SQLite database.");
+
+  if (copy_contents.exec(QSL("SELECT count(*) FROM temp.ChangedMessages;")) && copy_contents.next()) {
+    messages = copy_contents.value(0).toInt();
+  }
+
+  if (copy_contents.lastError().isValid()) {
+    qCritical("Cannot obtain list of changes in in-memory SQLite database: '%s'.", qPrintable(copy_contents.lastError().text()));
+    return;
+  }
+  else if (tables.isEmpty() && messages == 0) {
+    qDebug("In-memory database was not changed since it was saved.");
+    return;
+  }
+
+  // Triggers change message counters when messages are copied,
+  // so counters are overwritten only after messages.
+  if (tables.removeAll(QSL("FeedCounters")) > 0) {
+    tables.append(QSL("FeedCounters"));
+  }
+
+  // Attach database.
+  copy_contents.exec(QString(QSL("ATTACH DATABASE '%1' AS 'storage';")).arg(file_database.databaseName()));
+
+  // NOTE: All changes are written in single transaction, so
+  // file-based database is never seen partially saved.
+  bool saved = database.transaction();
+
+  if (messages > 0) {
+    saved = saved &&
+            copy_contents.exec(QSL("DELETE FROM storage.Messages WHERE id IN (SELECT id FROM temp.ChangedMessages);")) &&
+            copy_contents.exec(QSL("INSERT INTO storage.Messages "
+                                   "SELECT * FROM main.Messages WHERE id IN (SELECT id FROM temp.ChangedMessages);"));
   }
 
   foreach (const QString& table, tables) {
-    copy_contents.exec(QString(QSL("DELETE FROM storage.%1;")).arg(table));
-    copy_contents.exec(QString(QSL("INSERT INTO storage.%1 SELECT * FROM main.%1;")).arg(table));
+    saved = saved &&
+            copy_contents.exec(QString(QSL("DELETE FROM storage.%1;")).arg(table)) &&
+            copy_contents.exec(QString(QSL("INSERT INTO storage.%1 SELECT * FROM main.%1;")).arg(table));
+  }
+
+  saved = saved &&
+          copy_contents.exec(QSL("DELETE FROM temp.ChangedTables;")) &&
+          copy_contents.exec(QSL("DELETE FROM temp.ChangedMessages;"));
+
+  if (saved && database.commit()) {
+    qDebug("Saved %d changed tables and %d changed messages of in-memory database in %lld ms.",
+           tables.size(), messages, tmr.elapsed());
+  }
+  else {
+    qCritical("In-memory SQLite database was not saved: '%s'.", qPrintable(copy_contents.lastError().text()));
+    database.rollback();
   }
 
   // Detach database and finish.
@@ -536,6 +890,52 @@ void DatabaseFactory::sqliteSaveMemoryDatabase() {
   copy_contents.finish();
 }
 
+void DatabaseFactory::sqliteTrackMemoryDatabaseChanges(const QSqlDatabase& database) {
+  QSqlQuery query(database);
+  QStringList tables;
+
+  query.setForwardOnly(true);
+
+  if (query.exec(QSL("SELECT name FROM main.sqlite_master "
+                     "WHERE type='table' AND name NOT LIKE 'MessagesSearch%' AND name NOT LIKE 'sqlite_%';"))) {
+    while (query.next()) {
+      tables.append(query.value(0).toString());
+    }
+  }
+
+  // Messages are tracked one by one, other
+  // tables are small and are saved whole.
+  QStringList statements;
+
+  statements << QSL("CREATE TEMP TABLE ChangedTables (name TEXT PRIMARY KEY);")
+             << QSL("CREATE TEMP TABLE ChangedMessages (id INTEGER PRIMARY KEY);")
+             << QSL("CREATE TEMP TRIGGER trg_changes_messages_insert AFTER INSERT ON main.Messages "
+                    "BEGIN INSERT OR IGNORE INTO ChangedMessages (id) VALUES (new.id); END;")
+             << QSL("CREATE TEMP TRIGGER trg_changes_messages_delete AFTER DELETE ON main.Messages "
+                    "BEGIN INSERT OR IGNORE INTO ChangedMessages (id) VALUES (old.id); END;")
+             << QSL("CREATE TEMP TRIGGER trg_changes_messages_update AFTER UPDATE ON main.Messages "
+                    "BEGIN "
+                    "INSERT OR IGNORE INTO ChangedMessages (id) VALUES (old.id); "
+                    "INSERT OR IGNORE INTO ChangedMessages (id) VALUES (new.id); "
+                    "END;");
+
+  tables.removeAll(QSL("Messages"));
+
+  foreach (const QString& table, tables) {
+    for (const QString& operation : { QSL("INSERT"), QSL("DELETE"), QSL("UPDATE") }) {
+      statements << QString(QSL("CREATE TEMP TRIGGER trg_changes_%1_%2 AFTER %3 ON main.%1 "
+                                "BEGIN INSERT OR IGNORE INTO ChangedTables (name) VALUES ('%1'); END;"))
+        .arg(table, operation.toLower(), operation);
+    }
+  }
+
+  foreach (const QString& statement, statements) {
+    if (!query.exec(statement)) {
+      qFatal("Changes of in-memory SQLite database cannot be tracked: '%s'.", qPrintable(query.lastError().text()));
+    }
+  }
+}
+
 void DatabaseFactory::determineDriver() {
   const QString db_driver = qApp->settings()->value(GROUP(Database), SETTING(Database::ActiveDriver)).toString();
 
@@ -555,6 +955,7 @@ void DatabaseFactory::determineDriver() {
     else {
       // Use strictly file-base SQLite database.
       m_activeDatabaseDriver = UsedDriver::SQLITE;
+      m_sqliteWalEnabled = qApp->settings()->value(GROUP(Database), SETTING(Database::UseWal)).toBool();
       qDebug("Working database source was determined as SQLite file-based database.");
     }
 
@@ -566,6 +967,39 @@ DatabaseFactory::UsedDriver DatabaseFactory::activeDatabaseDriver() const {
   return m_activeDatabaseDriver;
 }
 
+bool DatabaseFactory::isSearchIndexAvailable() const {
+  return m_searchIndexAvailable;
+}
+
+bool DatabaseFactory::isContentsCompressionEnabled() const {
+  return m_contentsCompressionEnabled;
+}
+
+void DatabaseFactory::setContentsCompressionEnabled(bool enabled) {
+  m_contentsCompressionEnabled = enabled;
+
+  if (enabled && !m_contentsCompressionTimer->isActive()) {
+    // Bodies of messages stored before compression
+    // was enabled are compressed in background.
+    m_lastCompressedMessageId = 0;
+    m_contentsCompressionTimer->start();
+  }
+  else if (!enabled) {
+    // Already compressed bodies stay compressed.
+    m_contentsCompressionTimer->stop();
+  }
+}
+
+void DatabaseFactory::compressMessagesContents() {
+  bool ok;
+  const bool finished = !DatabaseQueries::compressMessagesContents(connection(metaObject()->className()), &m_lastCompressedMessageId, &ok);
+
+  if (!ok || finished) {
+    qDebug("Compression of existing message bodies %s.", ok ? "is finished" : "failed");
+    m_contentsCompressionTimer->stop();
+  }
+}
+
 QSqlDatabase DatabaseFactory::mysqlConnection(const QString& connection_name) {
   if (!m_mysqlDatabaseInitialized) {
     // Return initialized database.
@@ -668,7 +1102,7 @@ QSqlDatabase DatabaseFactory::mysqlInitializeDatabase(const QString& connection_
       query_db.next();
       const QString installed_db_schema = query_db.value(0).toString();
 
-      if (installed_db_schema < APP_DB_SCHEMA_VERSION) {
+      if (installed_db_schema.toInt() < QString(APP_DB_SCHEMA_VERSION).toInt()) {
         if (mysqlUpdateDatabaseSchema(database, installed_db_schema, database_name)) {
           qDebug("Database schema was updated from '%s' to '%s' successully or it is already up to date.",
                  qPrintable(installed_db_schema),
@@ -683,6 +1117,8 @@ QSqlDatabase DatabaseFactory::mysqlInitializeDatabase(const QString& connection_
     }
 
     query_db.finish();
+    mysqlCheckIndexes(database, database_name);
+    m_searchIndexAvailable = mysqlCheckSearchIndex(database, database_name);
   }
 
   // Everything is initialized now.
@@ -690,6 +1126,67 @@ QSqlDatabase DatabaseFactory::mysqlInitializeDatabase(const QString& connection_
   return database;
 }
 
+void DatabaseFactory::mysqlCheckIndexes(const QSqlDatabase& database, const QString& db_name) {
+  const QList<QPair<QString, QString>> required_indexes = {
+    { QSL("idx_messages_feed"),
+      QSL("CREATE INDEX idx_messages_feed ON Messages (account_id, feed(100), is_deleted, is_pdeleted, is_read);") },
+    { QSL("idx_messages_custom_id"),
+      QSL("CREATE INDEX idx_messages_custom_id ON Messages (account_id, custom_id(100));") },
+    { QSL("idx_feeds_custom_id"),
+      QSL("CREATE INDEX idx_feeds_custom_id ON Feeds (account_id, custom_id(100));") },
+    { QSL("idx_messages_identity_hash"),
+      QSL("CREATE INDEX idx_messages_identity_hash ON Messages (account_id, feed(100), identity_hash);") }
+  };
+  QSqlQuery query(database);
+  QSet<QString> existing_indexes;
+
+  query.setForwardOnly(true);
+  query.prepare(QSL("SELECT DISTINCT index_name FROM information_schema.statistics WHERE table_schema = ?;"));
+  query.addBindValue(db_name);
+
+  if (!query.exec()) {
+    qWarning("Cannot obtain list of indexes from MySQL database: '%s'.", qPrintable(query.lastError().text()));
+    return;
+  }
+
+  while (query.next()) {
+    existing_indexes.insert(query.value(0).toString());
+  }
+
+  for (const QPair<QString, QString>& index : required_indexes) {
+    if (!existing_indexes.contains(index.first)) {
+      qWarning("MySQL database is missing index '%s'. Creating it now.", qPrintable(index.first));
+
+      if (!query.exec(index.second)) {
+        qCritical("MySQL index '%s' was not created: '%s'.", qPrintable(index.first), qPrintable(query.lastError().text()));
+      }
+    }
+  }
+}
+
+bool DatabaseFactory::mysqlCheckSearchIndex(const QSqlDatabase& database, const QString& db_name) {
+  QSqlQuery query(database);
+
+  query.setForwardOnly(true);
+  query.prepare(QSL("SELECT DISTINCT index_name FROM information_schema.statistics "
+                    "WHERE table_schema = ? AND index_name = 'idx_messages_search';"));
+  query.addBindValue(db_name);
+
+  if (query.exec() && query.next()) {
+    return true;
+  }
+
+  qWarning("MySQL database is missing search index of messages. Creating it now.");
+
+  if (!query.exec(QSL("CREATE FULLTEXT INDEX idx_messages_search ON Messages (title, author, contents);"))) {
+    qWarning("MySQL search index was not created, messages will be searched without index: '%s'.",
+             qPrintable(query.lastError().text()));
+    return false;
+  }
+
+  return true;
+}
+
 bool DatabaseFactory::mysqlVacuumDatabase() {
   QSqlDatabase database = mysqlConnection(objectName());
   QSqlQuery query_vacuum(database);
@@ -764,6 +1261,56 @@ QSqlDatabase DatabaseFactory::sqliteConnection(const QString& connection_name, D
   }
 }
 
+QSqlDatabase DatabaseFactory::readOnlyConnection(const QString& connection_name) {
+  if (m_activeDatabaseDriver != UsedDriver::SQLITE || !m_sqliteWalEnabled) {
+    return connection(connection_name);
+  }
+
+  if (!m_sqliteFileBasedDatabaseinitialized) {
+    sqliteConnection(objectName(), DesiredType::StrictlyFileBased);
+  }
+
+  // NOTE: Connections cannot be shared among threads,
+  // so each thread gets its own reading connection.
+  const QString reader_name = threadConnectionName(connection_name + QSL("_reader"));
+  QSqlDatabase database;
+
+  if (QSqlDatabase::contains(reader_name)) {
+    database = QSqlDatabase::database(reader_name);
+  }
+  else {
+    database = QSqlDatabase::addDatabase(APP_DB_SQLITE_DRIVER, reader_name);
+    database.setDatabaseName(sqliteDatabaseFilePath());
+    database.setConnectOptions(QSL("QSQLITE_OPEN_READONLY"));
+  }
+
+  if (!database.isOpen() && !database.open()) {
+    qFatal("Read-only SQLite database connection was NOT opened. Delivered error message: '%s'.",
+           qPrintable(database.lastError().text()));
+  }
+  else {
+    qDebug("Read-only SQLite database connection '%s' seems to be established.", qPrintable(reader_name));
+  }
+
+  return database;
+}
+
+void DatabaseFactory::sqliteCheckpointWal(bool truncate) {
+  QSqlQuery query(sqliteConnection(objectName(), DesiredType::StrictlyFileBased));
+
+  query.setForwardOnly(true);
+
+  // Result contains flag indicating that checkpoint was blocked, number
+  // of pages in log and number of pages copied into database file.
+  if (query.exec(truncate ? QSL("PRAGMA wal_checkpoint(TRUNCATE);") : QSL("PRAGMA wal_checkpoint(PASSIVE);")) && query.next()) {
+    qDebug("Checkpoint of SQLite write-ahead log copied %d of %d pages into database file.",
+           query.value(2).toInt(), query.value(1).toInt());
+  }
+  else {
+    qWarning("Checkpoint of SQLite write-ahead log failed: '%s'.", qPrintable(query.lastError().text()));
+  }
+}
+
 bool DatabaseFactory::sqliteVacuumDatabase() {
   QSqlDatabase database;
 
@@ -784,11 +1331,21 @@ bool DatabaseFactory::sqliteVacuumDatabase() {
 }
 
 void DatabaseFactory::saveDatabase() {
+  qDebug("Prepared database queries were reused %lld times and prepared %lld times.",
+         preparedQueryHits(), preparedQueryMisses());
+
   switch (m_activeDatabaseDriver) {
     case UsedDriver::SQLITE_MEMORY:
       sqliteSaveMemoryDatabase();
       break;
 
+    case UsedDriver::SQLITE:
+      if (m_sqliteWalEnabled) {
+        sqliteCheckpointWal(true);
+      }
+
+      break;
+
     default:
       break;
   }
@@ -3,12 +3,45 @@
 #ifndef DATABASEFACTORY_H
 #define DATABASEFACTORY_H
 
+#include <QCache>
+#include <QHash>
+#include <QMutex>
 #include <QObject>
+#include <QSet>
 #include <QSqlDatabase>
+#include <QSqlQuery>
+
+#include <atomic>
+
+class DatabaseFactory;
+class QTimer;
+
+// Query borrowed from cache of prepared queries. It is reset and given back
+// to the cache when it goes out of scope, so that its statement does not
+// keep read transaction open and no other caller can use it meanwhile.
+class PreparedQuery {
+  public:
+    explicit PreparedQuery(DatabaseFactory* factory, QSqlQuery* query, const QString& cache_key, const QString& statement);
+    PreparedQuery(PreparedQuery&& other) noexcept;
+    PreparedQuery(const PreparedQuery& other) = delete;
+    PreparedQuery& operator=(const PreparedQuery& other) = delete;
+    ~PreparedQuery();
+
+    QSqlQuery& operator*() const;
+    QSqlQuery* operator->() const;
+
+  private:
+    DatabaseFactory* m_factory;
+    QSqlQuery* m_query;
+    QString m_cacheKey;
+    QString m_statement;
+};
 
 class DatabaseFactory : public QObject {
   Q_OBJECT
 
+  friend class PreparedQuery;
+
   public:
 
     // Describes available typos of database backend.
@@ -44,7 +77,7 @@ class DatabaseFactory : public QObject {
     explicit DatabaseFactory(QObject* parent = nullptr);
 
     // Destructor.
-    virtual ~DatabaseFactory() = default;
+    virtual ~DatabaseFactory();
 
     // Returns size of DB file.
     qint64 getDatabaseFileSize() const;
@@ -52,17 +85,40 @@ class DatabaseFactory : public QObject {
     // Returns size of data contained in the DB file.
     qint64 getDatabaseDataSize() const;
 
+    // Returns size of write-ahead log of DB file.
+    qint64 getDatabaseWalSize() const;
+
     // If in-memory is true, then :memory: database is returned
     // In-memory database is DEFAULT database.
-    // NOTE: This always returns OPENED database.
+    // NOTE: This always returns OPENED database. Threads other than
+    // main thread get their own connections, which are removed
+    // when the threads finish.
     QSqlDatabase connection(const QString& connection_name, DesiredType desired_type = DesiredType::FromSettings);
 
+    // Returns connection for reading only. If file-based SQLite database uses
+    // write-ahead log, each thread gets its own read-only connection, which
+    // reads last committed data and is not blocked by other connections
+    // which write. Otherwise this is the same as connection(connection_name).
+    // NOTE: Feed updates are committed in main thread, so main thread still
+    // does not read while it commits.
+    QSqlDatabase readOnlyConnection(const QString& connection_name);
+
     QString humanDriverName(UsedDriver driver) const;
     QString humanDriverName(const QString& driver_code) const;
 
     // Removes connection.
     void removeConnection(const QString& connection_name = QString());
 
+    // Returns query prepared with given statement for given connection.
+    // Prepared queries are cached for each connection and thread, so that
+    // frequently used statements are not compiled each time they are used.
+    PreparedQuery preparedQuery(const QSqlDatabase& database, const QString& statement);
+
+    // Returns how many times prepared query was taken from cache and how many
+    // times it had to be prepared.
+    qint64 preparedQueryHits() const;
+    qint64 preparedQueryMisses() const;
+
     QString obtainBeginTransactionSql() const;
 
     // Performs any needed database-related operation to be done
@@ -75,6 +131,14 @@ class DatabaseFactory : public QObject {
     // Returns identification of currently active database driver.
     UsedDriver activeDatabaseDriver() const;
 
+    // Returns true if active database has full-text index of messages.
+    bool isSearchIndexAvailable() const;
+
+    // Returns true if large message bodies are stored compressed.
+    // NOTE: This is thread-safe, messages are stored in other threads.
+    bool isContentsCompressionEnabled() const;
+    void setContentsCompressionEnabled(bool enabled);
+
     // Copies selected backup database (file) to active database path.
     bool initiateRestoration(const QString& database_backup_file_path);
 
@@ -109,9 +173,37 @@ class DatabaseFactory : public QObject {
     // application session.
     void determineDriver();
 
+    // Returns name of connection for calling thread.
+    QString threadConnectionName(const QString& connection_name);
+
+    // Key of prepared queries of connection in calling thread.
+    QString preparedQueriesKey(const QString& connection_name) const;
+
+    // Gives borrowed prepared query back to cache, query is deleted
+    // if its connection was removed meanwhile.
+    void releasePreparedQuery(QSqlQuery* query, const QString& cache_key, const QString& statement);
+
+    // Protects connections of threads, prepared queries and their statistics.
+    mutable QMutex m_connectionsMutex;
+    QSet<QString> m_threadConnections;
+    QHash<QString, QCache<QString, QSqlQuery>*> m_preparedQueries;
+    qint64 m_preparedQueryHits;
+    qint64 m_preparedQueryMisses;
+
     // Holds the type of currently activated database backend.
     UsedDriver m_activeDatabaseDriver;
 
+    // Is full-text index of messages available?
+    bool m_searchIndexAvailable;
+
+    // Compresses bodies of messages stored before compression was enabled,
+    // one small batch per timer tick, so that application stays responsive.
+    void compressMessagesContents();
+
+    std::atomic<bool> m_contentsCompressionEnabled;
+    int m_lastCompressedMessageId;
+    QTimer* m_contentsCompressionTimer;
+
     //
     // MYSQL stuff.
     //
@@ -125,6 +217,13 @@ class DatabaseFactory : public QObject {
     // Updates database schema.
     bool mysqlUpdateDatabaseSchema(const QSqlDatabase& database, const QString& source_db_schema_version, const QString& db_name);
 
+    // Verifies that indexes used by frequent queries exist
+    // and creates missing ones.
+    void mysqlCheckIndexes(const QSqlDatabase& database, const QString& db_name);
+
+    // Creates FULLTEXT index of messages if it does not exist.
+    bool mysqlCheckSearchIndex(const QSqlDatabase& database, const QString& db_name);
+
     // Runs "VACUUM" on the database.
     bool mysqlVacuumDatabase();
 
@@ -141,16 +240,34 @@ class DatabaseFactory : public QObject {
     // Runs "VACUUM" on the database.
     bool sqliteVacuumDatabase();
 
+    // Copies changes from write-ahead log into database file. If "truncate"
+    // is true, waits for all connections and empties the log.
+    void sqliteCheckpointWal(bool truncate);
+
     // Performs saving of items from in-memory database
-    // to file-based database.
+    // to file-based database. Only tables and messages
+    // changed since last saving are written.
     void sqliteSaveMemoryDatabase();
 
+    // Creates temporary tables and triggers which record tables and
+    // messages changed in in-memory database since it was saved.
+    void sqliteTrackMemoryDatabaseChanges(const QSqlDatabase& database);
+
     // Assemblies database file path.
     void sqliteAssemblyDatabaseFilePath();
 
     // Updates database schema.
     bool sqliteUpdateDatabaseSchema(const QSqlDatabase& database, const QString& source_db_schema_version);
 
+    // Verifies that indexes used by frequent queries exist
+    // and creates missing ones.
+    void sqliteCheckIndexes(const QSqlDatabase& database);
+
+    // Creates FTS5 index of messages and triggers which maintain it,
+    // if SQLite supports FTS5. Otherwise removes the triggers,
+    // because they would break all changes of messages.
+    bool sqliteCheckSearchIndex(const QSqlDatabase& database);
+
     // Creates new connection, initializes database and
     // returns opened connections.
     QSqlDatabase sqliteInitializeInMemoryDatabase();
@@ -162,6 +279,10 @@ class DatabaseFactory : public QObject {
     // Is database file initialized?
     bool m_sqliteFileBasedDatabaseinitialized;
     bool m_sqliteInMemoryDatabaseInitialized;
+
+    // Does file-based database use write-ahead log?
+    bool m_sqliteWalEnabled;
+    QTimer* m_sqliteWalCheckpointTimer;
 };
 
 #endif // DATABASEFACTORY_H
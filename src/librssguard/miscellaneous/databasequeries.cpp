@@ -26,6 +26,9 @@
 #include "services/tt-rss/ttrssfeed.h"
 #include "services/tt-rss/ttrssserviceroot.h"
 
+#include <QElapsedTimer>
+#include <QRegularExpression>
+#include <QSet>
 #include <QSqlError>
 #include <QUrl>
 #include <QVariant>
@@ -39,20 +42,13 @@ bool DatabaseQueries::markMessagesReadUnread(const QSqlDatabase& db, const QStri
 }
 
 bool DatabaseQueries::markMessageImportant(const QSqlDatabase& db, int id, RootItem::Importance importance) {
-  QSqlQuery q(db);
-
-  q.setForwardOnly(true);
-
-  if (!q.prepare(QSL("UPDATE Messages SET is_important = :important WHERE id = :id;"))) {
-    qWarning("Query preparation failed for message importance switch.");
-    return false;
-  }
+  PreparedQuery q = qApp->database()->preparedQuery(db, QSL("UPDATE Messages SET is_important = :important WHERE id = :id;"));
 
-  q.bindValue(QSL(":id"), id);
-  q.bindValue(QSL(":important"), (int) importance);
+  q->bindValue(QSL(":id"), id);
+  q->bindValue(QSL(":important"), (int) importance);
 
   // Commit changes.
-  return q.exec();
+  return q->exec();
 }
 
 bool DatabaseQueries::markFeedsReadUnread(const QSqlDatabase& db, const QStringList& ids, int account_id, RootItem::ReadStatus read) {
@@ -67,24 +63,20 @@ bool DatabaseQueries::markFeedsReadUnread(const QSqlDatabase& db, const QStringL
 }
 
 bool DatabaseQueries::markBinReadUnread(const QSqlDatabase& db, int account_id, RootItem::ReadStatus read) {
-  QSqlQuery q(db);
+  PreparedQuery q = qApp->database()->preparedQuery(db, QSL("UPDATE Messages SET is_read = :read "
+                                                            "WHERE is_deleted = 1 AND is_pdeleted = 0 AND account_id = :account_id;"));
 
-  q.setForwardOnly(true);
-  q.prepare("UPDATE Messages SET is_read = :read "
-            "WHERE is_deleted = 1 AND is_pdeleted = 0 AND account_id = :account_id;");
-  q.bindValue(QSL(":read"), read == RootItem::Read ? 1 : 0);
-  q.bindValue(QSL(":account_id"), account_id);
-  return q.exec();
+  q->bindValue(QSL(":read"), read == RootItem::Read ? 1 : 0);
+  q->bindValue(QSL(":account_id"), account_id);
+  return q->exec();
 }
 
 bool DatabaseQueries::markAccountReadUnread(const QSqlDatabase& db, int account_id, RootItem::ReadStatus read) {
-  QSqlQuery q(db);
+  PreparedQuery q = qApp->database()->preparedQuery(db, QSL("UPDATE Messages SET is_read = :read WHERE is_pdeleted = 0 AND account_id = :account_id;"));
 
-  q.setForwardOnly(true);
-  q.prepare(QSL("UPDATE Messages SET is_read = :read WHERE is_pdeleted = 0 AND account_id = :account_id;"));
-  q.bindValue(QSL(":account_id"), account_id);
-  q.bindValue(QSL(":read"), read == RootItem::Read ? 1 : 0);
-  return q.exec();
+  q->bindValue(QSL(":account_id"), account_id);
+  q->bindValue(QSL(":read"), read == RootItem::Read ? 1 : 0);
+  return q->exec();
 }
 
 bool DatabaseQueries::switchMessagesImportance(const QSqlDatabase& db, const QStringList& ids) {
@@ -168,37 +160,130 @@ bool DatabaseQueries::purgeRecycleBin(const QSqlDatabase& db) {
   return q.exec();
 }
 
-QMap<QString, QPair<int, int>> DatabaseQueries::getMessageCountsForCategory(const QSqlDatabase& db,
-                                                                            const QString& custom_id,
-                                                                            int account_id,
-                                                                            bool including_total_counts,
-                                                                            bool* ok) {
-  QMap<QString, QPair<int, int>> counts;
-  QSqlQuery q(db);
+int DatabaseQueries::applyRetentionPolicy(const QSqlDatabase& db, const QString& feed_custom_id, int account_id,
+                                          const Feed::RetentionPolicy& policy, bool* ok) {
+  const QString keep_important = policy.m_keepImportant ? QSL("AND is_important = 0 ") : QString();
+  const qint64 oldest_date = QDateTime::currentDateTimeUtc().addDays(-policy.m_maxAgeDays).toMSecsSinceEpoch();
+  int removed_messages = 0;
 
-  q.setForwardOnly(true);
+  if (ok != nullptr) {
+    *ok = true;
+  }
+
+  // Each batch is removed by separate statement, feeds with too many
+  // messages to remove are trimmed during several updates.
+  for (int i = 0; i < MESSAGES_RETENTION_MAX_BATCHES && policy.isActive(); i++) {
+    QVariantList expired_ids, surplus_ids;
+
+    if (policy.m_maxAgeDays > 0) {
+      PreparedQuery q = qApp->database()->preparedQuery(db, QSL("SELECT id FROM Messages "
+                                                                "WHERE account_id = ? AND feed = ? AND date_created < ? %1"
+                                                                "LIMIT %2;").arg(keep_important,
+                                                                                 QString::number(MESSAGES_RETENTION_BATCH_SIZE)));
+
+      q->addBindValue(account_id);
+      q->addBindValue(feed_custom_id);
+      q->addBindValue(oldest_date);
+
+      if (!q->exec()) {
+        qWarning("Failed to obtain expired messages of feed '%s': '%s'.", qPrintable(feed_custom_id), qPrintable(q->lastError().text()));
+
+        if (ok != nullptr) {
+          *ok = false;
+        }
+
+        break;
+      }
+
+      while (q->next()) {
+        expired_ids << q->value(0);
+      }
+    }
+
+    if (expired_ids.isEmpty() && policy.m_keepCount > 0) {
+      PreparedQuery q = qApp->database()->preparedQuery(db, QSL("SELECT id FROM Messages "
+                                                                "WHERE account_id = ? AND feed = ? AND is_pdeleted = 0 %1"
+                                                                "ORDER BY date_created DESC LIMIT %2 OFFSET ?;").arg(keep_important,
+                                                                                                                    QString::number(MESSAGES_RETENTION_BATCH_SIZE)));
+
+      q->addBindValue(account_id);
+      q->addBindValue(feed_custom_id);
+      q->addBindValue(policy.m_keepCount);
+
+      if (!q->exec()) {
+        qWarning("Failed to obtain surplus messages of feed '%s': '%s'.", qPrintable(feed_custom_id), qPrintable(q->lastError().text()));
+
+        if (ok != nullptr) {
+          *ok = false;
+        }
+
+        break;
+      }
+
+      while (q->next()) {
+        surplus_ids << q->value(0);
+      }
+    }
+
+    if (expired_ids.isEmpty() && surplus_ids.isEmpty()) {
+      break;
+    }
+
+    const QVariantList& ids = expired_ids.isEmpty() ? surplus_ids : expired_ids;
+    PreparedQuery q = qApp->database()->preparedQuery(db, QSL("DELETE FROM Messages WHERE id IN (%1);")
+                                                      .arg(sqlPlaceholders(MESSAGES_RETENTION_BATCH_SIZE)));
+
+    // Statement always has the same number of placeholders, so that it is
+    // prepared only once. Smaller batches repeat their last ID.
+    for (int j = 0; j < MESSAGES_RETENTION_BATCH_SIZE; j++) {
+      q->addBindValue(ids.at(qMin(j, ids.size() - 1)));
+    }
+
+    if (!q->exec()) {
+      qWarning("Failed to remove messages of feed '%s' by retention policy: '%s'.",
+               qPrintable(feed_custom_id), qPrintable(q->lastError().text()));
+
+      if (ok != nullptr) {
+        *ok = false;
+      }
+
+      break;
+    }
 
-  if (including_total_counts) {
-    q.prepare("SELECT feed, sum((is_read + 1) % 2), count(*) FROM Messages "
-              "WHERE feed IN (SELECT custom_id FROM Feeds WHERE category = :category AND account_id = :account_id) AND is_deleted = 0 AND is_pdeleted = 0 AND account_id = :account_id "
-              "GROUP BY feed;");
+    removed_messages += ids.size();
   }
-  else {
-    q.prepare("SELECT feed, sum((is_read + 1) % 2) FROM Messages "
-              "WHERE feed IN (SELECT custom_id FROM Feeds WHERE category = :category AND account_id = :account_id) AND is_deleted = 0 AND is_pdeleted = 0 AND account_id = :account_id "
-              "GROUP BY feed;");
+
+  if (removed_messages > 0) {
+    qDebug("Retention policy removed %d messages of feed '%s'.", removed_messages, qPrintable(feed_custom_id));
   }
 
-  q.bindValue(QSL(":category"), custom_id);
-  q.bindValue(QSL(":account_id"), account_id);
+  return removed_messages;
+}
 
-  if (q.exec()) {
-    while (q.next()) {
-      QString feed_custom_id = q.value(0).toString();
-      int unread_count = q.value(1).toInt();
+QMap<QString, QPair<int, int>> DatabaseQueries::getMessageCountsForCategory(const QSqlDatabase& db,
+                                                                            const QString& custom_id,
+                                                                            int account_id,
+                                                                            bool including_total_counts,
+                                                                            bool* ok) {
+  QMap<QString, QPair<int, int>> counts;
+  PreparedQuery q = qApp->database()->preparedQuery(db, including_total_counts
+                                                    ? QSL("SELECT feed, unread_count, total_count FROM FeedCounters "
+                                                          "WHERE feed IN (SELECT custom_id FROM Feeds WHERE category = :category AND account_id = :account_id) "
+                                                          "AND account_id = :account_id;")
+                                                    : QSL("SELECT feed, unread_count FROM FeedCounters "
+                                                          "WHERE feed IN (SELECT custom_id FROM Feeds WHERE category = :category AND account_id = :account_id) "
+                                                          "AND account_id = :account_id;"));
+
+  q->bindValue(QSL(":category"), custom_id);
+  q->bindValue(QSL(":account_id"), account_id);
+
+  if (q->exec()) {
+    while (q->next()) {
+      QString feed_custom_id = q->value(0).toString();
+      int unread_count = q->value(1).toInt();
 
       if (including_total_counts) {
-        int total_count = q.value(2).toInt();
+        int total_count = q->value(2).toInt();
 
         counts.insert(feed_custom_id, QPair<int, int>(unread_count, total_count));
       }
@@ -223,30 +308,19 @@ QMap<QString, QPair<int, int>> DatabaseQueries::getMessageCountsForCategory(cons
 QMap<QString, QPair<int, int>> DatabaseQueries::getMessageCountsForAccount(const QSqlDatabase& db, int account_id,
                                                                            bool including_total_counts, bool* ok) {
   QMap<QString, QPair<int, int>> counts;
-  QSqlQuery q(db);
+  PreparedQuery q = qApp->database()->preparedQuery(db, including_total_counts
+                                                    ? QSL("SELECT feed, unread_count, total_count FROM FeedCounters WHERE account_id = :account_id;")
+                                                    : QSL("SELECT feed, unread_count FROM FeedCounters WHERE account_id = :account_id;"));
 
-  q.setForwardOnly(true);
+  q->bindValue(QSL(":account_id"), account_id);
 
-  if (including_total_counts) {
-    q.prepare("SELECT feed, sum((is_read + 1) % 2), count(*) FROM Messages "
-              "WHERE is_deleted = 0 AND is_pdeleted = 0 AND account_id = :account_id "
-              "GROUP BY feed;");
-  }
-  else {
-    q.prepare("SELECT feed, sum((is_read + 1) % 2) FROM Messages "
-              "WHERE is_deleted = 0 AND is_pdeleted = 0 AND account_id = :account_id "
-              "GROUP BY feed;");
-  }
-
-  q.bindValue(QSL(":account_id"), account_id);
-
-  if (q.exec()) {
-    while (q.next()) {
-      QString feed_id = q.value(0).toString();
-      int unread_count = q.value(1).toInt();
+  if (q->exec()) {
+    while (q->next()) {
+      QString feed_id = q->value(0).toString();
+      int unread_count = q->value(1).toInt();
 
       if (including_total_counts) {
-        int total_count = q.value(2).toInt();
+        int total_count = q->value(2).toInt();
 
         counts.insert(feed_id, QPair<int, int>(unread_count, total_count));
       }
@@ -268,30 +342,83 @@ QMap<QString, QPair<int, int>> DatabaseQueries::getMessageCountsForAccount(const
   return counts;
 }
 
+QMap<QString, QPair<int, int>> DatabaseQueries::getMessageCountsForFeeds(const QSqlDatabase& db, const QStringList& feed_custom_ids,
+                                                                         int account_id, bool including_total_counts, bool* ok) {
+  QMap<QString, QPair<int, int>> counts;
+
+  if (ok != nullptr) {
+    *ok = true;
+  }
+
+  // Unread and total counts of many feeds are obtained by single query.
+  for (int i = 0; i < feed_custom_ids.size(); i += MESSAGES_SELECT_BATCH_SIZE) {
+    const QStringList batch_ids = feed_custom_ids.mid(i, MESSAGES_SELECT_BATCH_SIZE);
+    PreparedQuery q = qApp->database()->preparedQuery(db, QSL("SELECT feed, unread_count, total_count FROM FeedCounters "
+                                                              "WHERE account_id = ? AND feed IN (%1);").arg(sqlPlaceholders(batch_ids.size())));
+
+    q->addBindValue(account_id);
+
+    foreach (const QString& feed_custom_id, batch_ids) {
+      q->addBindValue(feed_custom_id);
+    }
+
+    if (!q->exec()) {
+      qWarning("Failed to obtain message counts of feeds: '%s'.", qPrintable(q->lastError().text()));
+
+      if (ok != nullptr) {
+        *ok = false;
+      }
+
+      break;
+    }
+
+    while (q->next()) {
+      counts.insert(q->value(0).toString(), QPair<int, int>(q->value(1).toInt(), including_total_counts ? q->value(2).toInt() : 0));
+    }
+  }
+
+  return counts;
+}
+
 int DatabaseQueries::getMessageCountsForFeed(const QSqlDatabase& db, const QString& feed_custom_id,
                                              int account_id, bool including_total_counts, bool* ok) {
-  QSqlQuery q(db);
+  PreparedQuery q = qApp->database()->preparedQuery(db, including_total_counts
+                                                    ? QSL("SELECT total_count FROM FeedCounters WHERE feed = :feed AND account_id = :account_id;")
+                                                    : QSL("SELECT unread_count FROM FeedCounters WHERE feed = :feed AND account_id = :account_id;"));
 
-  q.setForwardOnly(true);
+  q->bindValue(QSL(":feed"), feed_custom_id);
+  q->bindValue(QSL(":account_id"), account_id);
 
-  if (including_total_counts) {
-    q.prepare("SELECT count(*) FROM Messages "
-              "WHERE feed = :feed AND is_deleted = 0 AND is_pdeleted = 0 AND account_id = :account_id;");
+  if (q->exec()) {
+    if (ok != nullptr) {
+      *ok = true;
+    }
+
+    // Feed without any messages does not need to have counters yet.
+    return q->next() ? q->value(0).toInt() : 0;
   }
   else {
-    q.prepare("SELECT count(*) FROM Messages "
-              "WHERE feed = :feed AND is_deleted = 0 AND is_pdeleted = 0 AND is_read = 0 AND account_id = :account_id;");
+    if (ok != nullptr) {
+      *ok = false;
+    }
+
+    return 0;
   }
+}
 
-  q.bindValue(QSL(":feed"), feed_custom_id);
-  q.bindValue(QSL(":account_id"), account_id);
+int DatabaseQueries::getMessageCountsForBin(const QSqlDatabase& db, int account_id, bool including_total_counts, bool* ok) {
+  PreparedQuery q = qApp->database()->preparedQuery(db, including_total_counts
+                                                    ? QSL("SELECT sum(bin_total_count) FROM FeedCounters WHERE account_id = :account_id;")
+                                                    : QSL("SELECT sum(bin_unread_count) FROM FeedCounters WHERE account_id = :account_id;"));
+
+  q->bindValue(QSL(":account_id"), account_id);
 
-  if (q.exec() && q.next()) {
+  if (q->exec() && q->next()) {
     if (ok != nullptr) {
       *ok = true;
     }
 
-    return q.value(0).toInt();
+    return q->value(0).toInt();
   }
   else {
     if (ok != nullptr) {
@@ -302,36 +429,295 @@ int DatabaseQueries::getMessageCountsForFeed(const QSqlDatabase& db, const QStri
   }
 }
 
-int DatabaseQueries::getMessageCountsForBin(const QSqlDatabase& db, int account_id, bool including_total_counts, bool* ok) {
+bool DatabaseQueries::checkFeedCounters(const QSqlDatabase& db) {
+  QElapsedTimer tmr;
+  QMap<QPair<int, QString>, QVector<int>> expected_counts;
   QSqlQuery q(db);
+  int drifted = 0;
 
+  tmr.start();
   q.setForwardOnly(true);
 
-  if (including_total_counts) {
-    q.prepare("SELECT count(*) FROM Messages "
-              "WHERE is_deleted = 1 AND is_pdeleted = 0 AND account_id = :account_id;");
+  if (!q.exec(feedCountersAggregate())) {
+    qCritical("Failed to aggregate message counts: '%s'.", qPrintable(q.lastError().text()));
+    return false;
+  }
+
+  while (q.next()) {
+    expected_counts.insert(QPair<int, QString>(q.value(0).toInt(), q.value(1).toString()),
+                           QVector<int>() << q.value(2).toInt() << q.value(3).toInt() << q.value(4).toInt() << q.value(5).toInt());
+  }
+
+  if (!q.exec(QSL("SELECT account_id, feed, unread_count, total_count, bin_unread_count, bin_total_count FROM FeedCounters;"))) {
+    qCritical("Failed to obtain message counters: '%s'.", qPrintable(q.lastError().text()));
+    return false;
+  }
+
+  while (q.next()) {
+    const QVector<int> counts = QVector<int>() << q.value(2).toInt() << q.value(3).toInt() << q.value(4).toInt() << q.value(5).toInt();
+    const QVector<int> expected = expected_counts.take(QPair<int, QString>(q.value(0).toInt(), q.value(1).toString()));
+
+    // Counters of feeds without messages must be zero.
+    if (counts != (expected.isEmpty() ? QVector<int>(4, 0) : expected)) {
+      drifted++;
+    }
+  }
+
+  // Remaining feeds have messages but no counters at all.
+  drifted += expected_counts.size();
+
+  if (drifted == 0) {
+    qDebug("Message counters are consistent, check took %lld ms.", tmr.elapsed());
+    return true;
+  }
+
+  qWarning("Message counters of %d feeds are not consistent with messages. Rebuilding them.", drifted);
+
+  const bool rebuilt = rebuildFeedCounters(db);
+
+  qDebug("Message counters were checked and rebuilt in %lld ms.", tmr.elapsed());
+  return rebuilt;
+}
+
+bool DatabaseQueries::rebuildFeedCounters(const QSqlDatabase& db) {
+  QSqlDatabase database = db;
+  QSqlQuery q(db);
+
+  q.setForwardOnly(true);
+  database.transaction();
+
+  if (q.exec(QSL("DELETE FROM FeedCounters;")) &&
+      q.exec(QSL("INSERT INTO FeedCounters (account_id, feed, unread_count, total_count, bin_unread_count, bin_total_count) ") +
+             feedCountersAggregate()) &&
+      database.commit()) {
+    return true;
   }
   else {
-    q.prepare("SELECT count(*) FROM Messages "
-              "WHERE is_read = 0 AND is_deleted = 1 AND is_pdeleted = 0 AND account_id = :account_id;");
+    qCritical("Failed to rebuild message counters: '%s'.", qPrintable(q.lastError().text()));
+    database.rollback();
+    return false;
   }
+}
 
-  q.bindValue(QSL(":account_id"), account_id);
+QList<int> DatabaseQueries::searchMessages(const QSqlDatabase& db, const QString& pattern, const QString& filter, int limit, bool* ok) {
+  const QStringList words = pattern.split(QRegularExpression(QSL("\\W+"), QRegularExpression::UseUnicodePropertiesOption),
+                                          QString::SkipEmptyParts);
+  QList<int> ids;
+  QSqlQuery q(db);
+  QElapsedTimer tmr;
 
-  if (q.exec() && q.next()) {
+  if (words.isEmpty()) {
     if (ok != nullptr) {
       *ok = true;
     }
 
-    return q.value(0).toInt();
+    return ids;
+  }
+
+  tmr.start();
+  q.setForwardOnly(true);
+
+  if (qApp->database()->isSearchIndexAvailable() &&
+      qApp->database()->activeDatabaseDriver() == DatabaseFactory::UsedDriver::MYSQL) {
+    QStringList terms;
+
+    foreach (const QString& word, words) {
+      terms.append(QSL("+%1*").arg(word));
+    }
+
+    q.prepare(QSL("SELECT Messages.id FROM Messages "
+                  "LEFT JOIN Feeds ON Messages.feed = Feeds.custom_id AND Messages.account_id = Feeds.account_id "
+                  "WHERE MATCH (Messages.title, Messages.author, Messages.contents) AGAINST (? IN BOOLEAN MODE) AND (%1) "
+                  "ORDER BY MATCH (Messages.title, Messages.author, Messages.contents) AGAINST (? IN BOOLEAN MODE) DESC, "
+                  "Messages.date_created DESC "
+                  "LIMIT ?;").arg(filter));
+    q.addBindValue(terms.join(QL1C(' ')));
+    q.addBindValue(terms.join(QL1C(' ')));
+    q.addBindValue(limit);
+  }
+  else if (qApp->database()->isSearchIndexAvailable()) {
+    QStringList terms;
+
+    // Words contain only letters and digits, so they can be
+    // safely quoted as FTS5 strings and searched as prefixes.
+    foreach (const QString& word, words) {
+      terms.append(QSL("\"%1\"*").arg(word));
+    }
+
+    q.prepare(QSL("SELECT Messages.id FROM MessagesSearch JOIN Messages ON Messages.id = MessagesSearch.rowid "
+                  "LEFT JOIN Feeds ON Messages.feed = Feeds.custom_id AND Messages.account_id = Feeds.account_id "
+                  "WHERE MessagesSearch MATCH ? AND (%1) "
+                  "ORDER BY bm25(MessagesSearch), Messages.date_created DESC "
+                  "LIMIT ?;").arg(filter));
+    q.addBindValue(terms.join(QL1C(' ')));
+    q.addBindValue(limit);
   }
   else {
+    QStringList conditions;
+
+    foreach (const QString& word, words) {
+      Q_UNUSED(word)
+      conditions.append(QSL("(Messages.title LIKE ? OR Messages.author LIKE ? OR Messages.contents LIKE ?)"));
+    }
+
+    q.prepare(QSL("SELECT Messages.id FROM Messages "
+                  "LEFT JOIN Feeds ON Messages.feed = Feeds.custom_id AND Messages.account_id = Feeds.account_id "
+                  "WHERE (%1) AND %2 "
+                  "ORDER BY Messages.date_created DESC "
+                  "LIMIT ?;").arg(filter, conditions.join(QSL(" AND "))));
+
+    foreach (const QString& word, words) {
+      for (int i = 0; i < 3; i++) {
+        q.addBindValue(QL1C('%') + word + QL1C('%'));
+      }
+    }
+
+    q.addBindValue(limit);
+  }
+
+  if (q.exec()) {
+    while (q.next()) {
+      ids.append(q.value(0).toInt());
+    }
+
+    if (ok != nullptr) {
+      *ok = true;
+    }
+  }
+  else {
+    qWarning("Searching of messages failed: '%s'.", qPrintable(q.lastError().text()));
+
     if (ok != nullptr) {
       *ok = false;
     }
+  }
 
-    return 0;
+  qDebug("Search for '%s' found %d messages in %lld ms.", qPrintable(pattern), ids.size(), tmr.elapsed());
+  return ids;
+}
+
+QMap<int, QPair<QString, QString>> DatabaseQueries::getMessagesContents(const QSqlDatabase& db, const QList<int>& ids, bool* ok) {
+  QMap<int, QPair<QString, QString>> contents;
+  QElapsedTimer tmr;
+  qint64 decompression_time = 0;
+  int decompressed = 0;
+
+  if (ok != nullptr) {
+    *ok = true;
   }
+
+  for (int i = 0; i < ids.size(); i += MESSAGES_SELECT_BATCH_SIZE) {
+    const QList<int> batch_ids = ids.mid(i, MESSAGES_SELECT_BATCH_SIZE);
+    QSqlQuery q(db);
+
+    q.setForwardOnly(true);
+    q.prepare(QSL("SELECT id, contents, enclosures, compressed_contents FROM Messages WHERE id IN (%1);")
+              .arg(sqlPlaceholders(batch_ids.size())));
+
+    foreach (int id, batch_ids) {
+      q.addBindValue(id);
+    }
+
+    if (!q.exec()) {
+      qWarning("Failed to obtain contents of messages: '%s'.", qPrintable(q.lastError().text()));
+
+      if (ok != nullptr) {
+        *ok = false;
+      }
+
+      break;
+    }
+
+    while (q.next()) {
+      if (q.isNull(3)) {
+        contents.insert(q.value(0).toInt(), QPair<QString, QString>(q.value(1).toString(), q.value(2).toString()));
+      }
+      else {
+        tmr.start();
+        contents.insert(q.value(0).toInt(), QPair<QString, QString>(messageContents(q.value(1), q.value(3)), q.value(2).toString()));
+        decompression_time += tmr.nsecsElapsed();
+        decompressed++;
+      }
+    }
+  }
+
+  if (decompressed > 0) {
+    qDebug("Decompressed contents of %d messages in %lld us.", decompressed, decompression_time / 1000);
+  }
+
+  return contents;
+}
+
+bool DatabaseQueries::compressMessagesContents(const QSqlDatabase& db, int* last_id, bool* ok) {
+  QSqlDatabase database = db;
+  QSqlQuery q(db);
+  QElapsedTimer tmr;
+  QVariantList ids, searchable_contents, compressed_contents;
+  qint64 saved_bytes = 0;
+  int checked = 0;
+
+  tmr.start();
+  q.setForwardOnly(true);
+  q.prepare(QSL("SELECT id, contents FROM Messages "
+                "WHERE id > ? AND compressed_contents IS NULL AND length(contents) > ? "
+                "ORDER BY id LIMIT %1;").arg(MESSAGES_COMPRESSION_BATCH_SIZE));
+  q.addBindValue(*last_id);
+  q.addBindValue(MESSAGES_COMPRESSION_THRESHOLD);
+
+  if (!q.exec()) {
+    qWarning("Failed to load messages for compression: '%s'.", qPrintable(q.lastError().text()));
+
+    if (ok != nullptr) {
+      *ok = false;
+    }
+
+    return false;
+  }
+
+  while (q.next()) {
+    const QString contents = q.value(1).toString();
+    const QPair<QString, QVariant> stored = storedContents(contents);
+
+    *last_id = q.value(0).toInt();
+    checked++;
+
+    if (!stored.second.isNull()) {
+      ids << *last_id;
+      searchable_contents << stored.first;
+      compressed_contents << stored.second;
+      saved_bytes += contents.toUtf8().size() - stored.first.toUtf8().size() - stored.second.toByteArray().size();
+    }
+  }
+
+  if (!ids.isEmpty()) {
+    QSqlQuery q_update(db);
+
+    // Search index is updated by triggers, it gets searchable text of messages.
+    q_update.prepare(QSL("UPDATE Messages SET contents = ?, compressed_contents = ? WHERE id = ?;"));
+    q_update.addBindValue(searchable_contents);
+    q_update.addBindValue(compressed_contents);
+    q_update.addBindValue(ids);
+    database.transaction();
+
+    if (!q_update.execBatch() || !database.commit()) {
+      qWarning("Failed to store compressed contents of messages: '%s'.", qPrintable(q_update.lastError().text()));
+      database.rollback();
+
+      if (ok != nullptr) {
+        *ok = false;
+      }
+
+      return false;
+    }
+
+    qDebug("Compressed contents of %d messages, %lld bytes saved in %lld ms.", ids.size(), saved_bytes, tmr.elapsed());
+  }
+
+  if (ok != nullptr) {
+    *ok = true;
+  }
+
+  return checked == MESSAGES_COMPRESSION_BATCH_SIZE;
 }
 
 QList<Message> DatabaseQueries::getUndeletedMessagesForFeed(const QSqlDatabase& db, const QString& feed_custom_id, int account_id,
@@ -340,7 +726,7 @@ QList<Message> DatabaseQueries::getUndeletedMessagesForFeed(const QSqlDatabase&
   QSqlQuery q(db);
 
   q.setForwardOnly(true);
-  q.prepare("SELECT id, is_read, is_deleted, is_important, custom_id, title, url, author, date_created, contents, is_pdeleted, enclosures, account_id, custom_id, custom_hash, feed, CASE WHEN length(Messages.enclosures) > 10 THEN 'true' ELSE 'false' END AS has_enclosures "
+  q.prepare("SELECT id, is_read, is_deleted, is_important, custom_id, title, url, author, date_created, contents, is_pdeleted, enclosures, account_id, custom_id, custom_hash, feed, CASE WHEN length(Messages.enclosures) > 10 THEN 'true' ELSE 'false' END AS has_enclosures, compressed_contents "
             "FROM Messages "
             "WHERE is_deleted = 0 AND is_pdeleted = 0 AND feed = :feed AND account_id = :account_id;");
   q.bindValue(QSL(":feed"), feed_custom_id);
@@ -349,7 +735,7 @@ QList<Message> DatabaseQueries::getUndeletedMessagesForFeed(const QSqlDatabase&
   if (q.exec()) {
     while (q.next()) {
       bool decoded;
-      Message message = Message::fromSqlRecord(q.record(), &decoded);
+      Message message = messageFromSqlRecord(q.record(), &decoded);
 
       if (decoded) {
         messages.append(message);
@@ -374,7 +760,7 @@ QList<Message> DatabaseQueries::getUndeletedMessagesForBin(const QSqlDatabase& d
   QSqlQuery q(db);
 
   q.setForwardOnly(true);
-  q.prepare("SELECT id, is_read, is_deleted, is_important, custom_id, title, url, author, date_created, contents, is_pdeleted, enclosures, account_id, custom_id, custom_hash, feed, CASE WHEN length(Messages.enclosures) > 10 THEN 'true' ELSE 'false' END AS has_enclosures "
+  q.prepare("SELECT id, is_read, is_deleted, is_important, custom_id, title, url, author, date_created, contents, is_pdeleted, enclosures, account_id, custom_id, custom_hash, feed, CASE WHEN length(Messages.enclosures) > 10 THEN 'true' ELSE 'false' END AS has_enclosures, compressed_contents "
             "FROM Messages "
             "WHERE is_deleted = 1 AND is_pdeleted = 0 AND account_id = :account_id;");
   q.bindValue(QSL(":account_id"), account_id);
@@ -382,7 +768,7 @@ QList<Message> DatabaseQueries::getUndeletedMessagesForBin(const QSqlDatabase& d
   if (q.exec()) {
     while (q.next()) {
       bool decoded;
-      Message message = Message::fromSqlRecord(q.record(), &decoded);
+      Message message = messageFromSqlRecord(q.record(), &decoded);
 
       if (decoded) {
         messages.append(message);
@@ -407,7 +793,7 @@ QList<Message> DatabaseQueries::getUndeletedMessagesForAccount(const QSqlDatabas
   QSqlQuery q(db);
 
   q.setForwardOnly(true);
-  q.prepare("SELECT id, is_read, is_deleted, is_important, custom_id, title, url, author, date_created, contents, is_pdeleted, enclosures, account_id, custom_id, custom_hash, feed, CASE WHEN length(Messages.enclosures) > 10 THEN 'true' ELSE 'false' END AS has_enclosures "
+  q.prepare("SELECT id, is_read, is_deleted, is_important, custom_id, title, url, author, date_created, contents, is_pdeleted, enclosures, account_id, custom_id, custom_hash, feed, CASE WHEN length(Messages.enclosures) > 10 THEN 'true' ELSE 'false' END AS has_enclosures, compressed_contents "
             "FROM Messages "
             "WHERE is_deleted = 0 AND is_pdeleted = 0 AND account_id = :account_id;");
   q.bindValue(QSL(":account_id"), account_id);
@@ -415,7 +801,7 @@ QList<Message> DatabaseQueries::getUndeletedMessagesForAccount(const QSqlDatabas
   if (q.exec()) {
     while (q.next()) {
       bool decoded;
-      Message message = Message::fromSqlRecord(q.record(), &decoded);
+      Message message = messageFromSqlRecord(q.record(), &decoded);
 
       if (decoded) {
         messages.append(message);
@@ -442,59 +828,28 @@ int DatabaseQueries::updateMessages(QSqlDatabase db,
                                     const QString& url,
                                     bool* any_message_changed,
                                     bool* ok) {
-  if (messages.isEmpty()) {
-    *any_message_changed = false;
+  *any_message_changed = false;
+
+  if (ok != nullptr) {
     *ok = true;
-    return 0;
   }
 
-  bool use_transactions = qApp->settings()->value(GROUP(Database), SETTING(Database::UseTransactions)).toBool();
+  if (messages.isEmpty()) {
+    return 0;
+  }
 
   // Does not make any difference, since each feed now has
   // its own "custom ID" (standard feeds have their custom ID equal to primary key ID).
   int updated_messages = 0;
+  QList<Message> incoming_messages;
+  QStringList incoming_custom_ids;
+  QVariantList incoming_identity_hashes;
 
-  // Prepare queries.
-  QSqlQuery query_select_with_url(db);
-  QSqlQuery query_select_with_id(db);
-  QSqlQuery query_update(db);
-  QSqlQuery query_insert(db);
-  QSqlQuery query_begin_transaction(db);
-
-  // Here we have query which will check for existence of the "same" message in given feed.
-  // The two message are the "same" if:
-  //   1) they belong to the same feed AND,
-  //   2) they have same URL AND,
-  //   3) they have same AUTHOR AND,
-  //   4) they have same title.
-  query_select_with_url.setForwardOnly(true);
-  query_select_with_url.prepare("SELECT id, date_created, is_read, is_important, contents, feed FROM Messages "
-                                "WHERE feed = :feed AND title = :title AND url = :url AND author = :author AND account_id = :account_id;");
-
-  // When we have custom ID of the message, we can check directly for existence
-  // of that particular message.
-  query_select_with_id.setForwardOnly(true);
-  query_select_with_id.prepare("SELECT id, date_created, is_read, is_important, contents, feed FROM Messages "
-                               "WHERE custom_id = :custom_id AND account_id = :account_id;");
-
-  // Used to insert new messages.
-  query_insert.setForwardOnly(true);
-  query_insert.prepare("INSERT INTO Messages "
-                       "(feed, title, is_read, is_important, url, author, date_created, contents, enclosures, custom_id, custom_hash, account_id) "
-                       "VALUES (:feed, :title, :is_read, :is_important, :url, :author, :date_created, :contents, :enclosures, :custom_id, :custom_hash, :account_id);");
-
-  // Used to update existing messages.
-  query_update.setForwardOnly(true);
-  query_update.prepare("UPDATE Messages "
-                       "SET title = :title, is_read = :is_read, is_important = :is_important, url = :url, author = :author, date_created = :date_created, contents = :contents, enclosures = :enclosures, feed = :feed "
-                       "WHERE id = :id;");
-
-  if (use_transactions && !query_begin_transaction.exec(qApp->database()->obtainBeginTransactionSql())) {
-    qCritical("Transaction start for message downloader failed: '%s'.", qPrintable(query_begin_transaction.lastError().text()));
-    return updated_messages;
-  }
+  incoming_messages.reserve(messages.size());
 
   foreach (Message message, messages) {
+    bool url_changed = true;
+
     // Check if messages contain relative URLs and if they do, then replace them.
     if (message.m_url.startsWith(QL1S("//"))) {
       message.m_url = QString(URI_SCHEME_HTTP) + message.m_url.mid(2);
@@ -509,163 +864,497 @@ int DatabaseQueries::updateMessages(QSqlDatabase db,
       new_message_url += message.m_url;
       message.m_url = new_message_url;
     }
+    else {
+      url_changed = false;
+    }
 
-    int id_existing_message = -1;
-    qint64 date_existing_message;
-    bool is_read_existing_message;
-    bool is_important_existing_message;
-    QString contents_existing_message;
-    QString feed_id_existing_message;
+    // Hashes are usually computed when feed is parsed.
+    if (url_changed || message.m_identityHash == 0) {
+      message.computeHashes();
+    }
 
     if (message.m_customId.isEmpty()) {
-      // We need to recognize existing messages according URL & AUTHOR & TITLE.
-      // NOTE: This particularly concerns messages from standard account.
-      query_select_with_url.bindValue(QSL(":feed"), unnulifyString(feed_custom_id));
-      query_select_with_url.bindValue(QSL(":title"), unnulifyString(message.m_title));
-      query_select_with_url.bindValue(QSL(":url"), unnulifyString(message.m_url));
-      query_select_with_url.bindValue(QSL(":author"), unnulifyString(message.m_author));
-      query_select_with_url.bindValue(QSL(":account_id"), account_id);
-
-      qDebug("Checking if message with title '%s', url '%s' and author '%s' is present in DB.",
-             qPrintable(message.m_title), qPrintable(message.m_url), qPrintable(message.m_author));
-
-      if (query_select_with_url.exec() && query_select_with_url.next()) {
-        id_existing_message = query_select_with_url.value(0).toInt();
-        date_existing_message = query_select_with_url.value(1).value<qint64>();
-        is_read_existing_message = query_select_with_url.value(2).toBool();
-        is_important_existing_message = query_select_with_url.value(3).toBool();
-        contents_existing_message = query_select_with_url.value(4).toString();
-        feed_id_existing_message = query_select_with_url.value(5).toString();
-
-        qDebug("Message with these attributes is already present in DB and has DB ID %d.", id_existing_message);
+      incoming_identity_hashes.append(message.m_identityHash);
+    }
+    else {
+      incoming_custom_ids.append(unnulifyString(message.m_customId));
+    }
+
+    incoming_messages.append(message);
+  }
+
+  // Existing messages are loaded at once and incoming messages are compared with them in memory.
+  // The two message are the "same" if:
+  //   1) they have same custom ID OR
+  //   2) they belong to the same feed AND have same identity hash (URL, AUTHOR and TITLE).
+  QHash<qint64, ExistingMessage> existing_with_hash;
+  QHash<QString, ExistingMessage> existing_with_id;
+
+  bool queries_ok = true;
+
+  if (!incoming_identity_hashes.isEmpty()) {
+    // NOTE: This particularly concerns messages from standard account.
+    existing_with_hash = existingMessagesWithHash(db, incoming_identity_hashes, feed_custom_id, account_id, &queries_ok);
+  }
+
+  if (!queries_ok) {
+    // Without existing messages all incoming messages would look new and they
+    // would be inserted as duplicates.
+    if (ok != nullptr) {
+      *ok = false;
+    }
+
+    return 0;
+  }
+
+  // NOTE: This concerns messages from custom accounts, like TT-RSS or ownCloud News.
+  for (int i = 0; i < incoming_custom_ids.size(); i += MESSAGES_SELECT_BATCH_SIZE) {
+    const QStringList batch_ids = incoming_custom_ids.mid(i, MESSAGES_SELECT_BATCH_SIZE);
+    PreparedQuery query_select_with_id = qApp->database()->preparedQuery(db, QSL("SELECT id, date_created, is_read, is_important, feed, "
+                                                                                 "content_hash, custom_id FROM Messages "
+                                                                                 "WHERE account_id = ? AND custom_id IN (%1);")
+                                                                         .arg(sqlPlaceholders(batch_ids.size())));
+
+    query_select_with_id->addBindValue(account_id);
+
+    foreach (const QString& custom_id, batch_ids) {
+      query_select_with_id->addBindValue(custom_id);
+    }
+
+    if (query_select_with_id->exec()) {
+      while (query_select_with_id->next()) {
+        const QString key = query_select_with_id->value(6).toString();
+
+        if (!existing_with_id.contains(key)) {
+          existing_with_id.insert(key, ExistingMessage(query_select_with_id));
+        }
+      }
+    }
+    else {
+      qWarning("Failed to load existing messages from DB via ID: '%s'.", qPrintable(query_select_with_id->lastError().text()));
+
+      if (ok != nullptr) {
+        *ok = false;
       }
-      else if (query_select_with_url.lastError().isValid()) {
-        qWarning("Failed to check for existing message in DB via URL: '%s'.", qPrintable(query_select_with_url.lastError().text()));
+
+      return 0;
+    }
+  }
+
+  // Now, decide what to do with each incoming message.
+  QList<Message> messages_to_insert;
+  QList<QPair<Message, ExistingMessage>> messages_to_update;
+  QList<QPair<Message, ExistingMessage>> messages_without_hash;
+  QSet<QString> processed_custom_ids;
+  QSet<qint64> processed_hashes;
+
+  foreach (const Message& message, incoming_messages) {
+    const bool has_custom_id = !message.m_customId.isEmpty();
+
+    // Feed contains same message more than once, first occurrence wins.
+    if (has_custom_id) {
+      if (processed_custom_ids.contains(message.m_customId)) {
+        continue;
       }
 
-      query_select_with_url.finish();
+      processed_custom_ids.insert(message.m_customId);
     }
     else {
-      // We can recognize existing messages via their custom ID.
-      // NOTE: This concerns messages from custom accounts, like TT-RSS or ownCloud News.
-      query_select_with_id.bindValue(QSL(":account_id"), account_id);
-      query_select_with_id.bindValue(QSL(":custom_id"), unnulifyString(message.m_customId));
-
-      qDebug("Checking if message with custom ID %s is present in DB.", qPrintable(message.m_customId));
-
-      if (query_select_with_id.exec() && query_select_with_id.next()) {
-        id_existing_message = query_select_with_id.value(0).toInt();
-        date_existing_message = query_select_with_id.value(1).value<qint64>();
-        is_read_existing_message = query_select_with_id.value(2).toBool();
-        is_important_existing_message = query_select_with_id.value(3).toBool();
-        contents_existing_message = query_select_with_id.value(4).toString();
-        feed_id_existing_message = query_select_with_id.value(5).toString();
-
-        qDebug("Message with custom ID %s is already present in DB and has DB ID %d.",
-               qPrintable(message.m_customId), id_existing_message);
-      }
-      else if (query_select_with_id.lastError().isValid()) {
-        qDebug("Failed to check for existing message in DB via ID: '%s'.", qPrintable(query_select_with_id.lastError().text()));
+      if (processed_hashes.contains(message.m_identityHash)) {
+        continue;
       }
 
-      query_select_with_id.finish();
+      processed_hashes.insert(message.m_identityHash);
     }
 
-    // Now, check if this message is already in the DB.
-    if (id_existing_message >= 0) {
+    const bool exists = has_custom_id ?
+                        existing_with_id.contains(message.m_customId) :
+                        existing_with_hash.contains(message.m_identityHash);
+
+    if (exists) {
       // Message is already in the DB.
       //
       // Now, we update it if at least one of next conditions is true:
       //   1) Message has custom ID AND (its date OR read status OR starred status are changed).
       //   2) Message has its date fetched from feed AND its date is different from date in DB and contents is changed.
-      if (/* 1 */ (!message.m_customId.isEmpty() && (message.m_created.toMSecsSinceEpoch() != date_existing_message ||
-                                                     message.m_isRead != is_read_existing_message ||
-                                                     message.m_isImportant != is_important_existing_message ||
-                                                     message.m_feedId != feed_id_existing_message)) ||
-
-                  /* 2 */ (message.m_createdFromFeed && message.m_created.toMSecsSinceEpoch() != date_existing_message
-                           && message.m_contents != contents_existing_message)) {
-        // Message exists, it is changed, update it.
-        query_update.bindValue(QSL(":title"), unnulifyString(message.m_title));
-        query_update.bindValue(QSL(":is_read"), (int) message.m_isRead);
-        query_update.bindValue(QSL(":is_important"), (int) message.m_isImportant);
-        query_update.bindValue(QSL(":url"), unnulifyString(message.m_url));
-        query_update.bindValue(QSL(":author"), unnulifyString(message.m_author));
-        query_update.bindValue(QSL(":date_created"), message.m_created.toMSecsSinceEpoch());
-        query_update.bindValue(QSL(":contents"), unnulifyString(message.m_contents));
-        query_update.bindValue(QSL(":enclosures"), Enclosures::encodeEnclosuresToString(message.m_enclosures));
-        query_update.bindValue(QSL(":feed"), unnulifyString(feed_id_existing_message));
-        query_update.bindValue(QSL(":id"), id_existing_message);
-        *any_message_changed = true;
-
-        if (query_update.exec()) {
-          qDebug("Updating message with title '%s' url '%s' in DB.", qPrintable(message.m_title), qPrintable(message.m_url));
-
-          if (!message.m_isRead) {
-            updated_messages++;
-          }
+      const ExistingMessage existing = has_custom_id ?
+                                       existing_with_id.value(message.m_customId) :
+                                       existing_with_hash.value(message.m_identityHash);
+
+      if (/* 1 */ has_custom_id && (message.m_created.toMSecsSinceEpoch() != existing.m_dateCreated ||
+                                    message.m_isRead != existing.m_isRead ||
+                                    message.m_isImportant != existing.m_isImportant ||
+                                    message.m_feedId != existing.m_feedId)) {
+        messages_to_update.append(QPair<Message, ExistingMessage>(message, existing));
+      }
+      else if (/* 2 */ message.m_createdFromFeed && message.m_created.toMSecsSinceEpoch() != existing.m_dateCreated) {
+        if (existing.m_contentHash == 0) {
+          // Message was stored before hashes were introduced, its contents must be compared directly.
+          messages_without_hash.append(QPair<Message, ExistingMessage>(message, existing));
         }
-        else if (query_update.lastError().isValid()) {
-          qWarning("Failed to update message in DB: '%s'.", qPrintable(query_update.lastError().text()));
+        else if (message.m_contentHash != existing.m_contentHash) {
+          messages_to_update.append(QPair<Message, ExistingMessage>(message, existing));
         }
-
-        query_update.finish();
       }
     }
     else {
       // Message with this URL is not fetched in this feed yet.
-      query_insert.bindValue(QSL(":feed"), unnulifyString(feed_custom_id));
-      query_insert.bindValue(QSL(":title"), unnulifyString(message.m_title));
-      query_insert.bindValue(QSL(":is_read"), (int) message.m_isRead);
-      query_insert.bindValue(QSL(":is_important"), (int) message.m_isImportant);
-      query_insert.bindValue(QSL(":url"), unnulifyString( message.m_url));
-      query_insert.bindValue(QSL(":author"), unnulifyString(message.m_author));
-      query_insert.bindValue(QSL(":date_created"), message.m_created.toMSecsSinceEpoch());
-      query_insert.bindValue(QSL(":contents"), unnulifyString(message.m_contents));
-      query_insert.bindValue(QSL(":enclosures"), Enclosures::encodeEnclosuresToString(message.m_enclosures));
-      query_insert.bindValue(QSL(":custom_id"), unnulifyString(message.m_customId));
-      query_insert.bindValue(QSL(":custom_hash"), unnulifyString(message.m_customHash));
-      query_insert.bindValue(QSL(":account_id"), account_id);
-
-      if (query_insert.exec() && query_insert.numRowsAffected() == 1) {
-        updated_messages++;
-
-        qDebug("Adding new message with title '%s' url '%s' to DB.", qPrintable(message.m_title), qPrintable(message.m_url));
+      messages_to_insert.append(message);
+    }
+  }
+
+  if (!messages_without_hash.isEmpty()) {
+    messages_to_update.append(changedMessagesWithoutHash(db, messages_without_hash, &queries_ok));
+
+    if (!queries_ok) {
+      if (ok != nullptr) {
+        *ok = false;
+      }
+
+      return 0;
+    }
+  }
+
+  if (!messages_to_update.isEmpty()) {
+    // Message exists, it is changed, update it.
+    PreparedQuery query_update = qApp->database()->preparedQuery(db, QSL("UPDATE Messages "
+                                                                         "SET title = ?, is_read = ?, is_important = ?, url = ?, author = ?, date_created = ?, "
+                                                                         "contents = ?, compressed_contents = ?, enclosures = ?, feed = ?, identity_hash = ?, content_hash = ? "
+                                                                         "WHERE id = ?;"));
+    QVariantList titles, is_reads, is_importants, urls, authors, dates, contents, compressed_contents, enclosures, feeds, identity_hashes,
+                 content_hashes, ids;
+
+    for (const auto& update : messages_to_update) {
+      const Message& message = update.first;
+      const QPair<QString, QVariant> stored = storedContents(message.m_contents);
+
+      titles << unnulifyString(message.m_title);
+      is_reads << int(message.m_isRead);
+      is_importants << int(message.m_isImportant);
+      urls << unnulifyString(message.m_url);
+      authors << unnulifyString(message.m_author);
+      dates << message.m_created.toMSecsSinceEpoch();
+      contents << stored.first;
+      compressed_contents << stored.second;
+      enclosures << Enclosures::encodeEnclosuresToString(message.m_enclosures);
+      feeds << unnulifyString(update.second.m_feedId);
+      identity_hashes << message.m_identityHash;
+      content_hashes << message.m_contentHash;
+      ids << update.second.m_id;
+    }
+
+    query_update->addBindValue(titles);
+    query_update->addBindValue(is_reads);
+    query_update->addBindValue(is_importants);
+    query_update->addBindValue(urls);
+    query_update->addBindValue(authors);
+    query_update->addBindValue(dates);
+    query_update->addBindValue(contents);
+    query_update->addBindValue(compressed_contents);
+    query_update->addBindValue(enclosures);
+    query_update->addBindValue(feeds);
+    query_update->addBindValue(identity_hashes);
+    query_update->addBindValue(content_hashes);
+    query_update->addBindValue(ids);
+
+    if (query_update->execBatch()) {
+      qDebug("Updated %d messages in DB.", messages_to_update.size());
+      *any_message_changed = true;
+
+      for (const auto& update : messages_to_update) {
+        if (!update.first.m_isRead) {
+          updated_messages++;
+        }
+      }
+    }
+    else {
+      qWarning("Failed to update messages in DB: '%s'.", qPrintable(query_update->lastError().text()));
+
+      if (ok != nullptr) {
+        *ok = false;
+      }
+
+      return 0;
+    }
+  }
+
+  if (!messages_to_insert.isEmpty()) {
+    const int inserted_messages = insertMessages(db, messages_to_insert, feed_custom_id, account_id, &queries_ok);
+
+    updated_messages += inserted_messages;
+    *any_message_changed |= inserted_messages > 0;
+
+    if (!queries_ok && ok != nullptr) {
+      *ok = false;
+    }
+  }
+
+  return updated_messages;
+}
+
+int DatabaseQueries::insertMessages(const QSqlDatabase& db, const QList<Message>& messages,
+                                    const QString& feed_custom_id, int account_id, bool* ok) {
+  int inserted_messages = 0;
+  bool missing_custom_ids = false;
+
+  *ok = true;
+
+  // Messages are inserted via multi-row statements, single message
+  // insertion is used only as fallback if whole batch fails.
+  for (int i = 0; i < messages.size(); i += MESSAGES_INSERT_BATCH_SIZE) {
+    const QList<Message> batch = messages.mid(i, MESSAGES_INSERT_BATCH_SIZE);
+    QStringList rows;
+
+    for (int j = 0; j < batch.size(); j++) {
+      rows << QSL("(") + sqlPlaceholders(15) + QSL(")");
+    }
+
+    // NOTE: All full batches share the same statement.
+    PreparedQuery query_insert = qApp->database()->preparedQuery(db, QSL("INSERT INTO Messages "
+                                                                         "(feed, title, is_read, is_important, url, author, date_created, contents, "
+                                                                         "compressed_contents, enclosures, custom_id, custom_hash, account_id, identity_hash, "
+                                                                         "content_hash) "
+                                                                         "VALUES %1;").arg(rows.join(QSL(", "))));
+
+    foreach (const Message& message, batch) {
+      bindInsertedMessage(*query_insert, message, feed_custom_id, account_id);
+      missing_custom_ids |= message.m_customId.isEmpty();
+    }
+
+    if (query_insert->exec()) {
+      inserted_messages += query_insert->numRowsAffected();
+      qDebug("Added %d new messages to DB.", batch.size());
+      continue;
+    }
+
+    qWarning("Failed to insert batch of messages to DB, inserting them one by one: '%s'.",
+             qPrintable(query_insert->lastError().text()));
+
+    foreach (const Message& message, batch) {
+      PreparedQuery query_insert_one = qApp->database()->preparedQuery(db, QSL("INSERT INTO Messages "
+                                                                               "(feed, title, is_read, is_important, url, author, date_created, contents, "
+                                                                               "compressed_contents, enclosures, custom_id, custom_hash, account_id, "
+                                                                               "identity_hash, content_hash) "
+                                                                               "VALUES (%1);").arg(sqlPlaceholders(15)));
+
+      bindInsertedMessage(*query_insert_one, message, feed_custom_id, account_id);
+
+      if (query_insert_one->exec() && query_insert_one->numRowsAffected() == 1) {
+        inserted_messages++;
       }
-      else if (query_insert.lastError().isValid()) {
+      else if (query_insert_one->lastError().isValid()) {
         qWarning("Failed to insert message to DB: '%s' - message title is '%s'.",
-                 qPrintable(query_insert.lastError().text()),
+                 qPrintable(query_insert_one->lastError().text()),
                  qPrintable(message.m_title));
+        *ok = false;
       }
+    }
+  }
+
+  // Messages which initially did not have custom ID get their primary ID as custom ID,
+  // just to keep the data consistent. Only just inserted rows have empty custom ID,
+  // so this is an index lookup, not a table scan.
+  if (missing_custom_ids) {
+    PreparedQuery query_custom_id = qApp->database()->preparedQuery(db, QSL("UPDATE Messages SET custom_id = id "
+                                                                            "WHERE account_id = :account_id AND custom_id = '';"));
+
+    query_custom_id->bindValue(QSL(":account_id"), account_id);
+
+    if (!query_custom_id->exec()) {
+      qWarning("Failed to set custom ID for new messages: '%s'.", qPrintable(query_custom_id->lastError().text()));
+      *ok = false;
+    }
+  }
+
+  return inserted_messages;
+}
+
+void DatabaseQueries::bindInsertedMessage(QSqlQuery& query, const Message& message,
+                                          const QString& feed_custom_id, int account_id) {
+  const QPair<QString, QVariant> stored = storedContents(message.m_contents);
+
+  query.addBindValue(unnulifyString(feed_custom_id));
+  query.addBindValue(unnulifyString(message.m_title));
+  query.addBindValue(int(message.m_isRead));
+  query.addBindValue(int(message.m_isImportant));
+  query.addBindValue(unnulifyString(message.m_url));
+  query.addBindValue(unnulifyString(message.m_author));
+  query.addBindValue(message.m_created.toMSecsSinceEpoch());
+  query.addBindValue(stored.first);
+  query.addBindValue(stored.second);
+  query.addBindValue(Enclosures::encodeEnclosuresToString(message.m_enclosures));
+  query.addBindValue(unnulifyString(message.m_customId));
+  query.addBindValue(unnulifyString(message.m_customHash));
+  query.addBindValue(account_id);
+  query.addBindValue(message.m_identityHash);
+  query.addBindValue(message.m_contentHash);
+}
 
-      query_insert.finish();
+QHash<qint64, DatabaseQueries::ExistingMessage> DatabaseQueries::existingMessagesWithHash(const QSqlDatabase& db,
+                                                                                           const QVariantList& identity_hashes,
+                                                                                           const QString& feed_custom_id,
+                                                                                           int account_id, bool* ok) {
+  QHash<qint64, ExistingMessage> existing;
+
+  *ok = true;
+
+  // Only messages with incoming hashes are loaded, so the cost does not
+  // depend on number of messages already stored in the feed.
+  for (int i = 0; i < identity_hashes.size(); i += MESSAGES_SELECT_BATCH_SIZE) {
+    const QVariantList batch_hashes = identity_hashes.mid(i, MESSAGES_SELECT_BATCH_SIZE);
+    PreparedQuery q = qApp->database()->preparedQuery(db, QSL("SELECT id, date_created, is_read, is_important, feed, content_hash, identity_hash "
+                                                              "FROM Messages WHERE account_id = ? AND feed = ? AND identity_hash IN (%1);")
+                                                          .arg(sqlPlaceholders(batch_hashes.size())));
+
+    q->addBindValue(account_id);
+    q->addBindValue(unnulifyString(feed_custom_id));
+
+    foreach (const QVariant& hash, batch_hashes) {
+      q->addBindValue(hash);
+    }
+
+    if (q->exec()) {
+      while (q->next()) {
+        const qint64 hash = q->value(6).value<qint64>();
+
+        if (!existing.contains(hash)) {
+          existing.insert(hash, ExistingMessage(q));
+        }
+      }
+    }
+    else {
+      qWarning("Failed to load existing messages from DB via hash: '%s'.", qPrintable(q->lastError().text()));
+      *ok = false;
+      return existing;
     }
   }
 
-  // Now, fixup custom IDS for messages which initially did not have them,
-  // just to keep the data consistent.
-  if (db.exec("UPDATE Messages "
-              "SET custom_id = id "
-              "WHERE custom_id IS NULL OR custom_id = '';").lastError().isValid()) {
-    qWarning("Failed to set custom ID for all messages: '%s'.", qPrintable(db.lastError().text()));
+  // Messages stored before hashes were introduced do not have them yet, so
+  // their identity hashes are calculated from their texts once and saved.
+  QSqlQuery q(db);
+
+  q.setForwardOnly(true);
+  q.prepare(QSL("SELECT id, date_created, is_read, is_important, feed, content_hash, title, url, author FROM Messages "
+                "WHERE account_id = :account_id AND feed = :feed AND identity_hash IS NULL;"));
+  q.bindValue(QSL(":account_id"), account_id);
+  q.bindValue(QSL(":feed"), unnulifyString(feed_custom_id));
+
+  if (!q.exec()) {
+    qWarning("Failed to load existing messages without hash from DB: '%s'.", qPrintable(q.lastError().text()));
+    *ok = false;
+    return existing;
   }
 
-  if (use_transactions && !db.commit()) {
-    qCritical("Transaction commit for message downloader failed: '%s'.", qPrintable(db.lastError().text()));
-    db.rollback();
+  QVariantList hashes_to_store, ids_to_store;
 
-    if (ok != nullptr) {
+  while (q.next()) {
+    const qint64 hash = Message::identityHash(q.value(6).toString(), q.value(7).toString(), q.value(8).toString());
+    const ExistingMessage message(q);
+
+    if (!existing.contains(hash)) {
+      existing.insert(hash, message);
+    }
+
+    hashes_to_store << hash;
+    ids_to_store << message.m_id;
+  }
+
+  if (!ids_to_store.isEmpty()) {
+    QSqlQuery query_store(db);
+
+    query_store.prepare(QSL("UPDATE Messages SET identity_hash = ? WHERE id = ?;"));
+    query_store.addBindValue(hashes_to_store);
+    query_store.addBindValue(ids_to_store);
+
+    if (query_store.execBatch()) {
+      qDebug("Stored identity hashes of %d older messages.", ids_to_store.size());
+    }
+    else {
+      qWarning("Failed to store identity hashes of messages: '%s'.", qPrintable(query_store.lastError().text()));
+    }
+  }
+
+  return existing;
+}
+
+QList<QPair<Message, DatabaseQueries::ExistingMessage>> DatabaseQueries::changedMessagesWithoutHash(const QSqlDatabase& db,
+                                                                                                   const QList<QPair<Message, ExistingMessage>>& messages,
+                                                                                                   bool* ok) {
+  QList<QPair<Message, ExistingMessage>> changed_messages;
+  QVariantList hashes_to_store, ids_to_store;
+
+  *ok = true;
+
+  for (int i = 0; i < messages.size(); i += MESSAGES_SELECT_BATCH_SIZE) {
+    const QList<QPair<Message, ExistingMessage>> batch = messages.mid(i, MESSAGES_SELECT_BATCH_SIZE);
+    QHash<int, qint64> stored_hashes;
+    QSqlQuery q(db);
+
+    q.setForwardOnly(true);
+    q.prepare(QSL("SELECT id, contents, compressed_contents FROM Messages WHERE id IN (%1);").arg(sqlPlaceholders(batch.size())));
+
+    for (const auto& message : batch) {
+      q.addBindValue(message.second.m_id);
+    }
+
+    if (!q.exec()) {
+      qWarning("Failed to load contents of existing messages: '%s'.", qPrintable(q.lastError().text()));
       *ok = false;
-      updated_messages = 0;
+      return changed_messages;
+    }
+
+    while (q.next()) {
+      stored_hashes.insert(q.value(0).toInt(), Message::contentHash(messageContents(q.value(1), q.value(2))));
+    }
+
+    for (const auto& message : batch) {
+      if (!stored_hashes.contains(message.second.m_id)) {
+        continue;
+      }
+
+      if (stored_hashes.value(message.second.m_id) != message.first.m_contentHash) {
+        // Changed message gets its new hashes stored when it is updated.
+        changed_messages.append(message);
+      }
+      else {
+        hashes_to_store << message.first.m_contentHash;
+        ids_to_store << message.second.m_id;
+      }
     }
   }
-  else {
-    if (ok != nullptr) {
-      *ok = true;
+
+  if (!ids_to_store.isEmpty()) {
+    QSqlQuery query_store(db);
+
+    query_store.prepare(QSL("UPDATE Messages SET content_hash = ? WHERE id = ?;"));
+    query_store.addBindValue(hashes_to_store);
+    query_store.addBindValue(ids_to_store);
+
+    if (!query_store.execBatch()) {
+      qWarning("Failed to store content hashes of messages: '%s'.", qPrintable(query_store.lastError().text()));
     }
   }
 
-  return updated_messages;
+  return changed_messages;
+}
+
+QString DatabaseQueries::sqlPlaceholders(int count) {
+  QStringList placeholders;
+
+  placeholders.reserve(count);
+
+  for (int i = 0; i < count; i++) {
+    placeholders << QSL("?");
+  }
+
+  return placeholders.join(QSL(", "));
+}
+
+QString DatabaseQueries::feedCountersAggregate() {
+  return QSL("SELECT account_id, feed, "
+             "sum(is_deleted = 0 AND is_pdeleted = 0 AND is_read = 0), sum(is_deleted = 0 AND is_pdeleted = 0), "
+             "sum(is_deleted = 1 AND is_pdeleted = 0 AND is_read = 0), sum(is_deleted = 1 AND is_pdeleted = 0) "
+             "FROM Messages GROUP BY account_id, feed");
 }
 
 bool DatabaseQueries::purgeMessagesFromBin(const QSqlDatabase& db, bool clear_only_read, int account_id) {
@@ -691,6 +1380,7 @@ bool DatabaseQueries::deleteAccount(const QSqlDatabase& db, int account_id) {
   QStringList queries;
 
   queries << QSL("DELETE FROM Messages WHERE account_id = :account_id;") <<
+    QSL("DELETE FROM FeedCounters WHERE account_id = :account_id;") <<
     QSL("DELETE FROM Feeds WHERE account_id = :account_id;") <<
     QSL("DELETE FROM Categories WHERE account_id = :account_id;") <<
     QSL("DELETE FROM Accounts WHERE id = :account_id;");
@@ -787,8 +1477,10 @@ bool DatabaseQueries::storeAccountTree(const QSqlDatabase& db, RootItem* tree_ro
   query_feed.setForwardOnly(true);
   query_category.prepare("INSERT INTO Categories (parent_id, title, account_id, custom_id) "
                          "VALUES (:parent_id, :title, :account_id, :custom_id);");
-  query_feed.prepare("INSERT INTO Feeds (title, icon, category, protected, update_type, update_interval, account_id, custom_id) "
-                     "VALUES (:title, :icon, :category, :protected, :update_type, :update_interval, :account_id, :custom_id);");
+  query_feed.prepare("INSERT INTO Feeds (title, icon, category, protected, update_type, update_interval, account_id, custom_id, "
+                     "retention_count, retention_days, retention_keep_important) "
+                     "VALUES (:title, :icon, :category, :protected, :update_type, :update_interval, :account_id, :custom_id, "
+                     ":retention_count, :retention_days, :retention_keep_important);");
 
   // Iterate all children.
   foreach (RootItem* child, tree_root->getSubTree()) {
@@ -816,6 +1508,9 @@ bool DatabaseQueries::storeAccountTree(const QSqlDatabase& db, RootItem* tree_ro
       query_feed.bindValue(QSL(":update_interval"), feed->autoUpdateInitialInterval());
       query_feed.bindValue(QSL(":account_id"), account_id);
       query_feed.bindValue(QSL(":custom_id"), feed->customId());
+      query_feed.bindValue(QSL(":retention_count"), feed->retentionPolicy().m_keepCount);
+      query_feed.bindValue(QSL(":retention_days"), feed->retentionPolicy().m_maxAgeDays);
+      query_feed.bindValue(QSL(":retention_keep_important"), feed->retentionPolicy().m_keepImportant ? 1 : 0);
 
       if (query_feed.exec()) {
         feed->setId(query_feed.lastInsertId().toInt());
@@ -1105,6 +1800,15 @@ bool DatabaseQueries::deleteFeed(const QSqlDatabase& db, int feed_custom_id, int
     return false;
   }
 
+  // Counters of the feed are all zero now.
+  q.prepare(QSL("DELETE FROM FeedCounters WHERE feed = :feed AND account_id = :account_id;"));
+  q.bindValue(QSL(":feed"), feed_custom_id);
+  q.bindValue(QSL(":account_id"), account_id);
+
+  if (!q.exec()) {
+    return false;
+  }
+
   // Remove feed itself.
   q.prepare(QSL("DELETE FROM Feeds WHERE custom_id = :feed AND account_id = :account_id;"));
   q.bindValue(QSL(":feed"), feed_custom_id);
@@ -1250,7 +1954,7 @@ bool DatabaseQueries::editFeed(const QSqlDatabase& db, int parent_id, int feed_i
 
   q.setForwardOnly(true);
   q.prepare("UPDATE Feeds "
-            "SET title = :title, description = :description, icon = :icon, category = :category, encoding = :encoding, url = :url, protected = :protected, username = :username, password = :password, update_type = :update_type, update_interval = :update_interval, type = :type "
+            "SET title = :title, description = :description, icon = :icon, category = :category, encoding = :encoding, url = :url, protected = :protected, username = :username, password = :password, update_type = :update_type, update_interval = :update_interval, type = :type, http_etag = NULL, http_last_modified = NULL "
             "WHERE id = :id;");
   q.bindValue(QSL(":title"), title);
   q.bindValue(QSL(":description"), description);
@@ -1296,6 +2000,25 @@ bool DatabaseQueries::editBaseFeed(const QSqlDatabase& db, int feed_id, Feed::Au
   return q.exec();
 }
 
+bool DatabaseQueries::updateFeedHttpValidators(const QSqlDatabase& db, int feed_id, const QString& etag,
+                                               const QString& last_modified) {
+  QSqlQuery q(db);
+
+  q.setForwardOnly(true);
+  q.prepare(QSL("UPDATE Feeds SET http_etag = :http_etag, http_last_modified = :http_last_modified WHERE id = :id;"));
+  q.bindValue(QSL(":http_etag"), unnulifyString(etag));
+  q.bindValue(QSL(":http_last_modified"), unnulifyString(last_modified));
+  q.bindValue(QSL(":id"), feed_id);
+
+  bool suc = q.exec();
+
+  if (!suc) {
+    qWarning("Failed to store HTTP validators of feed: '%s'.", qPrintable(q.lastError().text()));
+  }
+
+  return suc;
+}
+
 QList<ServiceRoot*> DatabaseQueries::getAccounts(const QSqlDatabase& db, bool* ok) {
   QSqlQuery q(db);
 
@@ -1472,6 +2195,50 @@ bool DatabaseQueries::createTtRssAccount(const QSqlDatabase& db, int id_to_assig
   }
 }
 
+bool DatabaseQueries::editFeedRetentionPolicy(const QSqlDatabase& db, int feed_id, const Feed::RetentionPolicy& policy) {
+  QSqlQuery q(db);
+
+  q.setForwardOnly(true);
+  q.prepare(QSL("UPDATE Feeds "
+                "SET retention_count = :retention_count, retention_days = :retention_days, "
+                "retention_keep_important = :retention_keep_important "
+                "WHERE id = :id;"));
+  q.bindValue(QSL(":retention_count"), policy.m_keepCount);
+  q.bindValue(QSL(":retention_days"), policy.m_maxAgeDays);
+  q.bindValue(QSL(":retention_keep_important"), policy.m_keepImportant ? 1 : 0);
+  q.bindValue(QSL(":id"), feed_id);
+
+  bool suc = q.exec();
+
+  if (!suc) {
+    qWarning("Failed to store retention policy of feed: '%s'.", qPrintable(q.lastError().text()));
+  }
+
+  return suc;
+}
+
+bool DatabaseQueries::editCategoryRetentionPolicy(const QSqlDatabase& db, int category_id, const Feed::RetentionPolicy& policy) {
+  QSqlQuery q(db);
+
+  q.setForwardOnly(true);
+  q.prepare(QSL("UPDATE Categories "
+                "SET retention_count = :retention_count, retention_days = :retention_days, "
+                "retention_keep_important = :retention_keep_important "
+                "WHERE id = :id;"));
+  q.bindValue(QSL(":retention_count"), policy.m_keepCount);
+  q.bindValue(QSL(":retention_days"), policy.m_maxAgeDays);
+  q.bindValue(QSL(":retention_keep_important"), policy.m_keepImportant ? 1 : 0);
+  q.bindValue(QSL(":id"), category_id);
+
+  bool suc = q.exec();
+
+  if (!suc) {
+    qWarning("Failed to store retention policy of category: '%s'.", qPrintable(q.lastError().text()));
+  }
+
+  return suc;
+}
+
 Assignment DatabaseQueries::getCategories(const QSqlDatabase& db, int account_id, bool* ok) {
   Assignment categories;
 
@@ -1810,6 +2577,87 @@ Assignment DatabaseQueries::getTtRssFeeds(const QSqlDatabase& db, int account_id
   return feeds;
 }
 
+QPair<QString, QVariant> DatabaseQueries::storedContents(const QString& contents) {
+  if (qApp->database()->isContentsCompressionEnabled()) {
+    const QByteArray utf8_contents = contents.toUtf8();
+
+    if (utf8_contents.size() > MESSAGES_COMPRESSION_THRESHOLD) {
+      const QByteArray compressed_contents = qCompress(utf8_contents);
+      const QString searchable_contents = searchableContents(contents);
+
+      if (compressed_contents.size() + searchable_contents.toUtf8().size() < utf8_contents.size()) {
+        return QPair<QString, QVariant>(searchable_contents, compressed_contents);
+      }
+    }
+  }
+
+  return QPair<QString, QVariant>(unnulifyString(contents), QVariant(QVariant::ByteArray));
+}
+
+QString DatabaseQueries::searchableContents(const QString& contents) {
+  QStringList words;
+  QSet<QString> known_words;
+  QString word;
+  bool in_tag = false;
+
+  // Tags and entities separate words, their own names are not searchable.
+  for (int i = 0; i <= contents.size(); i++) {
+    const QChar chr = i < contents.size() ? contents.at(i) : QChar(QChar::Space);
+
+    if (in_tag) {
+      in_tag = chr != QL1C('>');
+      continue;
+    }
+    else if (chr.isLetterOrNumber() || chr.isMark() || chr == QL1C('_')) {
+      word.append(chr);
+      continue;
+    }
+    else if (chr == QL1C('<')) {
+      in_tag = true;
+    }
+    else if (chr == QL1C('&')) {
+      const int entity_end = contents.indexOf(QL1C(';'), i);
+
+      if (entity_end > i && entity_end - i <= 10) {
+        i = entity_end;
+      }
+    }
+
+    if (!word.isEmpty()) {
+      const QString known_word = word.toLower();
+
+      if (!known_words.contains(known_word)) {
+        known_words.insert(known_word);
+        words.append(word);
+      }
+
+      word.clear();
+    }
+  }
+
+  return words.join(QL1C(' '));
+}
+
+QString DatabaseQueries::messageContents(const QVariant& contents, const QVariant& compressed_contents) {
+  if (compressed_contents.isNull()) {
+    return contents.toString();
+  }
+  else {
+    return QString::fromUtf8(qUncompress(compressed_contents.toByteArray()));
+  }
+}
+
+Message DatabaseQueries::messageFromSqlRecord(QSqlRecord record, bool* decoded) {
+  const int compressed_index = record.indexOf(QSL("compressed_contents"));
+
+  if (compressed_index >= 0) {
+    record.setValue(MSG_DB_CONTENTS_INDEX, messageContents(record.value(MSG_DB_CONTENTS_INDEX), record.value(compressed_index)));
+    record.remove(compressed_index);
+  }
+
+  return Message::fromSqlRecord(record, decoded);
+}
+
 QString DatabaseQueries::unnulifyString(const QString& str) {
   return str.isNull() ? "" : str;
 }
@@ -32,6 +32,11 @@ class DatabaseQueries {
     static bool purgeMessagesFromBin(const QSqlDatabase& db, bool clear_only_read, int account_id);
     static bool purgeLeftoverMessages(const QSqlDatabase& db, int account_id);
 
+    // Deletes limited number of messages of the feed which are not allowed by retention policy,
+    // those are expired messages and surplus messages beyond the newest ones.
+    static int applyRetentionPolicy(const QSqlDatabase& db, const QString& feed_custom_id, int account_id,
+                                    const Feed::RetentionPolicy& policy, bool* ok = nullptr);
+
     // Obtain counts of unread/all messages.
     static QMap<QString, QPair<int, int>> getMessageCountsForCategory(const QSqlDatabase& db, const QString& custom_id, int account_id,
                                                                       bool including_total_counts, bool* ok = nullptr);
@@ -39,19 +44,40 @@ class DatabaseQueries {
                                                                      bool including_total_counts, bool* ok = nullptr);
     static int getMessageCountsForFeed(const QSqlDatabase& db, const QString& feed_custom_id, int account_id,
                                        bool including_total_counts, bool* ok = nullptr);
+    static QMap<QString, QPair<int, int>> getMessageCountsForFeeds(const QSqlDatabase& db, const QStringList& feed_custom_ids,
+                                                                   int account_id, bool including_total_counts, bool* ok = nullptr);
     static int getMessageCountsForBin(const QSqlDatabase& db, int account_id, bool including_total_counts, bool* ok = nullptr);
 
+    // Counts are read from "FeedCounters" table which is maintained by triggers.
+    // These methods compare it with messages and rebuild it if they differ.
+    // NOTE: Check aggregates all messages, so it runs only on database cleanup.
+    static bool checkFeedCounters(const QSqlDatabase& db);
+    static bool rebuildFeedCounters(const QSqlDatabase& db);
+
     // Get messages (for newspaper view for example).
     static QList<Message> getUndeletedMessagesForFeed(const QSqlDatabase& db, const QString& feed_custom_id, int account_id, bool* ok = nullptr);
     static QList<Message> getUndeletedMessagesForBin(const QSqlDatabase& db, int account_id, bool* ok = nullptr);
     static QList<Message> getUndeletedMessagesForAccount(const QSqlDatabase& db, int account_id, bool* ok = nullptr);
 
+    // Returns IDs of messages matching the filter of messages model which contain
+    // all words of the pattern, most relevant and newest messages are first.
+    static QList<int> searchMessages(const QSqlDatabase& db, const QString& pattern, const QString& filter, int limit, bool* ok = nullptr);
+
+    // Returns contents and enclosures of messages with given IDs.
+    static QMap<int, QPair<QString, QString>> getMessagesContents(const QSqlDatabase& db, const QList<int>& ids, bool* ok = nullptr);
+
+    // Compresses large bodies of limited number of messages with IDs greater than "last_id"
+    // and moves "last_id" past them. Returns false if there are no more messages to check.
+    static bool compressMessagesContents(const QSqlDatabase& db, int* last_id, bool* ok = nullptr);
+
     // Custom ID accumulators.
     static QStringList customIdsOfMessagesFromAccount(const QSqlDatabase& db, int account_id, bool* ok = nullptr);
     static QStringList customIdsOfMessagesFromBin(const QSqlDatabase& db, int account_id, bool* ok = nullptr);
     static QStringList customIdsOfMessagesFromFeed(const QSqlDatabase& db, const QString& feed_custom_id, int account_id, bool* ok = nullptr);
 
     // Common accounts methods.
+    // NOTE: Caller is responsible for transaction handling. If any query fails,
+    // then "ok" is set to false and messages of the feed may be stored only partially.
     static int updateMessages(QSqlDatabase db, const QList<Message>& messages, const QString& feed_custom_id,
                               int account_id, const QString& url, bool* any_message_changed, bool* ok = nullptr);
     static bool deleteAccount(const QSqlDatabase& db, int account_id);
@@ -60,6 +86,10 @@ class DatabaseQueries {
     static bool storeAccountTree(const QSqlDatabase& db, RootItem* tree_root, int account_id);
     static bool editBaseFeed(const QSqlDatabase& db, int feed_id, Feed::AutoUpdateType auto_update_type,
                              int auto_update_interval);
+    static bool updateFeedHttpValidators(const QSqlDatabase& db, int feed_id, const QString& etag,
+                                         const QString& last_modified);
+    static bool editFeedRetentionPolicy(const QSqlDatabase& db, int feed_id, const Feed::RetentionPolicy& policy);
+    static bool editCategoryRetentionPolicy(const QSqlDatabase& db, int category_id, const Feed::RetentionPolicy& policy);
     static Assignment getCategories(const QSqlDatabase& db, int account_id, bool* ok = nullptr);
 
     // Gmail account.
@@ -130,6 +160,55 @@ class DatabaseQueries {
     static Assignment getTtRssFeeds(const QSqlDatabase& db, int account_id, bool* ok = nullptr);
 
   private:
+
+    // State of message which is already stored in DB.
+    struct ExistingMessage {
+      ExistingMessage() = default;
+
+      // Reads message from query which selects
+      // "id, date_created, is_read, is_important, feed, content_hash".
+      explicit ExistingMessage(const QSqlQuery& query)
+        : m_id(query.value(0).toInt()), m_dateCreated(query.value(1).value<qint64>()),
+        m_isRead(query.value(2).toBool()), m_isImportant(query.value(3).toBool()), m_feedId(query.value(4).toString()),
+        m_contentHash(query.value(5).value<qint64>()) {}
+
+      int m_id = -1;
+      qint64 m_dateCreated = 0;
+      bool m_isRead = false;
+      bool m_isImportant = false;
+      QString m_feedId;
+
+      // Zero if message was stored before hashes were introduced.
+      qint64 m_contentHash = 0;
+    };
+
+    static int insertMessages(const QSqlDatabase& db, const QList<Message>& messages,
+                              const QString& feed_custom_id, int account_id, bool* ok);
+    static void bindInsertedMessage(QSqlQuery& query, const Message& message,
+                                    const QString& feed_custom_id, int account_id);
+    static QHash<qint64, ExistingMessage> existingMessagesWithHash(const QSqlDatabase& db, const QVariantList& identity_hashes,
+                                                                   const QString& feed_custom_id, int account_id, bool* ok);
+
+    // Compares contents of messages, which do not have content hash stored yet, and
+    // returns changed ones. Hashes of unchanged messages are stored.
+    static QList<QPair<Message, ExistingMessage>> changedMessagesWithoutHash(const QSqlDatabase& db,
+                                                                             const QList<QPair<Message, ExistingMessage>>& messages,
+                                                                             bool* ok);
+
+    // Large message bodies are stored compressed in "compressed_contents" column,
+    // "contents" column of such messages holds their searchable text, so that
+    // search index and plain search still find them by words of their bodies.
+    static QPair<QString, QVariant> storedContents(const QString& contents);
+
+    // Returns words of message body without markup, each word is kept only once.
+    static QString searchableContents(const QString& contents);
+    static QString messageContents(const QVariant& contents, const QVariant& compressed_contents);
+
+    // Reads message from record which selects "compressed_contents" after columns
+    // expected by Message::fromSqlRecord().
+    static Message messageFromSqlRecord(QSqlRecord record, bool* decoded);
+    static QString sqlPlaceholders(int count);
+    static QString feedCountersAggregate();
     static QString unnulifyString(const QString& str);
 
     explicit DatabaseQueries();
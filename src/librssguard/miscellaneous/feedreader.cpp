@@ -5,10 +5,11 @@
 #include "core/feeddownloader.h"
 #include "core/feedsmodel.h"
 #include "core/feedsproxymodel.h"
+#include "core/feedupdatescheduler.h"
 #include "core/messagesmodel.h"
 #include "core/messagesproxymodel.h"
 #include "miscellaneous/application.h"
-#include "miscellaneous/mutex.h"
+#include "miscellaneous/updatelock.h"
 #include "services/abstract/cacheforserviceroot.h"
 #include "services/abstract/serviceroot.h"
 #include "services/gmail/gmailentrypoint.h"
@@ -22,14 +23,14 @@
 #include <QTimer>
 
 FeedReader::FeedReader(QObject* parent)
-  : QObject(parent),
-  m_autoUpdateTimer(new QTimer(this)), m_feedDownloader(nullptr) {
+  : QObject(parent), m_feedDownloader(nullptr) {
   m_feedsModel = new FeedsModel(this);
   m_feedsProxyModel = new FeedsProxyModel(m_feedsModel, this);
   m_messagesModel = new MessagesModel(this);
   m_messagesProxyModel = new MessagesProxyModel(m_messagesModel, this);
+  m_autoUpdateScheduler = new FeedUpdateScheduler(m_feedsModel, this);
 
-  connect(m_autoUpdateTimer, &QTimer::timeout, this, &FeedReader::executeNextAutoUpdate);
+  connect(m_autoUpdateScheduler, &FeedUpdateScheduler::feedsDue, this, &FeedReader::executeNextAutoUpdate);
   updateAutoUpdateStatus();
   asyncCacheSaveFinished();
 
@@ -58,10 +59,17 @@ QList<ServiceEntryPoint*> FeedReader::feedServices() {
 }
 
 void FeedReader::updateFeeds(const QList<Feed*>& feeds) {
-  if (!qApp->feedUpdateLock()->tryLock()) {
-    qApp->showGuiMessage(tr("Cannot update all items"),
-                         tr("You cannot update all items because another critical operation is ongoing."),
-                         QSystemTrayIcon::Warning, qApp->mainFormWidget(), true);
+  // Only feeds which are not busy are updated, other
+  // feeds can be updated concurrently.
+  const QList<Feed*> locked_feeds = qApp->feedUpdateLock()->tryLockFeeds(feeds);
+
+  if (locked_feeds.isEmpty()) {
+    if (!feeds.isEmpty()) {
+      qApp->showGuiMessage(tr("Cannot update items"),
+                           tr("You cannot update selected items because they are already being updated or edited."),
+                           QSystemTrayIcon::Warning, qApp->mainFormWidget(), true);
+    }
+
     return;
   }
 
@@ -76,40 +84,37 @@ void FeedReader::updateFeeds(const QList<Feed*>& feeds) {
     connect(m_feedDownloader, &FeedDownloader::updateFinished, this, &FeedReader::feedUpdatesFinished);
     connect(m_feedDownloader, &FeedDownloader::updateProgress, this, &FeedReader::feedUpdatesProgress);
     connect(m_feedDownloader, &FeedDownloader::updateStarted, this, &FeedReader::feedUpdatesStarted);
-    connect(m_feedDownloader, &FeedDownloader::updateFinished, qApp->feedUpdateLock(), &Mutex::unlock);
+    connect(m_feedDownloader, &FeedDownloader::updateProgress, qApp->feedUpdateLock(), &UpdateLock::unlockFeed);
+    connect(m_feedDownloader, &FeedDownloader::updateFinished, qApp->feedUpdateLock(), &UpdateLock::unlockFeeds);
+
+    // Each updated feed gets its next auto-update planned.
+    connect(m_feedDownloader, &FeedDownloader::updateProgress, m_autoUpdateScheduler, &FeedUpdateScheduler::rescheduleFeed);
+    connect(m_feedDownloader, &FeedDownloader::updateFinished,
+            m_autoUpdateScheduler, &FeedUpdateScheduler::rescheduleUnfinishedFeeds);
   }
 
-  QMetaObject::invokeMethod(m_feedDownloader, "updateFeeds", Q_ARG(QList<Feed*>, feeds));
+  QMetaObject::invokeMethod(m_feedDownloader, "updateFeeds", Q_ARG(QList<Feed*>, locked_feeds));
 }
 
 void FeedReader::updateAutoUpdateStatus() {
   // Restore global intervals.
   // NOTE: Specific per-feed interval are left intact.
   m_globalAutoUpdateInitialInterval = qApp->settings()->value(GROUP(Feeds), SETTING(Feeds::AutoUpdateInterval)).toInt();
-  m_globalAutoUpdateRemainingInterval = m_globalAutoUpdateInitialInterval;
   m_globalAutoUpdateEnabled = qApp->settings()->value(GROUP(Feeds), SETTING(Feeds::AutoUpdateEnabled)).toBool();
   m_globalAutoUpdateOnlyUnfocused = qApp->settings()->value(GROUP(Feeds), SETTING(Feeds::AutoUpdateOnlyUnfocused)).toBool();
 
-  // Start global auto-update timer if it is not running yet.
-  // NOTE: The timer must run even if global auto-update
+  // NOTE: Scheduler runs even if global auto-update
   // is not enabled because user can still enable auto-update
   // for individual feeds.
-  if (!m_autoUpdateTimer->isActive()) {
-    m_autoUpdateTimer->setInterval(AUTO_UPDATE_INTERVAL);
-    m_autoUpdateTimer->start();
-    qDebug("Auto-update timer started with interval %d.", m_autoUpdateTimer->interval());
-  }
-  else {
-    qDebug("Auto-update timer is already running.");
-  }
+  m_autoUpdateScheduler->setGlobalAutoUpdate(m_globalAutoUpdateEnabled, m_globalAutoUpdateInitialInterval);
 }
 
 bool FeedReader::autoUpdateEnabled() const {
   return m_globalAutoUpdateEnabled;
 }
 
-int FeedReader::autoUpdateRemainingInterval() const {
-  return m_globalAutoUpdateRemainingInterval;
+int FeedReader::autoUpdateRemainingInterval(const Feed* feed) const {
+  return m_autoUpdateScheduler->remainingInterval(feed);
 }
 
 int FeedReader::autoUpdateInitialInterval() const {
@@ -144,36 +149,34 @@ MessagesModel* FeedReader::messagesModel() const {
   return m_messagesModel;
 }
 
-void FeedReader::executeNextAutoUpdate() {
+void FeedReader::executeNextAutoUpdate(const QList<Feed*>& feeds) {
   if (qApp->mainFormWidget()->isActiveWindow() && m_globalAutoUpdateOnlyUnfocused) {
-      qDebug("Delaying scheduled feed auto-update for one minute since window is focused and updates"
-             "while focused are disabled by the user.");
+    qDebug("Delaying scheduled feed auto-update for one minute since window is focused and updates"
+           "while focused are disabled by the user.");
 
-      // Cannot update, quit.
-      return;
+    // Cannot update, try later.
+    m_autoUpdateScheduler->postpone(feeds, AUTO_UPDATE_INTERVAL);
+    return;
   }
 
-  if (!qApp->feedUpdateLock()->tryLock()) {
-    qDebug("Delaying scheduled feed auto-updates for one minute due to another running update.");
+  // Busy feeds are skipped, other feeds are updated now.
+  QList<Feed*> feeds_for_update, busy_feeds;
 
-    // Cannot update, quit.
-    return;
+  foreach (Feed* feed, feeds) {
+    if (qApp->feedUpdateLock()->canUpdateFeed(feed)) {
+      feeds_for_update.append(feed);
+    }
+    else {
+      busy_feeds.append(feed);
+    }
   }
 
-  // If global auto-update is enabled and its interval counter reached zero,
-  // then we need to restore it.
-  if (m_globalAutoUpdateEnabled && --m_globalAutoUpdateRemainingInterval < 0) {
-    // We should start next auto-update interval.
-    m_globalAutoUpdateRemainingInterval = m_globalAutoUpdateInitialInterval;
+  if (!busy_feeds.isEmpty()) {
+    qDebug("Delaying scheduled auto-update of %d busy feeds.", busy_feeds.size());
+    m_autoUpdateScheduler->postpone(busy_feeds, FEED_SCHEDULER_BLOCKED_DELAY);
   }
 
-  qDebug("Starting auto-update event, pass %d/%d.", m_globalAutoUpdateRemainingInterval, m_globalAutoUpdateInitialInterval);
-
-  // Pass needed interval data and lets the model decide which feeds
-  // should be updated in this pass.
-  QList<Feed*> feeds_for_update = m_feedsModel->feedsForScheduledUpdate(m_globalAutoUpdateEnabled &&
-                                                                        m_globalAutoUpdateRemainingInterval == 0);
-  qApp->feedUpdateLock()->unlock();
+  qDebug("Starting auto-update event for %d feeds.", feeds_for_update.size());
 
   if (!feeds_for_update.isEmpty()) {
     // Request update for given feeds.
@@ -210,9 +213,8 @@ void FeedReader::asyncCacheSaveFinished() {
 }
 
 void FeedReader::quit() {
-  if (m_autoUpdateTimer->isActive()) {
-    m_autoUpdateTimer->stop();
-  }
+  // Scheduler is not needed anymore.
+  m_autoUpdateScheduler->blockSignals(true);
 
   // Stop running updates.
   if (m_feedDownloader != nullptr) {
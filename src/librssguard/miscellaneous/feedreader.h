@@ -11,11 +11,11 @@
 #include <QFutureWatcher>
 
 class FeedsModel;
+class FeedUpdateScheduler;
 class MessagesModel;
 class MessagesProxyModel;
 class FeedsProxyModel;
 class ServiceEntryPoint;
-class QTimer;
 
 class RSSGUARD_DLLSPEC FeedReader : public QObject {
   Q_OBJECT
@@ -41,14 +41,15 @@ class RSSGUARD_DLLSPEC FeedReader : public QObject {
     // True if feed update is running right now.
     bool isFeedUpdateRunning() const;
 
-    // Resets global auto-update intervals according to settings
-    // and starts/stop the timer as needed.
+    // Passes global auto-update settings to scheduler.
     void updateAutoUpdateStatus();
 
     bool autoUpdateEnabled() const;
-    int autoUpdateRemainingInterval() const;
     int autoUpdateInitialInterval() const;
 
+    // Returns number of minutes remaining to next auto-update of the feed.
+    int autoUpdateRemainingInterval(const Feed* feed) const;
+
   public slots:
 
     // Schedules all feeds from all accounts for update.
@@ -58,8 +59,8 @@ class RSSGUARD_DLLSPEC FeedReader : public QObject {
 
   private slots:
 
-    // Is executed when next auto-update round could be done.
-    void executeNextAutoUpdate();
+    // Is executed when scheduler decides that some feeds should be updated.
+    void executeNextAutoUpdate(const QList<Feed*>& feeds);
     void checkServicesForAsyncOperations();
     void asyncCacheSaveFinished();
 
@@ -77,11 +78,10 @@ class RSSGUARD_DLLSPEC FeedReader : public QObject {
     MessagesProxyModel* m_messagesProxyModel;
 
     // Auto-update stuff.
-    QTimer* m_autoUpdateTimer;
+    FeedUpdateScheduler* m_autoUpdateScheduler;
     bool m_globalAutoUpdateEnabled{};
     bool m_globalAutoUpdateOnlyUnfocused{};
     int m_globalAutoUpdateInitialInterval{};
-    int m_globalAutoUpdateRemainingInterval{};
     FeedDownloader* m_feedDownloader;
 };
 
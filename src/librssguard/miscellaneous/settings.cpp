@@ -31,6 +31,10 @@ DKEY Feeds::UpdateTimeout = "feed_update_timeout";
 
 DVALUE(int) Feeds::UpdateTimeoutDef = DOWNLOAD_TIMEOUT;
 
+DKEY Feeds::UpdateBandwidthLimit = "feed_update_bandwidth_limit";
+
+DVALUE(int) Feeds::UpdateBandwidthLimitDef = 0;
+
 DKEY Feeds::EnableAutoUpdateNotification = "enable_auto_update_notification";
 
 DVALUE(bool) Feeds::EnableAutoUpdateNotificationDef = true;
@@ -297,6 +301,14 @@ DKEY Database::UseInMemory = "use_in_memory_db";
 
 DVALUE(bool) Database::UseInMemoryDef = false;
 
+DKEY Database::UseWal = "use_wal";
+
+DVALUE(bool) Database::UseWalDef = false;
+
+DKEY Database::CompressContents = "compress_contents";
+
+DVALUE(bool) Database::CompressContentsDef = false;
+
 DKEY Database::MySQLHostname = "mysql_hostname";
 
 DVALUE(QString) Database::MySQLHostnameDef = QString();
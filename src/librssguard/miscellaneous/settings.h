@@ -52,6 +52,10 @@ namespace Feeds {
 
   VALUE(int) UpdateTimeoutDef;
 
+  KEY UpdateBandwidthLimit;
+
+  VALUE(int) UpdateBandwidthLimitDef;
+
   KEY EnableAutoUpdateNotification;
 
   VALUE(bool) EnableAutoUpdateNotificationDef;
@@ -328,6 +332,14 @@ namespace Database {
 
   VALUE(bool) UseInMemoryDef;
 
+  KEY UseWal;
+
+  VALUE(bool) UseWalDef;
+
+  KEY CompressContents;
+
+  VALUE(bool) CompressContentsDef;
+
   KEY MySQLHostname;
 
   VALUE(QString) MySQLHostnameDef;
@@ -123,6 +123,20 @@ QString TextFactory::shorten(const QString& input, int text_length_limit) {
   }
 }
 
+quint64 TextFactory::hash64(const QString& input) {
+  quint64 hash = Q_UINT64_C(14695981039346656037);
+  const ushort* data = input.utf16();
+
+  for (int i = 0; i < input.size(); i++) {
+    hash ^= data[i] & 0xFF;
+    hash *= Q_UINT64_C(1099511628211);
+    hash ^= data[i] >> 8;
+    hash *= Q_UINT64_C(1099511628211);
+  }
+
+  return hash;
+}
+
 quint64 TextFactory::initializeSecretEncryptionKey() {
   if (s_encryptionKey == 0x0) {
     // Check if file with encryption key exists.
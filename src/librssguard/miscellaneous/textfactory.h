@@ -38,6 +38,10 @@ class TextFactory {
     // Shortens input string according to given length limit.
     static QString shorten(const QString& input, int text_length_limit = TEXT_TITLE_LIMIT);
 
+    // Calculates 64-bit FNV-1a hash of given string.
+    // NOTE: This is not cryptographic hash, it is used for fast comparisons only.
+    static quint64 hash64(const QString& input);
+
   private:
     static quint64 initializeSecretEncryptionKey();
     static quint64 generateSecretEncryptionKey();
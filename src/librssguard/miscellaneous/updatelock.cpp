@@ -0,0 +1,116 @@
+// For license of this file, see <project-root-folder>/LICENSE.md.
+
+#include "miscellaneous/updatelock.h"
+
+#include "services/abstract/feed.h"
+#include "services/abstract/serviceroot.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+
+UpdateLock::UpdateLock(QObject* parent) : QObject(parent), m_allLocked(false) {}
+
+UpdateLock::~UpdateLock() {
+  qDebug("Destroying UpdateLock instance.");
+}
+
+bool UpdateLock::canUpdateFeed(const Feed* feed) const {
+  return !m_allLocked && !m_updatedFeeds.contains(feed) && !m_editedAccounts.contains(feed->getParentServiceRoot());
+}
+
+QList<Feed*> UpdateLock::tryLockFeeds(const QList<Feed*>& feeds) {
+  QList<Feed*> locked_feeds;
+
+  foreach (Feed* feed, feeds) {
+    if (!canUpdateFeed(feed)) {
+      continue;
+    }
+
+    const ServiceRoot* account = feed->getParentServiceRoot();
+
+    m_updatedFeeds.insert(feed, account);
+    m_accountUpdates[account]++;
+    locked_feeds.append(feed);
+  }
+
+  if (locked_feeds.size() < feeds.size()) {
+    qDebug("%d feeds were not locked for update because they are busy.", feeds.size() - locked_feeds.size());
+  }
+
+  if (!locked_feeds.isEmpty()) {
+    emit lockChanged();
+  }
+
+  return locked_feeds;
+}
+
+bool UpdateLock::tryLockAccount(const ServiceRoot* account) {
+  if (m_allLocked || m_editedAccounts.contains(account) || m_accountUpdates.value(account) > 0) {
+    return false;
+  }
+
+  m_editedAccounts.insert(account);
+  emit lockChanged();
+  return true;
+}
+
+void UpdateLock::unlockAccount(const ServiceRoot* account) {
+  if (m_editedAccounts.remove(account)) {
+    emit lockChanged();
+  }
+}
+
+bool UpdateLock::tryLockAll(int timeout) {
+  QElapsedTimer tmr;
+
+  tmr.start();
+
+  // Running updates are finished in main thread, so
+  // events must be processed while waiting for them.
+  while (m_allLocked || !m_updatedFeeds.isEmpty() || !m_editedAccounts.isEmpty()) {
+    if (tmr.elapsed() >= timeout) {
+      return false;
+    }
+
+    QCoreApplication::processEvents(QEventLoop::AllEvents, 50);
+  }
+
+  m_allLocked = true;
+  emit lockChanged();
+  return true;
+}
+
+void UpdateLock::unlockAll() {
+  m_allLocked = false;
+  emit lockChanged();
+}
+
+bool UpdateLock::isAllLocked() const {
+  return m_allLocked;
+}
+
+bool UpdateLock::isAnythingLocked() const {
+  return m_allLocked || !m_updatedFeeds.isEmpty() || !m_editedAccounts.isEmpty();
+}
+
+void UpdateLock::unlockFeed(const Feed* feed) {
+  if (!m_updatedFeeds.contains(feed)) {
+    return;
+  }
+
+  const ServiceRoot* account = m_updatedFeeds.take(feed);
+
+  if (--m_accountUpdates[account] <= 0) {
+    m_accountUpdates.remove(account);
+  }
+
+  emit lockChanged();
+}
+
+void UpdateLock::unlockFeeds() {
+  if (!m_updatedFeeds.isEmpty()) {
+    m_updatedFeeds.clear();
+    m_accountUpdates.clear();
+    emit lockChanged();
+  }
+}
@@ -0,0 +1,72 @@
+// For license of this file, see <project-root-folder>/LICENSE.md.
+
+#ifndef UPDATELOCK_H
+#define UPDATELOCK_H
+
+#include <QObject>
+
+#include <QHash>
+#include <QList>
+#include <QSet>
+
+class Feed;
+class ServiceRoot;
+
+// Guards feeds and accounts against conflicting operations.
+//
+// Each feed which is being updated is locked alone and it holds
+// shared lock of its account, so several feeds and several accounts
+// can be updated at once. Editing of items of an account locks
+// the account exclusively, so it waits for updates of the account
+// to finish and prevents new ones. Application-wide operations
+// like database cleanup or quitting lock everything exclusively.
+// NOTE: This class is used from main thread only.
+class UpdateLock : public QObject {
+  Q_OBJECT
+
+  public:
+    explicit UpdateLock(QObject* parent = nullptr);
+    virtual ~UpdateLock();
+
+    // Returns true if the feed can be locked for update right now.
+    bool canUpdateFeed(const Feed* feed) const;
+
+    // Locks given feeds for update and returns those of them which
+    // were locked. Feeds which are already being updated or whose
+    // accounts are being edited are left out.
+    QList<Feed*> tryLockFeeds(const QList<Feed*>& feeds);
+
+    // Locks the account for editing of its items.
+    bool tryLockAccount(const ServiceRoot* account);
+    void unlockAccount(const ServiceRoot* account);
+
+    // Locks everything, running operations are given at
+    // most "timeout" ms to finish.
+    bool tryLockAll(int timeout = 0);
+    void unlockAll();
+
+    // Returns true if application-wide operation is running.
+    bool isAllLocked() const;
+
+    // Returns true if any feed is updated or any item is edited.
+    bool isAnythingLocked() const;
+
+  public slots:
+
+    // Unlocks feed whose update finished.
+    void unlockFeed(const Feed* feed);
+
+    // Unlocks all feeds locked for update.
+    void unlockFeeds();
+
+  signals:
+    void lockChanged();
+
+  private:
+    QHash<const Feed*, const ServiceRoot*> m_updatedFeeds;
+    QHash<const ServiceRoot*, int> m_accountUpdates;
+    QSet<const ServiceRoot*> m_editedAccounts;
+    bool m_allLocked;
+};
+
+#endif // UPDATELOCK_H
@@ -60,6 +60,9 @@ QNetworkReply* BaseNetworkAccessManager::createRequest(QNetworkAccessManager::Op
   // NOTE: https://en.wikipedia.org/wiki/HTTP_pipelining
   new_request.setAttribute(QNetworkRequest::HttpPipeliningAllowedAttribute, true);
 
+  // Many requests can be multiplexed over single connection if server supports HTTP/2.
+  new_request.setAttribute(QNetworkRequest::HTTP2AllowedAttribute, true);
+
   // Setup custom user-agent.
   new_request.setRawHeader(HTTP_HEADERS_USER_AGENT, QString(APP_USERAGENT).toLocal8Bit());
   return QNetworkAccessManager::createRequest(op, new_request, outgoingData);
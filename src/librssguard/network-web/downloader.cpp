@@ -10,16 +10,24 @@
 #include <QTimer>
 
 Downloader::Downloader(QObject* parent)
-  : QObject(parent), m_activeReply(nullptr), m_downloadManager(new SilentNetworkAccessManager(this)),
+  : QObject(parent), m_activeReply(nullptr), m_downloadManager(SilentNetworkAccessManager::threadInstance()),
   m_timer(new QTimer(this)), m_inputData(QByteArray()),
   m_inputMultipartData(nullptr), m_targetProtected(false), m_targetUsername(QString()), m_targetPassword(QString()),
-  m_lastOutputData(QByteArray()), m_lastOutputError(QNetworkReply::NoError) {
+  m_lastOutputData(QByteArray()), m_lastOutputError(QNetworkReply::NoError), m_lastHttpStatusCode(0) {
   m_timer->setInterval(DOWNLOAD_TIMEOUT);
   m_timer->setSingleShot(true);
   connect(m_timer, &QTimer::timeout, this, &Downloader::cancel);
 }
 
-Downloader::~Downloader() = default;
+Downloader::~Downloader() {
+  // Network manager is shared, so we must make sure that
+  // our unfinished reply does not outlive us.
+  if (m_activeReply != nullptr) {
+    disconnect(m_activeReply, nullptr, this, nullptr);
+    m_activeReply->abort();
+    m_activeReply->deleteLater();
+  }
+}
 
 void Downloader::downloadFile(const QString& url, int timeout, bool protected_contents, const QString& username,
                               const QString& password) {
@@ -152,6 +160,8 @@ void Downloader::finished() {
 
     m_lastContentType = reply->header(QNetworkRequest::ContentTypeHeader);
     m_lastOutputError = reply->error();
+    m_lastHttpStatusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    m_lastRawHeaders = reply->rawHeaderPairs();
     m_activeReply->deleteLater();
     m_activeReply = nullptr;
 
@@ -269,6 +279,20 @@ QVariant Downloader::lastContentType() const {
   return m_lastContentType;
 }
 
+int Downloader::lastHttpStatusCode() const {
+  return m_lastHttpStatusCode;
+}
+
+QByteArray Downloader::lastRawHeader(const QByteArray& name) const {
+  foreach (const QNetworkReply::RawHeaderPair& header, m_lastRawHeaders) {
+    if (qstricmp(header.first.constData(), name.constData()) == 0) {
+      return header.second;
+    }
+  }
+
+  return QByteArray();
+}
+
 void Downloader::cancel() {
   if (m_activeReply != nullptr) {
     // Download action timed-out, too slow connection or target is not reachable.
@@ -282,6 +306,11 @@ void Downloader::appendRawHeader(const QByteArray& name, const QByteArray& value
   }
 }
 
+void Downloader::appendConditionalHeaders(const QString& etag, const QString& last_modified) {
+  appendRawHeader(HTTP_HEADERS_IF_NONE_MATCH, etag.toLatin1());
+  appendRawHeader(HTTP_HEADERS_IF_MOD_SINCE, last_modified.toLatin1());
+}
+
 QNetworkReply::NetworkError Downloader::lastOutputError() const {
   return m_lastOutputError;
 }
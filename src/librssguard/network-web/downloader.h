@@ -29,12 +29,20 @@ class Downloader : public QObject {
     QNetworkReply::NetworkError lastOutputError() const;
     QList<HttpResponse> lastOutputMultipartData() const;
     QVariant lastContentType() const;
+    int lastHttpStatusCode() const;
+
+    // Returns value of given header of last received reply.
+    QByteArray lastRawHeader(const QByteArray& name) const;
 
   public slots:
     void cancel();
 
     void appendRawHeader(const QByteArray& name, const QByteArray& value);
 
+    // Makes next request conditional, server then answers with
+    // HTTP_CODE_NOT_MODIFIED and without body if data did not change.
+    void appendConditionalHeaders(const QString& etag, const QString& last_modified);
+
     // Performs asynchronous download of given file. Redirections are handled.
     void downloadFile(const QString& url, int timeout = DOWNLOAD_TIMEOUT, bool protected_contents = false,
                       const QString& username = QString(), const QString& password = QString());
@@ -82,7 +90,7 @@ class Downloader : public QObject {
   private:
     QNetworkReply* m_activeReply;
 
-    QScopedPointer<SilentNetworkAccessManager> m_downloadManager;
+    SilentNetworkAccessManager* m_downloadManager;
     QTimer* m_timer;
 
     QHash<QByteArray, QByteArray> m_customHeaders;
@@ -99,6 +107,8 @@ class Downloader : public QObject {
 
     QNetworkReply::NetworkError m_lastOutputError;
     QVariant m_lastContentType;
+    int m_lastHttpStatusCode;
+    QList<QNetworkReply::RawHeaderPair> m_lastRawHeaders;
 };
 
 #endif // DOWNLOADER_H
@@ -4,6 +4,7 @@
 
 #include "definitions/definitions.h"
 #include "miscellaneous/settings.h"
+#include "miscellaneous/textfactory.h"
 #include "network-web/downloader.h"
 #include "network-web/silentnetworkaccessmanager.h"
 
@@ -55,6 +56,41 @@ QPair<QByteArray, QByteArray> NetworkFactory::generateBasicAuthHeader(const QStr
   }
 }
 
+int NetworkFactory::cacheControlMaxAge(const QByteArray& cache_control) {
+  int max_age = 0;
+
+  foreach (const QByteArray& directive, cache_control.split(',')) {
+    const QByteArray trimmed = directive.trimmed().toLower();
+
+    if (trimmed == "no-cache" || trimmed == "no-store") {
+      return 0;
+    }
+    else if (trimmed.startsWith("max-age=")) {
+      max_age = qMax(trimmed.mid(8).toInt(), 0);
+    }
+  }
+
+  return max_age;
+}
+
+QDateTime NetworkFactory::retryAfterTime(const QByteArray& retry_after) {
+  const QByteArray trimmed = retry_after.trimmed();
+
+  if (trimmed.isEmpty()) {
+    return QDateTime();
+  }
+
+  bool is_number;
+  const int seconds = trimmed.toInt(&is_number);
+
+  if (is_number) {
+    return seconds > 0 ? QDateTime::currentDateTimeUtc().addSecs(seconds) : QDateTime();
+  }
+  else {
+    return TextFactory::parseDateTime(QString::fromLatin1(trimmed));
+  }
+}
+
 QString NetworkFactory::networkErrorText(QNetworkReply::NetworkError error_code) {
   switch (error_code) {
     case QNetworkReply::ProtocolUnknownError:
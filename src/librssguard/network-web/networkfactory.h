@@ -6,6 +6,7 @@
 #include "network-web/httpresponse.h"
 
 #include <QCoreApplication>
+#include <QDateTime>
 #include <QHttpPart>
 #include <QNetworkReply>
 #include <QPair>
@@ -27,6 +28,15 @@ class NetworkFactory {
     static QStringList extractFeedLinksFromHtmlPage(const QUrl& url, const QString& html);
     static QPair<QByteArray, QByteArray> generateBasicAuthHeader(const QString& username, const QString& password);
 
+    // Returns "max-age" of "Cache-Control" header value in seconds
+    // or zero if caching is not allowed or not specified.
+    static int cacheControlMaxAge(const QByteArray& cache_control);
+
+    // Returns time before which server should not be contacted again
+    // according to "Retry-After" header value, which is either number
+    // of seconds or HTTP date. Returns null date if header is invalid.
+    static QDateTime retryAfterTime(const QByteArray& retry_after);
+
     // Returns human readable text for given network error.
     static QString networkErrorText(QNetworkReply::NetworkError error_code);
 
@@ -5,14 +5,27 @@
 #include "miscellaneous/application.h"
 
 #include <QAuthenticator>
+#include <QDebug>
+#include <QMutexLocker>
 #include <QNetworkReply>
+#include <QThread>
+#include <QThreadStorage>
 
 Q_GLOBAL_STATIC(SilentNetworkAccessManager, qz_silent_acmanager)
 
+QAtomicInt SilentNetworkAccessManager::s_requestsServed;
+QAtomicInt SilentNetworkAccessManager::s_connectionsOpened;
+QMutex SilentNetworkAccessManager::s_sharedInstancesMutex;
+QList<QPointer<SilentNetworkAccessManager>> SilentNetworkAccessManager::s_sharedInstances;
+
 SilentNetworkAccessManager::SilentNetworkAccessManager(QObject* parent)
   : BaseNetworkAccessManager(parent) {
   connect(this, &SilentNetworkAccessManager::authenticationRequired,
           this, &SilentNetworkAccessManager::onAuthenticationRequired, Qt::DirectConnection);
+  connect(this, &SilentNetworkAccessManager::encrypted, this, [](QNetworkReply* reply) {
+    Q_UNUSED(reply)
+    s_connectionsOpened.ref();
+  }, Qt::DirectConnection);
 }
 
 SilentNetworkAccessManager::~SilentNetworkAccessManager() {
@@ -23,6 +36,57 @@ SilentNetworkAccessManager* SilentNetworkAccessManager::instance() {
   return qz_silent_acmanager();
 }
 
+SilentNetworkAccessManager* SilentNetworkAccessManager::threadInstance() {
+  static QThreadStorage<SilentNetworkAccessManager*> thread_instances;
+
+  if (QThread::currentThread() == qApp->thread()) {
+    return instance();
+  }
+
+  if (!thread_instances.hasLocalData()) {
+    auto* manager = new SilentNetworkAccessManager();
+
+    qDebug().nospace() << "Creating shared network manager for thread: \'" << QThread::currentThreadId() << "\'.";
+    thread_instances.setLocalData(manager);
+
+    QMutexLocker locker(&s_sharedInstancesMutex);
+    s_sharedInstances.append(manager);
+  }
+
+  return thread_instances.localData();
+}
+
+void SilentNetworkAccessManager::loadSettingsOfSharedInstances() {
+  instance()->loadSettings();
+
+  QMutexLocker locker(&s_sharedInstancesMutex);
+
+  for (int i = s_sharedInstances.size() - 1; i >= 0; i--) {
+    if (s_sharedInstances.at(i).isNull()) {
+      s_sharedInstances.removeAt(i);
+    }
+    else {
+      // Manager must be reconfigured in its own thread.
+      QMetaObject::invokeMethod(s_sharedInstances.at(i).data(), "loadSettings", Qt::QueuedConnection);
+    }
+  }
+}
+
+int SilentNetworkAccessManager::requestsServed() {
+  return s_requestsServed.load();
+}
+
+int SilentNetworkAccessManager::connectionsOpened() {
+  return s_connectionsOpened.load();
+}
+
+QNetworkReply* SilentNetworkAccessManager::createRequest(QNetworkAccessManager::Operation op,
+                                                         const QNetworkRequest& request,
+                                                         QIODevice* outgoingData) {
+  s_requestsServed.ref();
+  return BaseNetworkAccessManager::createRequest(op, request, outgoingData);
+}
+
 void SilentNetworkAccessManager::onAuthenticationRequired(QNetworkReply* reply, QAuthenticator* authenticator) {
   if (reply->property("protected").toBool()) {
     // This feed contains authentication information, it is good.
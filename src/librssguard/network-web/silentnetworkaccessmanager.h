@@ -5,6 +5,8 @@
 
 #include "network-web/basenetworkaccessmanager.h"
 
+#include <QAtomicInt>
+#include <QMutex>
 #include <QPointer>
 
 // Network manager used for more communication for feeds.
@@ -21,10 +23,34 @@ class SilentNetworkAccessManager : public BaseNetworkAccessManager {
     // Returns pointer to global silent network manager
     static SilentNetworkAccessManager* instance();
 
+    // Returns pointer to silent network manager shared by all
+    // downloaders of the calling thread. This allows to reuse
+    // connections (and HTTP/2 sessions) between requests to the same origin.
+    // NOTE: Instance is destroyed when calling thread finishes.
+    static SilentNetworkAccessManager* threadInstance();
+
+    // Reloads settings of all shared instances.
+    static void loadSettingsOfSharedInstances();
+
+    // Statistics of shared connection pools. New connection is counted
+    // each time TLS handshake is performed, reused connections do not
+    // perform it. Plain HTTP connections are not visible to us.
+    static int requestsServed();
+    static int connectionsOpened();
+
   public slots:
 
     // This cannot do any GUI stuff.
     void onAuthenticationRequired(QNetworkReply* reply, QAuthenticator* authenticator);
+
+  protected:
+    QNetworkReply* createRequest(Operation op, const QNetworkRequest& request, QIODevice* outgoingData);
+
+  private:
+    static QAtomicInt s_requestsServed;
+    static QAtomicInt s_connectionsOpened;
+    static QMutex s_sharedInstancesMutex;
+    static QList<QPointer<SilentNetworkAccessManager>> s_sharedInstances;
 };
 
 #endif // SILENTNETWORKACCESSMANAGER_H
@@ -16,6 +16,7 @@ Category::Category(RootItem* parent) : RootItem(parent) {
 
 Category::Category(const Category& other) : RootItem(other) {
   setKind(RootItemKind::Category);
+  setRetentionPolicy(other.retentionPolicy());
 }
 
 Category::Category(const QSqlRecord& record) : Category(nullptr) {
@@ -30,10 +31,25 @@ Category::Category(const QSqlRecord& record) : Category(nullptr) {
   setDescription(record.value(CAT_DB_DESCRIPTION_INDEX).toString());
   setCreationDate(TextFactory::parseDateTime(record.value(CAT_DB_DCREATED_INDEX).value<qint64>()).toLocalTime());
   setIcon(qApp->icons()->fromByteArray(record.value(CAT_DB_ICON_INDEX).toByteArray()));
+
+  Feed::RetentionPolicy policy;
+
+  policy.m_keepCount = record.value(CAT_DB_RETENTION_COUNT_INDEX).toInt();
+  policy.m_maxAgeDays = record.value(CAT_DB_RETENTION_DAYS_INDEX).toInt();
+  policy.m_keepImportant = record.value(CAT_DB_RETENTION_KEEP_IMPORTANT_INDEX).toBool();
+  setRetentionPolicy(policy);
 }
 
 Category::~Category() = default;
 
+Feed::RetentionPolicy Category::retentionPolicy() const {
+  return m_retentionPolicy;
+}
+
+void Category::setRetentionPolicy(const Feed::RetentionPolicy& policy) {
+  m_retentionPolicy = policy;
+}
+
 void Category::updateCounts(bool including_total_count) {
   QList<Feed*> feeds;
 
@@ -5,6 +5,8 @@
 
 #include "services/abstract/rootitem.h"
 
+#include "services/abstract/feed.h"
+
 class Category : public RootItem {
   Q_OBJECT
 
@@ -17,6 +19,14 @@ class Category : public RootItem {
     void updateCounts(bool including_total_count);
     bool cleanMessages(bool clean_read_only);
     bool markAsReadUnread(ReadStatus status);
+
+    // Retention policy of category is used by all feeds
+    // in the category which do not have their own policy.
+    Feed::RetentionPolicy retentionPolicy() const;
+    void setRetentionPolicy(const Feed::RetentionPolicy& policy);
+
+  private:
+    Feed::RetentionPolicy m_retentionPolicy;
 };
 
 #endif // CATEGORY_H
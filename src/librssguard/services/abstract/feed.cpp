@@ -10,14 +10,17 @@
 #include "miscellaneous/mutex.h"
 #include "miscellaneous/textfactory.h"
 #include "services/abstract/cacheforserviceroot.h"
+#include "services/abstract/category.h"
 #include "services/abstract/recyclebin.h"
 #include "services/abstract/serviceroot.h"
 
 #include <QThread>
 
+#include <algorithm>
+
 Feed::Feed(RootItem* parent)
   : RootItem(parent), m_url(QString()), m_status(Normal), m_autoUpdateType(DefaultAutoUpdate),
-  m_autoUpdateInitialInterval(DEFAULT_AUTO_UPDATE_INTERVAL), m_autoUpdateRemainingInterval(DEFAULT_AUTO_UPDATE_INTERVAL) {
+  m_autoUpdateInitialInterval(DEFAULT_AUTO_UPDATE_INTERVAL) {
   setKind(RootItemKind::Feed);
   setAutoDelete(false);
 }
@@ -37,6 +40,14 @@ Feed::Feed(const QSqlRecord& record) : Feed(nullptr) {
   setIcon(qApp->icons()->fromByteArray(record.value(FDS_DB_ICON_INDEX).toByteArray()));
   setAutoUpdateType(static_cast<Feed::AutoUpdateType>(record.value(FDS_DB_UPDATE_TYPE_INDEX).toInt()));
   setAutoUpdateInitialInterval(record.value(FDS_DB_UPDATE_INTERVAL_INDEX).toInt());
+  setHttpValidators(record.value(FDS_DB_HTTP_ETAG_INDEX).toString(), record.value(FDS_DB_HTTP_LAST_MOD_INDEX).toString());
+
+  RetentionPolicy policy;
+
+  policy.m_keepCount = record.value(FDS_DB_RETENTION_COUNT_INDEX).toInt();
+  policy.m_maxAgeDays = record.value(FDS_DB_RETENTION_DAYS_INDEX).toInt();
+  policy.m_keepImportant = record.value(FDS_DB_RETENTION_KEEP_IMPORTANT_INDEX).toBool();
+  setRetentionPolicy(policy);
 
   qDebug("Custom ID of feed when loading from DB is '%s'.", qPrintable(customId()));
 }
@@ -51,7 +62,9 @@ Feed::Feed(const Feed& other) : RootItem(other) {
   setStatus(other.status());
   setAutoUpdateType(other.autoUpdateType());
   setAutoUpdateInitialInterval(other.autoUpdateInitialInterval());
-  setAutoUpdateRemainingInterval(other.autoUpdateRemainingInterval());
+  setUpdateHints(other.updateHints());
+  setRetentionPolicy(other.retentionPolicy());
+  setHttpValidators(other.httpETag(), other.httpLastModified());
 }
 
 Feed::~Feed() = default;
@@ -109,10 +122,7 @@ void Feed::setCountOfUnreadMessages(int count_unread_messages) {
 }
 
 void Feed::setAutoUpdateInitialInterval(int auto_update_interval) {
-  // If new initial auto-update interval is set, then
-  // we should reset time that remains to the next auto-update.
   m_autoUpdateInitialInterval = auto_update_interval;
-  m_autoUpdateRemainingInterval = auto_update_interval;
 }
 
 Feed::AutoUpdateType Feed::autoUpdateType() const {
@@ -123,12 +133,45 @@ void Feed::setAutoUpdateType(Feed::AutoUpdateType auto_update_type) {
   m_autoUpdateType = auto_update_type;
 }
 
-int Feed::autoUpdateRemainingInterval() const {
-  return m_autoUpdateRemainingInterval;
+Feed::UpdateHints Feed::updateHints() const {
+  return m_updateHints;
+}
+
+void Feed::setUpdateHints(const UpdateHints& hints) {
+  m_updateHints = hints;
+}
+
+void Feed::applyObtainedHints(const ObtainedHints& hints) {
+  if (hints.m_feedInterval >= 0) {
+    m_updateHints.m_feedInterval = hints.m_feedInterval;
+    m_updateHints.m_skipHours = hints.m_skipHours;
+  }
+
+  if (hints.m_publishInterval > 0) {
+    m_updateHints.m_publishInterval = hints.m_publishInterval;
+  }
+}
+
+Feed::RetentionPolicy Feed::retentionPolicy() const {
+  return m_retentionPolicy;
 }
 
-void Feed::setAutoUpdateRemainingInterval(int auto_update_remaining_interval) {
-  m_autoUpdateRemainingInterval = auto_update_remaining_interval;
+void Feed::setRetentionPolicy(const RetentionPolicy& policy) {
+  m_retentionPolicy = policy;
+}
+
+Feed::RetentionPolicy Feed::effectiveRetentionPolicy() const {
+  if (m_retentionPolicy.isActive()) {
+    return m_retentionPolicy;
+  }
+
+  for (RootItem* item = parent(); item != nullptr && item->kind() == RootItemKind::Category; item = item->parent()) {
+    if (item->toCategory()->retentionPolicy().isActive()) {
+      return item->toCategory()->retentionPolicy();
+    }
+  }
+
+  return m_retentionPolicy;
 }
 
 Feed::Status Feed::status() const {
@@ -147,18 +190,22 @@ void Feed::setUrl(const QString& url) {
   m_url = url;
 }
 
-void Feed::updateCounts(bool including_total_count) {
-  bool is_main_thread = QThread::currentThread() == qApp->thread();
-  QSqlDatabase database = is_main_thread ?
-                          qApp->database()->connection(metaObject()->className()) :
-                          qApp->database()->connection(QSL("feed_upd"));
-  int account_id = getParentServiceRoot()->accountId();
-
-  if (including_total_count) {
-    setCountOfAllMessages(DatabaseQueries::getMessageCountsForFeed(database, customId(), account_id, true));
-  }
+QString Feed::httpETag() const {
+  return m_httpETag;
+}
 
-  setCountOfUnreadMessages(DatabaseQueries::getMessageCountsForFeed(database, customId(), account_id, false));
+QString Feed::httpLastModified() const {
+  return m_httpLastModified;
+}
+
+void Feed::setHttpValidators(const QString& etag, const QString& last_modified) {
+  m_httpETag = etag;
+  m_httpLastModified = last_modified;
+}
+
+void Feed::updateCounts(bool including_total_count) {
+  // Both counts are obtained by single query.
+  getParentServiceRoot()->updateFeedCounts(QList<Feed*>() << this, including_total_count);
 }
 
 void Feed::run() {
@@ -174,86 +221,160 @@ void Feed::run() {
                      << customId() << " URL: " << url() << " title: " << title() << " in thread: \'"
                      << QThread::currentThreadId() << "\'.";
 
-  // Now, do some general operations on messages (tweak encoding etc.).
-  for (auto& msg : msgs) {
-    // Also, make sure that HTML encoding, encoding of special characters, etc., is fixed.
-    msg.m_contents = QUrl::fromPercentEncoding(msg.m_contents.toUtf8());
-    msg.m_author = msg.m_author.toUtf8();
+  sanitizeMessages(msgs);
 
-    // Sanitize title. Remove newlines etc.
-    msg.m_title = QUrl::fromPercentEncoding(msg.m_title.toUtf8())
+  ObtainedHints hints;
 
-                  // Replace all continuous white space.
-                  .replace(QRegularExpression(QSL("[\\s]{2,}")), QSL(" "))
+  hints.m_publishInterval = publishInterval(msgs);
+  emit messagesObtained(msgs, error_during_obtaining, hints);
+}
 
-                  // Remove all newlines and leading white space.
-                  .remove(QRegularExpression(QSL("([\\n\\r])|(^\\s)")));
-  }
+bool Feed::supportsAsynchronousUpdate() const {
+  return false;
+}
 
-  emit messagesObtained(msgs, error_during_obtaining);
+Downloader* Feed::startAsynchronousUpdate() {
+  return nullptr;
 }
 
-bool Feed::cleanMessages(bool clean_read_only) {
-  return getParentServiceRoot()->cleanFeeds(QList<Feed*>() << this, clean_read_only);
+QList<Message> Feed::messagesFromDownloadedData(QNetworkReply::NetworkError network_error, const QByteArray& data,
+                                                const QString& content_type, bool* error_during_obtaining,
+                                                ObtainedHints* hints) {
+  qDebug().nospace() << "Parsing downloaded data for feed ID "
+                     << customId() << " URL: " << url() << " title: " << title() << " in thread: \'"
+                     << QThread::currentThreadId() << "\'.";
+
+  QList<Message> msgs = parseDownloadedData(network_error, data, content_type, error_during_obtaining, hints);
+
+  sanitizeMessages(msgs);
+  hints->m_publishInterval = publishInterval(msgs);
+  return msgs;
 }
 
-bool Feed::markAsReadUnread(RootItem::ReadStatus status) {
-  ServiceRoot* service = getParentServiceRoot();
-  auto* cache = dynamic_cast<CacheForServiceRoot*>(service);
+QList<Message> Feed::parseDownloadedData(QNetworkReply::NetworkError network_error, const QByteArray& data,
+                                         const QString& content_type, bool* error_during_obtaining,
+                                         ObtainedHints* hints) {
+  Q_UNUSED(network_error)
+  Q_UNUSED(data)
+  Q_UNUSED(content_type)
+  Q_UNUSED(hints)
 
-  if (cache != nullptr) {
-    cache->addMessageStatesToCache(service->customIDSOfMessagesForItem(this), status);
-  }
+  *error_during_obtaining = true;
+  return QList<Message>();
+}
 
-  return service->markFeedsReadUnread(QList<Feed*>() << this, status);
+void Feed::sanitizeMessages(QList<Message>& messages) const {
+  // Now, do some general operations on messages (tweak encoding etc.).
+  for (auto& msg : messages) {
+    // Also, make sure that encoding of special characters is fixed.
+    // Texts without any percent-encoded characters are not touched at all.
+    if (msg.m_contents.contains(QL1C('%'))) {
+      msg.m_contents = QUrl::fromPercentEncoding(msg.m_contents.toUtf8());
+    }
+
+    if (msg.m_title.contains(QL1C('%'))) {
+      msg.m_title = QUrl::fromPercentEncoding(msg.m_title.toUtf8());
+    }
+
+    // Sanitize title. Remove newlines etc.
+    msg.m_title = normalizedTitle(msg.m_title);
+    msg.computeHashes();
+  }
 }
 
-int Feed::updateMessages(const QList<Message>& messages, bool error_during_obtaining) {
-  QList<RootItem*> items_to_update;
-  int updated_messages = 0;
+int Feed::publishInterval(const QList<Message>& messages) {
+  QList<qint64> dates;
+
+  for (const Message& message : messages) {
+    if (message.m_createdFromFeed) {
+      dates.append(message.m_created.toMSecsSinceEpoch() / 1000);
+    }
+  }
 
-  if (!error_during_obtaining) {
-    bool is_main_thread = QThread::currentThread() == qApp->thread();
+  if (dates.size() < FEED_SCHEDULER_MIN_SAMPLES) {
+    // There is not enough data to say anything.
+    return -1;
+  }
 
-    qDebug("Updating messages in DB. Main thread: '%s'.", qPrintable(is_main_thread ? "true" : "false"));
+  std::sort(dates.begin(), dates.end());
 
-    bool anything_updated = false;
-    bool ok = true;
+  QList<qint64> gaps;
 
-    if (!messages.isEmpty()) {
-      qDebug("There are some messages to be updated/added to DB.");
+  for (int i = 1; i < dates.size(); i++) {
+    if (dates.at(i) > dates.at(i - 1)) {
+      gaps.append(dates.at(i) - dates.at(i - 1));
+    }
+  }
 
-      QString custom_id = customId();
-      int account_id = getParentServiceRoot()->accountId();
-      QSqlDatabase database = is_main_thread ?
-                              qApp->database()->connection(metaObject()->className()) :
-                              qApp->database()->connection(QSL("feed_upd"));
+  if (gaps.isEmpty()) {
+    return -1;
+  }
 
-      updated_messages = DatabaseQueries::updateMessages(database, messages, custom_id, account_id, url(), &anything_updated, &ok);
+  std::nth_element(gaps.begin(), gaps.begin() + gaps.size() / 2, gaps.end());
+  return int(qMin(gaps.at(gaps.size() / 2), qint64(FEED_SCHEDULER_MAX_INTERVAL)));
+}
+
+QString Feed::normalizedTitle(const QString& title) {
+  // Continuous white space is replaced with single space, then
+  // all newlines and leading white space are removed.
+  const int length = title.size();
+  const QChar* data = title.constData();
+  QString normalized;
+  bool changed = false;
+
+  for (int i = 0; i < length; i++) {
+    if (!data[i].isSpace()) {
+      if (changed) {
+        normalized.append(data[i]);
+      }
+
+      continue;
     }
-    else {
-      qWarning("There are no messages for update.");
+
+    int run_end = i + 1;
+
+    while (run_end < length && data[run_end].isSpace()) {
+      run_end++;
     }
 
-    if (ok) {
-      setStatus(updated_messages > 0 ? NewMessages : Normal);
-      updateCounts(true);
+    const bool keep = i > 0 && run_end - i == 1 && data[i] != QL1C('\n') && data[i] != QL1C('\r');
+    const bool collapse = i > 0 && run_end - i > 1;
+
+    if (!changed && (collapse || !keep)) {
+      // Title needs to be changed, copy its unchanged part.
+      normalized.reserve(length);
+      normalized.append(data, i);
+      changed = true;
+    }
 
-      if (getParentServiceRoot()->recycleBin() != nullptr && anything_updated) {
-        getParentServiceRoot()->recycleBin()->updateCounts(true);
-        items_to_update.append(getParentServiceRoot()->recycleBin());
+    if (changed) {
+      if (collapse) {
+        normalized.append(QL1C(' '));
+      }
+      else if (keep) {
+        normalized.append(data[i]);
       }
     }
-  }
-  else {
-    qCritical("There is indication that there was error during messages obtaining.");
+
+    i = run_end - 1;
   }
 
-  // Some messages were really added to DB, reload feed in model.
-  items_to_update.append(this);
-  getParentServiceRoot()->itemChanged(items_to_update);
+  return changed ? normalized : title;
+}
 
-  return updated_messages;
+bool Feed::cleanMessages(bool clean_read_only) {
+  return getParentServiceRoot()->cleanFeeds(QList<Feed*>() << this, clean_read_only);
+}
+
+bool Feed::markAsReadUnread(RootItem::ReadStatus status) {
+  ServiceRoot* service = getParentServiceRoot();
+  auto* cache = dynamic_cast<CacheForServiceRoot*>(service);
+
+  if (cache != nullptr) {
+    cache->addMessageStatesToCache(service->customIDSOfMessagesForItem(this), status);
+  }
+
+  return service->markFeedsReadUnread(QList<Feed*>() << this, status);
 }
 
 QString Feed::getAutoUpdateStatusDescription() const {
@@ -271,14 +392,16 @@ QString Feed::getAutoUpdateStatusDescription() const {
       //: Describes feed auto-update status.
       auto_update_string = tr("uses global settings (%n minute(s) to next auto-update)",
                               nullptr,
-                              qApp->feedReader()->autoUpdateRemainingInterval());
+                              qApp->feedReader()->autoUpdateRemainingInterval(this));
       break;
 
     case SpecificAutoUpdate:
     default:
 
       //: Describes feed auto-update status.
-      auto_update_string = tr("uses specific settings (%n minute(s) to next auto-update)", nullptr, autoUpdateRemainingInterval());
+      auto_update_string = tr("uses specific settings (%n minute(s) to next auto-update)",
+                              nullptr,
+                              qApp->feedReader()->autoUpdateRemainingInterval(this));
       break;
   }
 
@@ -7,11 +7,16 @@
 
 #include "core/message.h"
 
+#include <QDateTime>
+#include <QNetworkReply>
 #include <QRunnable>
+#include <QSqlDatabase>
 #include <QVariant>
 
+class Downloader;
+
 // Base class for "feed" nodes.
-class Feed : public RootItem, public QRunnable {
+class RSSGUARD_DLLSPEC Feed : public RootItem, public QRunnable {
   Q_OBJECT
 
   public:
@@ -35,6 +40,56 @@ class Feed : public RootItem, public QRunnable {
       OtherError = 5
     };
 
+    // Information used to plan auto-updates of the feed. It is
+    // obtained from feed data, HTTP headers and results of updates.
+    struct UpdateHints {
+      // Interval in seconds requested by feed itself via "ttl" or "sy:updatePeriod".
+      int m_feedInterval = 0;
+
+      // Interval in seconds for which server allows to cache feed data.
+      int m_cacheInterval = 0;
+
+      // Server asked not to be contacted again sooner than this.
+      QDateTime m_retryAfter;
+
+      // Bit N is set if feed should not be updated during hour N (UTC).
+      quint32 m_skipHours = 0;
+
+      // Median interval in seconds between publishing of messages, zero if unknown.
+      int m_publishInterval = 0;
+
+      // Number of recent consecutive updates which did not bring any new or changed messages.
+      int m_idleUpdates = 0;
+    };
+
+    // Hints found in feed data when they are obtained in worker thread. Workers
+    // do not touch update hints nor status of the feed, these are applied in main thread.
+    // Negative intervals mean that data did not say anything.
+    struct ObtainedHints {
+      int m_feedInterval = -1;
+      quint32 m_skipHours = 0;
+      int m_publishInterval = -1;
+      QNetworkReply::NetworkError m_networkError = QNetworkReply::NoError;
+    };
+
+    // Says which messages of the feed are removed after each update of the feed.
+    // Zero values mean no limit.
+    struct RetentionPolicy {
+      // Number of newest messages which are kept. Starred messages
+      // are kept on top of them if "m_keepImportant" is set.
+      int m_keepCount = 0;
+
+      // Messages older than this number of days are removed.
+      int m_maxAgeDays = 0;
+
+      // Starred messages are never removed.
+      bool m_keepImportant = true;
+
+      bool isActive() const {
+        return m_keepCount > 0 || m_maxAgeDays > 0;
+      }
+    };
+
     // Constructors.
     explicit Feed(RootItem* parent = nullptr);
     explicit Feed(const QSqlRecord& record);
@@ -59,8 +114,21 @@ class Feed : public RootItem, public QRunnable {
     AutoUpdateType autoUpdateType() const;
     void setAutoUpdateType(AutoUpdateType auto_update_type);
 
-    int autoUpdateRemainingInterval() const;
-    void setAutoUpdateRemainingInterval(int auto_update_remaining_interval);
+    UpdateHints updateHints() const;
+    void setUpdateHints(const UpdateHints& hints);
+
+    // Merges hints obtained from feed data into update hints.
+    // NOTE: This must be called in main thread.
+    virtual void applyObtainedHints(const ObtainedHints& hints);
+
+    RetentionPolicy retentionPolicy() const;
+    void setRetentionPolicy(const RetentionPolicy& policy);
+
+    // Returns policy of this feed or policy of its nearest
+    // parent category if this feed does not have any.
+    // NOTE: Policy is applied by commit stage of FeedDownloader,
+    // after batch with messages of the feed is committed.
+    RetentionPolicy effectiveRetentionPolicy() const;
 
     Status status() const;
     void setStatus(const Status& status);
@@ -68,38 +136,76 @@ class Feed : public RootItem, public QRunnable {
     QString url() const;
     void setUrl(const QString& url);
 
+    // HTTP validators (ETag, Last-Modified) of last successfully
+    // downloaded feed data, these are used for conditional requests.
+    QString httpETag() const;
+    QString httpLastModified() const;
+    void setHttpValidators(const QString& etag, const QString& last_modified);
+
     // Runs update in thread (thread pooled).
     void run();
 
+    // Returns true if this feed is able to download its data
+    // without blocking, in that case startAsynchronousUpdate()
+    // is used instead of run().
+    virtual bool supportsAsynchronousUpdate() const;
+
+    // Starts non-blocking download of feed data and returns
+    // running downloader, which is owned by the caller.
+    virtual Downloader* startAsynchronousUpdate();
+
+    // Converts data obtained via startAsynchronousUpdate() into messages.
+    // NOTE: This is called in worker thread.
+    QList<Message> messagesFromDownloadedData(QNetworkReply::NetworkError network_error, const QByteArray& data,
+                                              const QString& content_type, bool* error_during_obtaining,
+                                              ObtainedHints* hints);
+
     bool markAsReadUnread(ReadStatus status);
     bool cleanMessages(bool clean_read_only);
 
+    // Collapses white space and removes newlines from title in single pass.
+    static QString normalizedTitle(const QString& title);
+
   public slots:
     void updateCounts(bool including_total_count);
-    int updateMessages(const QList<Message>& messages, bool error_during_obtaining);
 
   protected:
     QString getAutoUpdateStatusDescription() const;
     QString getStatusDescription() const;
 
   signals:
-    void messagesObtained(QList<Message> messages, bool error_during_obtaining);
+    void messagesObtained(QList<Message> messages, bool error_during_obtaining, Feed::ObtainedHints hints);
 
   private:
 
     // Performs synchronous obtaining of new messages for this feed.
     virtual QList<Message> obtainNewMessages(bool* error_during_obtaining) = 0;
 
+    // Parses data downloaded asynchronously.
+    virtual QList<Message> parseDownloadedData(QNetworkReply::NetworkError network_error, const QByteArray& data,
+                                               const QString& content_type, bool* error_during_obtaining,
+                                               ObtainedHints* hints);
+
+    // Performs general operations on obtained messages (tweaks encoding etc.).
+    void sanitizeMessages(QList<Message>& messages) const;
+
+    // Returns how often feed publishes new messages or -1 if it is not known.
+    static int publishInterval(const QList<Message>& messages);
+
   private:
     QString m_url;
+    QString m_httpETag;
+    QString m_httpLastModified;
     Status m_status;
     AutoUpdateType m_autoUpdateType;
     int m_autoUpdateInitialInterval{};
-    int m_autoUpdateRemainingInterval{};
+    UpdateHints m_updateHints;
+    RetentionPolicy m_retentionPolicy;
     int m_totalCount{};
     int m_unreadCount{};
 };
 
 Q_DECLARE_METATYPE(Feed::AutoUpdateType)
+Q_DECLARE_METATYPE(Feed::ObtainedHints)
 
 #endif // FEED_H
@@ -293,6 +293,9 @@ void FormFeedDetails::setEditableFeed(Feed* editable_feed) {
   m_ui->m_txtUrl->lineEdit()->setText(editable_feed->url());
   m_ui->m_cmbAutoUpdateType->setCurrentIndex(m_ui->m_cmbAutoUpdateType->findData(QVariant::fromValue((int) editable_feed->autoUpdateType())));
   m_ui->m_spinAutoUpdateInterval->setValue(editable_feed->autoUpdateInitialInterval());
+  m_ui->m_spinRetentionCount->setValue(editable_feed->retentionPolicy().m_keepCount);
+  m_ui->m_spinRetentionDays->setValue(editable_feed->retentionPolicy().m_maxAgeDays);
+  m_ui->m_checkRetentionKeepImportant->setChecked(editable_feed->retentionPolicy().m_keepImportant);
 }
 
 void FormFeedDetails::initialize() {
@@ -373,6 +376,9 @@ void FormFeedDetails::initialize() {
   setTabOrder(m_ui->m_btnIcon, m_ui->m_gbAuthentication);
   setTabOrder(m_ui->m_gbAuthentication, m_ui->m_txtUsername->lineEdit());
   setTabOrder(m_ui->m_txtUsername->lineEdit(), m_ui->m_txtPassword->lineEdit());
+  setTabOrder(m_ui->m_txtPassword->lineEdit(), m_ui->m_spinRetentionCount);
+  setTabOrder(m_ui->m_spinRetentionCount, m_ui->m_spinRetentionDays);
+  setTabOrder(m_ui->m_spinRetentionDays, m_ui->m_checkRetentionKeepImportant);
   m_ui->m_txtUrl->lineEdit()->setFocus(Qt::TabFocusReason);
 }
 
@@ -387,3 +393,12 @@ void FormFeedDetails::loadCategories(const QList<Category*>& categories, RootIte
                                        QVariant::fromValue((void*) category));
   }
 }
+
+Feed::RetentionPolicy FormFeedDetails::retentionPolicy() const {
+  Feed::RetentionPolicy policy;
+
+  policy.m_keepCount = m_ui->m_spinRetentionCount->value();
+  policy.m_maxAgeDays = m_ui->m_spinRetentionDays->value();
+  policy.m_keepImportant = m_ui->m_checkRetentionKeepImportant->isChecked();
+  return policy;
+}
@@ -5,6 +5,8 @@
 
 #include <QDialog>
 
+#include "services/abstract/feed.h"
+
 #include "ui_formfeeddetails.h"
 
 namespace Ui {
@@ -69,6 +71,9 @@ class FormFeedDetails : public QDialog {
     // Loads categories into the dialog from the model.
     void loadCategories(const QList<Category*>& categories, RootItem* root_item);
 
+    // Returns retention policy set in the dialog.
+    Feed::RetentionPolicy retentionPolicy() const;
+
   protected:
     QScopedPointer<Ui::FormFeedDetails> m_ui;
     Feed* m_editableFeed;
@@ -13,6 +13,8 @@
 #include "services/abstract/feed.h"
 #include "services/abstract/recyclebin.h"
 
+#include <QThread>
+
 ServiceRoot::ServiceRoot(RootItem* parent) : RootItem(parent), m_recycleBin(new RecycleBin(this)), m_accountId(NO_PARENT_CATEGORY) {
   setKind(RootItemKind::ServiceRoot);
   setCreationDate(QDateTime::currentDateTime());
@@ -121,6 +123,40 @@ void ServiceRoot::updateCounts(bool including_total_count) {
   }
 }
 
+void ServiceRoot::updateFeedCounts(const QList<Feed*>& feeds, bool including_total_count) {
+  if (feeds.isEmpty()) {
+    return;
+  }
+
+  const bool is_main_thread = QThread::currentThread() == qApp->thread();
+  QSqlDatabase database = is_main_thread ?
+                          qApp->database()->connection(metaObject()->className()) :
+                          qApp->database()->connection(QSL("feed_upd"));
+  QStringList feed_custom_ids;
+  bool ok;
+
+  feed_custom_ids.reserve(feeds.size());
+
+  foreach (const Feed* feed, feeds) {
+    feed_custom_ids.append(feed->customId());
+  }
+
+  QMap<QString, QPair<int, int>> counts = DatabaseQueries::getMessageCountsForFeeds(database, feed_custom_ids, accountId(),
+                                                                                   including_total_count, &ok);
+
+  if (ok) {
+    foreach (Feed* feed, feeds) {
+      const QPair<int, int> feed_counts = counts.value(feed->customId(), QPair<int, int>(0, 0));
+
+      feed->setCountOfUnreadMessages(feed_counts.first);
+
+      if (including_total_count) {
+        feed->setCountOfAllMessages(feed_counts.second);
+      }
+    }
+  }
+}
+
 void ServiceRoot::completelyRemoveAllData() {
   // Purge old data from SQL and clean all model items.
   removeOldFeedTree(true);
@@ -244,6 +280,9 @@ QMap<QString, QVariant> ServiceRoot::storeCustomFeedsData() {
 
     feed_custom_data.insert(QSL("auto_update_interval"), feed->autoUpdateInitialInterval());
     feed_custom_data.insert(QSL("auto_update_type"), feed->autoUpdateType());
+    feed_custom_data.insert(QSL("retention_count"), feed->retentionPolicy().m_keepCount);
+    feed_custom_data.insert(QSL("retention_days"), feed->retentionPolicy().m_maxAgeDays);
+    feed_custom_data.insert(QSL("retention_keep_important"), feed->retentionPolicy().m_keepImportant);
     custom_data.insert(feed->customId(), feed_custom_data);
   }
 
@@ -263,6 +302,13 @@ void ServiceRoot::restoreCustomFeedsData(const QMap<QString, QVariant>& data, co
 
       feed->setAutoUpdateInitialInterval(feed_custom_data.value(QSL("auto_update_interval")).toInt());
       feed->setAutoUpdateType(static_cast<Feed::AutoUpdateType>(feed_custom_data.value(QSL("auto_update_type")).toInt()));
+
+      Feed::RetentionPolicy policy;
+
+      policy.m_keepCount = feed_custom_data.value(QSL("retention_count")).toInt();
+      policy.m_maxAgeDays = feed_custom_data.value(QSL("retention_days")).toInt();
+      policy.m_keepImportant = feed_custom_data.value(QSL("retention_keep_important"), true).toBool();
+      feed->setRetentionPolicy(policy);
     }
   }
 }
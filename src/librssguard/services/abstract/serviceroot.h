@@ -30,6 +30,9 @@ class ServiceRoot : public RootItem {
     virtual ~ServiceRoot();
 
     void updateCounts(bool including_total_count);
+
+    // Updates counts of given feeds of this account via single query.
+    void updateFeedCounts(const QList<Feed*>& feeds, bool including_total_count);
     bool deleteViaGui();
     bool markAsReadUnread(ReadStatus status);
 
@@ -45,13 +45,15 @@ bool OwnCloudFeed::editItself(OwnCloudFeed* new_feed_data) {
   QSqlDatabase database = qApp->database()->connection(metaObject()->className());
 
   if (!DatabaseQueries::editBaseFeed(database, id(), new_feed_data->autoUpdateType(),
-                                     new_feed_data->autoUpdateInitialInterval())) {
+                                     new_feed_data->autoUpdateInitialInterval()) ||
+      !DatabaseQueries::editFeedRetentionPolicy(database, id(), new_feed_data->retentionPolicy())) {
     // Persistent storage update failed, no way to continue now.
     return false;
   }
   else {
     setAutoUpdateType(new_feed_data->autoUpdateType());
     setAutoUpdateInitialInterval(new_feed_data->autoUpdateInitialInterval());
+    setRetentionPolicy(new_feed_data->retentionPolicy());
     return true;
   }
 }
@@ -6,8 +6,8 @@
 #include "miscellaneous/application.h"
 #include "miscellaneous/databasequeries.h"
 #include "miscellaneous/iconfactory.h"
-#include "miscellaneous/mutex.h"
 #include "miscellaneous/textfactory.h"
+#include "miscellaneous/updatelock.h"
 #include "services/abstract/recyclebin.h"
 #include "services/owncloud/gui/formeditowncloudaccount.h"
 #include "services/owncloud/gui/formowncloudfeeddetails.h"
@@ -160,12 +160,12 @@ void OwnCloudServiceRoot::saveAccountDataToDatabase() {
 }
 
 void OwnCloudServiceRoot::addNewFeed(const QString& url) {
-  if (!qApp->feedUpdateLock()->tryLock()) {
+  if (!qApp->feedUpdateLock()->tryLockAccount(this)) {
     // Lock was not obtained because
     // it is used probably by feed updater or application
     // is quitting.
     qApp->showGuiMessage(tr("Cannot add item"),
-                         tr("Cannot add feed because another critical operation is ongoing."),
+                         tr("Cannot add feed because this account is being updated or edited."),
                          QSystemTrayIcon::Warning, qApp->mainFormWidget(), true);
 
     // Thus, cannot delete and quit the method.
@@ -174,7 +174,7 @@ void OwnCloudServiceRoot::addNewFeed(const QString& url) {
 
   QScopedPointer<FormOwnCloudFeedDetails> form_pointer(new FormOwnCloudFeedDetails(this, qApp->mainFormWidget()));
   form_pointer.data()->addEditFeed(nullptr, this, url);
-  qApp->feedUpdateLock()->unlock();
+  qApp->feedUpdateLock()->unlockAccount(this);
 }
 
 void OwnCloudServiceRoot::addNewCategory() {}
@@ -8,66 +8,148 @@
 
 #include "exceptions/applicationexception.h"
 
-AtomParser::AtomParser(const QString& data) : FeedParser(data) {
-  QString version = m_xml.documentElement().attribute(QSL("version"));
+AtomParser::AtomParser(const QByteArray& data, QTextCodec* codec) : FeedParser(data, codec) {}
 
-  if (version == QSL("0.3")) {
-    m_atomNamespace = QSL("http://purl.org/atom/ns#");
+AtomParser::~AtomParser() = default;
+
+bool AtomParser::isMessageElement() const {
+  return !m_atomNamespace.isEmpty() && m_xml.namespaceUri() == m_atomNamespace && m_xml.name() == QL1S("entry");
+}
+
+void AtomParser::processElement() {
+  if (m_atomNamespace.isEmpty()) {
+    // This is root element of the document.
+    if (m_xml.attributes().value(QSL("version")) == QL1S("0.3")) {
+      m_atomNamespace = QSL("http://purl.org/atom/ns#");
+    }
+    else {
+      m_atomNamespace = QSL("http://www.w3.org/2005/Atom");
+    }
+  }
+  else if (m_xml.namespaceUri() == m_atomNamespace && m_xml.name() == QL1S("author")) {
+    QString name;
+
+    if (readAuthorName(name) && !name.isEmpty() && !m_feedAuthors.contains(name)) {
+      m_feedAuthors.append(name);
+    }
   }
   else {
-    m_atomNamespace = QSL("http://www.w3.org/2005/Atom");
+    FeedParser::processElement();
   }
 }
 
-AtomParser::~AtomParser() = default;
-
 QString AtomParser::feedAuthor() const {
-  QDomNodeList authors = m_xml.documentElement().elementsByTagNameNS(m_atomNamespace, QSL("author"));
-  QStringList author_str;
+  return m_feedAuthors.join(", ");
+}
+
+Message AtomParser::extractMessage(const QDateTime& current_time) {
+  Message new_message;
+  MrssData mrss;
+  QString title, content, summary, updated, modified;
+  bool title_found = false, content_found = false, summary_found = false, updated_found = false, modified_found = false;
+  QStringList author_names;
+  QString last_link_alternate, last_link_other;
+  int depth = 1;
 
-  for (int i = 0; i < authors.size(); i++) {
-    QDomNodeList names = authors.at(i).toElement().elementsByTagNameNS(m_atomNamespace, QSL("name"));
+  // Elements are searched in whole subtree of the entry,
+  // first occurrence of each element is used.
+  while (depth > 0 && !m_xml.atEnd()) {
+    m_xml.readNext();
 
-    if (!names.isEmpty()) {
-      const QString name = names.at(0).toElement().text();
+    if (m_xml.isEndElement()) {
+      depth--;
+      continue;
+    }
+    else if (!m_xml.isStartElement()) {
+      continue;
+    }
 
-      if (!name.isEmpty() && !author_str.contains(name)) {
-        author_str.append(name);
-      }
+    if (m_xml.namespaceUri() == m_mrssNamespace) {
+      mrssReadElement(mrss);
+      continue;
+    }
+    else if (m_xml.namespaceUri() != m_atomNamespace) {
+      depth++;
+      continue;
     }
-  }
 
-  return author_str.join(", ");
-}
+    const QString name = m_xml.name().toString();
 
-Message AtomParser::extractMessage(const QDomElement& msg_element, QDateTime current_time) const {
-  Message new_message;
-  QString title = textsFromPath(msg_element, m_atomNamespace, QSL("title"), true).join(QSL(", "));
-  QString summary = textsFromPath(msg_element, m_atomNamespace, QSL("content"), true).join(QSL(", "));
+    if (name == QL1S("title") && !title_found) {
+      title = m_xml.readElementText(QXmlStreamReader::IncludeChildElements);
+      title_found = true;
+    }
+    else if (name == QL1S("content") && !content_found) {
+      content = m_xml.readElementText(QXmlStreamReader::IncludeChildElements);
+      content_found = true;
+    }
+    else if (name == QL1S("summary") && !summary_found) {
+      summary = m_xml.readElementText(QXmlStreamReader::IncludeChildElements);
+      summary_found = true;
+    }
+    else if (name == QL1S("updated") && !updated_found) {
+      updated = m_xml.readElementText(QXmlStreamReader::IncludeChildElements);
+      updated_found = true;
+    }
+    else if (name == QL1S("modified") && !modified_found) {
+      modified = m_xml.readElementText(QXmlStreamReader::IncludeChildElements);
+      modified_found = true;
+    }
+    else if (name == QL1S("author")) {
+      QString author_name;
 
-  if (summary.isEmpty()) {
-    summary = textsFromPath(msg_element, m_atomNamespace, QSL("summary"), true).join(QSL(", "));
+      if (readAuthorName(author_name)) {
+        author_names.append(author_name);
 
-    if (summary.isEmpty()) {
-      summary = mrssTextFromPath(msg_element, QSL("description"));
+        if (!author_name.isEmpty() && !m_feedAuthors.contains(author_name)) {
+          m_feedAuthors.append(author_name);
+        }
+      }
+    }
+    else if (name == QL1S("link")) {
+      const QXmlStreamAttributes attributes = m_xml.attributes();
+      const QString attribute = attributes.value(QSL("rel")).toString();
+
+      if (attribute == QSL("enclosure")) {
+        new_message.m_enclosures.append(Enclosure(attributes.value(QSL("href")).toString(),
+                                                  attributes.value(QSL("type")).toString()));
+        qDebug("Found enclosure '%s' for the message.", qPrintable(new_message.m_enclosures.last().m_url));
+      }
+      else if (attribute.isEmpty() || attribute == QSL("alternate")) {
+        last_link_alternate = attributes.value(QSL("href")).toString();
+      }
+      else {
+        last_link_other = attributes.value(QSL("href")).toString();
+      }
+
+      depth++;
+    }
+    else {
+      depth++;
+    }
+  }
+
+  if (content.isEmpty()) {
+    content = summary;
+
+    if (content.isEmpty()) {
+      content = mrss.m_description;
     }
   }
 
   // Now we obtained maximum of information for title & description.
-  if (title.isEmpty() && summary.isEmpty()) {
+  if (title.isEmpty() && content.isEmpty()) {
     // BOTH title and description are empty, skip this message.
     throw ApplicationException(QSL("Not enough data for the message."));
   }
 
   // Title is not empty, description does not matter.
   new_message.m_title = qApp->web()->stripTags(title);
-  new_message.m_contents = summary;
-  new_message.m_author = qApp->web()->escapeHtml(messageAuthor(msg_element));
-
-  QString updated = textsFromPath(msg_element, m_atomNamespace, QSL("updated"), true).join(QSL(", "));
+  new_message.m_contents = content;
+  new_message.m_author = qApp->web()->escapeHtml(author_names.join(", "));
 
   if (updated.isEmpty()) {
-    updated = textsFromPath(msg_element, m_atomNamespace, QSL("modified"), true).join(QSL(", "));
+    updated = modified;
   }
 
   // Deal with creation date.
@@ -79,28 +161,8 @@ Message AtomParser::extractMessage(const QDomElement& msg_element, QDateTime cur
     new_message.m_created = current_time;
   }
 
-  // Deal with links
-  QDomNodeList elem_links = msg_element.toElement().elementsByTagNameNS(m_atomNamespace, QSL("link"));
-  QString last_link_alternate, last_link_other;
-
-  for (int i = 0; i < elem_links.size(); i++) {
-    QDomElement link = elem_links.at(i).toElement();
-    QString attribute = link.attribute(QSL("rel"));
-
-    if (attribute == QSL("enclosure")) {
-      new_message.m_enclosures.append(Enclosure(link.attribute(QSL("href")), link.attribute(QSL("type"))));
-      qDebug("Found enclosure '%s' for the message.", qPrintable(new_message.m_enclosures.last().m_url));
-    }
-    else if (attribute.isEmpty() || attribute == QSL("alternate")) {
-      last_link_alternate = link.attribute(QSL("href"));
-    }
-    else {
-      last_link_other = link.attribute(QSL("href"));
-    }
-  }
-
   // Obtain MRSS enclosures.
-  new_message.m_enclosures.append(mrssGetEnclosures(msg_element));
+  new_message.m_enclosures.append(mrss.enclosures());
 
   if (!last_link_alternate.isEmpty()) {
     new_message.m_url = last_link_alternate;
@@ -115,21 +177,18 @@ Message AtomParser::extractMessage(const QDomElement& msg_element, QDateTime cur
   return new_message;
 }
 
-QString AtomParser::messageAuthor(const QDomElement& msg_element) const {
-  QDomNodeList authors = msg_element.elementsByTagNameNS(m_atomNamespace, QSL("author"));
-  QStringList author_str;
-
-  for (int i = 0; i < authors.size(); i++) {
-    QDomNodeList names = authors.at(i).toElement().elementsByTagNameNS(m_atomNamespace, QSL("name"));
+bool AtomParser::readAuthorName(QString& name) {
+  bool name_found = false;
 
-    if (!names.isEmpty()) {
-      author_str.append(names.at(0).toElement().text());
+  while (m_xml.readNextStartElement()) {
+    if (!name_found && m_xml.namespaceUri() == m_atomNamespace && m_xml.name() == QL1S("name")) {
+      name = m_xml.readElementText(QXmlStreamReader::IncludeChildElements);
+      name_found = true;
+    }
+    else {
+      m_xml.skipCurrentElement();
     }
   }
 
-  return author_str.join(", ");
-}
-
-QDomNodeList AtomParser::messageElements() {
-  return m_xml.elementsByTagNameNS(m_atomNamespace, QSL("entry"));
+  return name_found;
 }
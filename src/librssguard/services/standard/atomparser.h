@@ -7,22 +7,28 @@
 
 #include "core/message.h"
 
-#include <QDomDocument>
 #include <QList>
 
-class AtomParser : public FeedParser {
+class RSSGUARD_DLLSPEC AtomParser : public FeedParser {
   public:
-    explicit AtomParser(const QString& data);
+    explicit AtomParser(const QByteArray& data, QTextCodec* codec = nullptr);
     virtual ~AtomParser();
 
   private:
-    QDomNodeList messageElements();
+    bool isMessageElement() const;
+    void processElement();
     QString feedAuthor() const;
-    Message extractMessage(const QDomElement& msg_element, QDateTime current_time) const;
-    QString messageAuthor(const QDomElement& msg_element) const;
+    Message extractMessage(const QDateTime& current_time);
+
+    // Reads current "author" element, returns true
+    // if it contains name.
+    bool readAuthorName(QString& name);
 
   private:
     QString m_atomNamespace;
+
+    // Names of all authors in whole document.
+    QStringList m_feedAuthors;
 };
 
 #endif // ATOMPARSER_H
@@ -5,36 +5,81 @@
 #include "exceptions/applicationexception.h"
 
 #include <QDebug>
-#include <QRegularExpression>
-#include <utility>
+#include <QElapsedTimer>
 
-FeedParser::FeedParser(QString data) : m_xmlData(std::move(data)), m_mrssNamespace(QSL("http://search.yahoo.com/mrss/")) {
-  m_xml.setContent(m_xmlData, true);
+FeedParser::FeedParser(const QByteArray& data, QTextCodec* codec)
+  : m_dataSize(data.size()), m_mrssNamespace(QSL("http://search.yahoo.com/mrss/")) {
+  if (codec == nullptr) {
+    m_xml.addData(data);
+  }
+  else {
+    m_xml.addData(codec->toUnicode(data));
+  }
 }
 
 FeedParser::~FeedParser() = default;
 
-QList<Message> FeedParser::messages() {
-  QString feed_author = feedAuthor();
+QTextCodec* FeedParser::codecForData(const QByteArray& data, const QString& content_type, const QString& encoding) {
+  // XML parser detects byte order marks and encoding declared in XML prolog itself.
+  const QByteArray head = data.left(256);
+
+  if (head.startsWith("\xEF\xBB\xBF") || head.startsWith("\xFE\xFF") || head.startsWith("\xFF\xFE")) {
+    return nullptr;
+  }
+
+  if (head.startsWith("<?xml")) {
+    const int prolog_end = head.indexOf("?>");
+
+    if (head.left(prolog_end).contains("encoding")) {
+      return nullptr;
+    }
+  }
+
+  QByteArray charset;
+  const int charset_index = content_type.indexOf(QL1S("charset="), 0, Qt::CaseInsensitive);
+
+  if (charset_index >= 0) {
+    charset = content_type.mid(charset_index + 8).section(QL1C(';'), 0, 0).trimmed().remove(QL1C('"')).toLatin1();
+  }
+
+  if (charset.isEmpty()) {
+    charset = encoding.toLocal8Bit();
+  }
 
+  QTextCodec* codec = QTextCodec::codecForName(charset);
+
+  // XML parser decodes UTF-8 data by default. If no suitable
+  // codec is found, data are decoded as UTF-8 too.
+  if (codec == nullptr || codec->mibEnum() == 106) {
+    return nullptr;
+  }
+  else {
+    return codec;
+  }
+}
+
+QList<Message> FeedParser::messages() {
   QList<Message> messages;
   QDateTime current_time = QDateTime::currentDateTime();
+  QElapsedTimer tmr;
+
+  tmr.start();
 
   // Pull out all messages.
-  QDomNodeList messages_in_xml = messageElements();
+  while (!m_xml.atEnd()) {
+    if (m_xml.readNext() != QXmlStreamReader::StartElement) {
+      continue;
+    }
 
-  for (int i = 0; i < messages_in_xml.size(); i++) {
-    QDomNode message_item = messages_in_xml.item(i);
+    if (!isMessageElement()) {
+      processElement();
+      continue;
+    }
 
     try {
-      Message new_message = extractMessage(message_item.toElement(), current_time);
-
-      if (new_message.m_author.isEmpty()) {
-        new_message.m_author = feed_author;
-      }
-
-      new_message.m_url = new_message.m_url.replace(QRegularExpression("[\\t\\n]"), QString());
+      Message new_message = extractMessage(current_time);
 
+      new_message.m_url.remove(QL1C('\t')).remove(QL1C('\n'));
       messages.append(new_message);
     }
     catch (const ApplicationException& ex) {
@@ -42,82 +87,119 @@ QList<Message> FeedParser::messages() {
     }
   }
 
+  if (m_xml.hasError()) {
+    qWarning("Error when parsing feed data at line %lld: '%s'.", m_xml.lineNumber(), qPrintable(m_xml.errorString()));
+  }
+
+  // Feed author is known only when whole document is read.
+  const QString feed_author = feedAuthor();
+
+  if (!feed_author.isEmpty()) {
+    for (Message& message : messages) {
+      if (message.m_author.isEmpty()) {
+        message.m_author = feed_author;
+      }
+    }
+  }
+
+  qDebug("Parsed %d messages from %d bytes of feed data in %lld ms.",
+         messages.size(), m_dataSize, tmr.elapsed());
   return messages;
 }
 
-QList<Enclosure> FeedParser::mrssGetEnclosures(const QDomElement& msg_element) const {
-  QList<Enclosure> enclosures;
+void FeedParser::mrssReadElement(MrssData& mrss) {
+  if (m_xml.name() == QL1S("description")) {
+    if (mrss.m_descriptionFound) {
+      m_xml.skipCurrentElement();
+    }
+    else {
+      mrss.m_description = m_xml.readElementText(QXmlStreamReader::IncludeChildElements);
+      mrss.m_descriptionFound = true;
+    }
 
-  auto content_list = msg_element.elementsByTagNameNS(m_mrssNamespace, "content");
+    return;
+  }
 
-  for (int i = 0; i < content_list.size(); i++) {
-    QDomElement elem_content = content_list.at(i).toElement();
-    QString url = elem_content.attribute(QSL("url"));
-    QString type = elem_content.attribute(QSL("type"));
+  if (m_xml.name() == QL1S("content")) {
+    const QString url = m_xml.attributes().value(QSL("url")).toString();
+    const QString type = m_xml.attributes().value(QSL("type")).toString();
 
     if (!url.isEmpty() && !type.isEmpty()) {
-      enclosures.append(Enclosure(url, type));
+      mrss.m_contents.append(Enclosure(url, type));
     }
   }
-
-  auto thumbnail_list = msg_element.elementsByTagNameNS(m_mrssNamespace, "thumbnail");
-
-  for (int i = 0; i < thumbnail_list.size(); i++) {
-    QDomElement elem_content = thumbnail_list.at(i).toElement();
-    QString url = elem_content.attribute(QSL("url"));
+  else if (m_xml.name() == QL1S("thumbnail")) {
+    const QString url = m_xml.attributes().value(QSL("url")).toString();
 
     if (!url.isEmpty()) {
-      enclosures.append(Enclosure(url, QSL("image/png")));
+      mrss.m_thumbnails.append(Enclosure(url, QSL("image/png")));
     }
   }
 
-  return enclosures;
+  // Elements like "media:group" or "media:content" can contain other MRSS elements.
+  while (m_xml.readNextStartElement()) {
+    if (m_xml.namespaceUri() == m_mrssNamespace) {
+      mrssReadElement(mrss);
+    }
+    else {
+      m_xml.skipCurrentElement();
+    }
+  }
 }
 
-QString FeedParser::mrssTextFromPath(const QDomElement& msg_element, const QString& xml_path) const {
-  QString text = msg_element.elementsByTagNameNS(m_mrssNamespace, xml_path).at(0).toElement().text();
-
-  return text;
+int FeedParser::updateInterval() const {
+  return qMax(m_ttl * 60, m_syPeriod / qMax(m_syFrequency, 1));
 }
 
-QStringList FeedParser::textsFromPath(const QDomElement& element, const QString& namespace_uri,
-                                      const QString& xml_path, bool only_first) const {
-  QStringList paths = xml_path.split('/');
-  QStringList result;
-
-  QList<QDomElement> current_elements;
-  current_elements.append(element);
-
-  while (!paths.isEmpty()) {
-    QList<QDomElement> next_elements;
-    QString next_local_name = paths.takeFirst();
-
-    foreach (const QDomElement& elem, current_elements) {
-      QDomNodeList elements = elem.elementsByTagNameNS(namespace_uri, next_local_name);
+quint32 FeedParser::skipHours() const {
+  return m_skipHours;
+}
 
-      for (int i = 0; i < elements.size(); i++) {
-        next_elements.append(elements.at(i).toElement());
+void FeedParser::processElement() {
+  static const QString sy_namespace = QSL("http://purl.org/rss/1.0/modules/syndication/");
 
-        if (only_first) {
-          break;
+  if (m_xml.name() == QL1S("ttl") && m_xml.namespaceUri().isEmpty()) {
+    m_ttl = qMax(m_xml.readElementText().trimmed().toInt(), 0);
+  }
+  else if (m_xml.name() == QL1S("skipHours") && m_xml.namespaceUri().isEmpty()) {
+    while (m_xml.readNextStartElement()) {
+      if (m_xml.name() == QL1S("hour")) {
+        bool ok;
+        const int hour = m_xml.readElementText().trimmed().toInt(&ok);
+
+        if (ok && hour >= 0) {
+          m_skipHours |= 1u << (hour % 24);
         }
       }
-
-      if (next_elements.size() == 1 && only_first) {
-        break;
+      else {
+        m_xml.skipCurrentElement();
       }
     }
-
-    current_elements = next_elements;
   }
+  else if (m_xml.namespaceUri() == sy_namespace) {
+    if (m_xml.name() == QL1S("updatePeriod")) {
+      const QString period = m_xml.readElementText().trimmed().toLower();
 
-  if (!current_elements.isEmpty()) {
-    foreach (const QDomElement& elem, current_elements) {
-      result.append(elem.text());
+      if (period == QL1S("hourly")) {
+        m_syPeriod = 3600;
+      }
+      else if (period == QL1S("daily")) {
+        m_syPeriod = 86400;
+      }
+      else if (period == QL1S("weekly")) {
+        m_syPeriod = 604800;
+      }
+      else if (period == QL1S("monthly")) {
+        m_syPeriod = 2592000;
+      }
+      else if (period == QL1S("yearly")) {
+        m_syPeriod = 31536000;
+      }
+    }
+    else if (m_xml.name() == QL1S("updateFrequency")) {
+      m_syFrequency = qMax(m_xml.readElementText().trimmed().toInt(), 1);
     }
   }
-
-  return result;
 }
 
 QString FeedParser::feedAuthor() const {
@@ -3,30 +3,77 @@
 #ifndef FEEDPARSER_H
 #define FEEDPARSER_H
 
-#include <QDomDocument>
 #include <QString>
+#include <QTextCodec>
+#include <QXmlStreamReader>
 
 #include "core/message.h"
 
-class FeedParser {
+// Base class for feed parsers. Document is read by QXmlStreamReader
+// in single pass and each message element is passed to subclass.
+class RSSGUARD_DLLSPEC FeedParser {
   public:
-    explicit FeedParser(QString data);
+
+    // Raw data are passed to QXmlStreamReader which decodes them according to
+    // XML declaration. If codec is given, data are decoded with it instead.
+    explicit FeedParser(const QByteArray& data, QTextCodec* codec = nullptr);
     virtual ~FeedParser();
 
     virtual QList<Message> messages();
 
+    // Interval in seconds in which feed asks to be updated, zero if not specified.
+    // It is known only after messages are read.
+    int updateInterval() const;
+
+    // Bit N is set if feed asks not to be updated during hour N (UTC).
+    quint32 skipHours() const;
+
+    // Returns codec which must be used to decode feed data or nullptr if data
+    // can be passed to XML parser as they are. Encoding declared in data has
+    // precedence over HTTP charset which has precedence over given encoding.
+    static QTextCodec* codecForData(const QByteArray& data, const QString& content_type, const QString& encoding);
+
   protected:
-    QList<Enclosure> mrssGetEnclosures(const QDomElement& msg_element) const;
-    QString mrssTextFromPath(const QDomElement& msg_element, const QString& xml_path) const;
-    QStringList textsFromPath(const QDomElement& element, const QString& namespace_uri, const QString& xml_path, bool only_first) const;
-    virtual QDomNodeList messageElements() = 0;
+
+    // Media RSS data found in single message.
+    struct MrssData {
+      QList<Enclosure> m_contents;
+      QList<Enclosure> m_thumbnails;
+      QString m_description;
+      bool m_descriptionFound = false;
+
+      QList<Enclosure> enclosures() const {
+        return m_contents + m_thumbnails;
+      }
+    };
+
+    // Reads current MRSS element including its nested elements
+    // and stores found enclosures and description.
+    void mrssReadElement(MrssData& mrss);
+
+    // Returns true if current start element is message element.
+    virtual bool isMessageElement() const = 0;
+
+    // Processes current start element which is not message element,
+    // it is not needed to read it whole. Subclasses should pass elements
+    // they do not know to base implementation.
+    virtual void processElement();
+
     virtual QString feedAuthor() const;
-    virtual Message extractMessage(const QDomElement& msg_element, QDateTime current_time) const = 0;
+
+    // Reads current message element whole.
+    virtual Message extractMessage(const QDateTime& current_time) = 0;
 
   protected:
-    QString m_xmlData;
-    QDomDocument m_xml;
+    int m_dataSize;
+    QXmlStreamReader m_xml;
     QString m_mrssNamespace;
+
+  private:
+    int m_ttl = 0;
+    int m_syPeriod = 0;
+    int m_syFrequency = 1;
+    quint32 m_skipHours = 0;
 };
 
 #endif // FEEDPARSER_H
@@ -54,6 +54,9 @@ void FormStandardCategoryDetails::setEditableCategory(StandardCategory* editable
   m_ui->m_txtTitle->lineEdit()->setText(editable_category->title());
   m_ui->m_txtDescription->lineEdit()->setText(editable_category->description());
   m_ui->m_btnIcon->setIcon(editable_category->icon());
+  m_ui->m_spinRetentionCount->setValue(editable_category->retentionPolicy().m_keepCount);
+  m_ui->m_spinRetentionDays->setValue(editable_category->retentionPolicy().m_maxAgeDays);
+  m_ui->m_checkRetentionKeepImportant->setChecked(editable_category->retentionPolicy().m_keepImportant);
 }
 
 int FormStandardCategoryDetails::addEditCategory(StandardCategory* input_category, RootItem* parent_to_select) {
@@ -95,11 +98,17 @@ int FormStandardCategoryDetails::addEditCategory(StandardCategory* input_categor
 void FormStandardCategoryDetails::apply() {
   RootItem* parent = static_cast<RootItem*>(m_ui->m_cmbParentCategory->itemData(m_ui->m_cmbParentCategory->currentIndex()).value<void*>());
   auto* new_category = new StandardCategory();
+  Feed::RetentionPolicy retention_policy;
+
+  retention_policy.m_keepCount = m_ui->m_spinRetentionCount->value();
+  retention_policy.m_maxAgeDays = m_ui->m_spinRetentionDays->value();
+  retention_policy.m_keepImportant = m_ui->m_checkRetentionKeepImportant->isChecked();
 
   new_category->setTitle(m_ui->m_txtTitle->lineEdit()->text());
   new_category->setCreationDate(QDateTime::currentDateTime());
   new_category->setDescription(m_ui->m_txtDescription->lineEdit()->text());
   new_category->setIcon(m_ui->m_btnIcon->icon());
+  new_category->setRetentionPolicy(retention_policy);
 
   if (m_editableCategory == nullptr) {
     // Add the category.
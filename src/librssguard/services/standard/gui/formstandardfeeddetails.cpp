@@ -29,6 +29,7 @@ void FormStandardFeedDetails::apply() {
   new_feed->setAutoUpdateType(static_cast<Feed::AutoUpdateType>(m_ui->m_cmbAutoUpdateType->itemData(
                                                                   m_ui->m_cmbAutoUpdateType->currentIndex()).toInt()));
   new_feed->setAutoUpdateInitialInterval(int(m_ui->m_spinAutoUpdateInterval->value()));
+  new_feed->setRetentionPolicy(retentionPolicy());
 
   if (m_editableFeed == nullptr) {
     // Add the feed.
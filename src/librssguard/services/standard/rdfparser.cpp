@@ -2,82 +2,80 @@
 
 #include "services/standard/rdfparser.h"
 
+#include "exceptions/applicationexception.h"
 #include "miscellaneous/application.h"
 #include "miscellaneous/textfactory.h"
 #include "network-web/webfactory.h"
 
-#include <QDomDocument>
+#include <QHash>
 
-RdfParser::RdfParser() = default;
+RdfParser::RdfParser(const QByteArray& data, QTextCodec* codec) : FeedParser(data, codec) {}
 
 RdfParser::~RdfParser() = default;
 
-QList<Message> RdfParser::parseXmlData(const QString& data) {
-  QList<Message> messages;
-  QDomDocument xml_file;
-  QDateTime current_time = QDateTime::currentDateTime();
-
-  xml_file.setContent(data, true);
-
-  // Pull out all messages.
-  QDomNodeList messages_in_xml = xml_file.elementsByTagName(QSL("item"));
-
-  for (int i = 0; i < messages_in_xml.size(); i++) {
-    QDomNode message_item = messages_in_xml.item(i);
-    Message new_message;
-
-    // Deal with title and description.
-    QString elem_title = message_item.namedItem(QSL("title")).toElement().text().simplified();
-    QString elem_description = message_item.namedItem(QSL("description")).toElement().text();
-
-    // Now we obtained maximum of information for title & description.
-    if (elem_title.isEmpty()) {
-      if (elem_description.isEmpty()) {
-        // BOTH title and description are empty, skip this message.
-        continue;
-      }
-      else {
-        // Title is empty but description is not.
-        new_message.m_title = qApp->web()->escapeHtml(qApp->web()->stripTags(elem_description.simplified()));
-        new_message.m_contents = elem_description;
-      }
+bool RdfParser::isMessageElement() const {
+  return m_xml.name() == QL1S("item");
+}
+
+Message RdfParser::extractMessage(const QDateTime& current_time) {
+  Message new_message;
+
+  // Texts of first child elements with given local names.
+  QHash<QString, QString> texts;
+
+  while (m_xml.readNextStartElement()) {
+    const QString name = m_xml.name().toString();
+
+    if (texts.contains(name)) {
+      m_xml.skipCurrentElement();
     }
     else {
-      // Title is really not empty, description does not matter.
-      new_message.m_title = qApp->web()->escapeHtml(qApp->web()->stripTags(elem_title));
-      new_message.m_contents = elem_description;
+      texts.insert(name, m_xml.readElementText(QXmlStreamReader::IncludeChildElements));
     }
+  }
 
-    // Deal with link and author.
-    new_message.m_url = message_item.namedItem(QSL("link")).toElement().text();
-    new_message.m_author = message_item.namedItem(QSL("creator")).toElement().text();
-
-    // Deal with creation date.
-    QString elem_updated = message_item.namedItem(QSL("date")).toElement().text();
+  // Deal with title and description.
+  QString elem_title = texts.value(QSL("title")).simplified();
+  QString elem_description = texts.value(QSL("description"));
 
-    if (elem_updated.isEmpty()) {
-      elem_updated = message_item.namedItem(QSL("dc:date")).toElement().text();
+  // Now we obtained maximum of information for title & description.
+  if (elem_title.isEmpty()) {
+    if (elem_description.isEmpty()) {
+      // BOTH title and description are empty, skip this message.
+      throw ApplicationException(QSL("Not enough data for the message."));
+    }
+    else {
+      // Title is empty but description is not.
+      new_message.m_title = qApp->web()->escapeHtml(qApp->web()->stripTags(elem_description.simplified()));
+      new_message.m_contents = elem_description;
     }
+  }
+  else {
+    // Title is really not empty, description does not matter.
+    new_message.m_title = qApp->web()->escapeHtml(qApp->web()->stripTags(elem_title));
+    new_message.m_contents = elem_description;
+  }
 
-    // Deal with creation date.
-    new_message.m_created = TextFactory::parseDateTime(elem_updated);
-    new_message.m_createdFromFeed = !new_message.m_created.isNull();
+  // Deal with link and author.
+  new_message.m_url = texts.value(QSL("link"));
+  new_message.m_author = texts.value(QSL("creator"));
 
-    if (!new_message.m_createdFromFeed) {
-      // Date was NOT obtained from the feed, set current date as creation date for the message.
-      new_message.m_created = current_time;
-    }
+  // Deal with creation date.
+  new_message.m_created = TextFactory::parseDateTime(texts.value(QSL("date")));
+  new_message.m_createdFromFeed = !new_message.m_created.isNull();
 
-    if (new_message.m_author.isNull()) {
-      new_message.m_author = "";
-    }
+  if (!new_message.m_createdFromFeed) {
+    // Date was NOT obtained from the feed, set current date as creation date for the message.
+    new_message.m_created = current_time;
+  }
 
-    if (new_message.m_url.isNull()) {
-      new_message.m_url = "";
-    }
+  if (new_message.m_author.isNull()) {
+    new_message.m_author = "";
+  }
 
-    messages.append(new_message);
+  if (new_message.m_url.isNull()) {
+    new_message.m_url = "";
   }
 
-  return messages;
+  return new_message;
 }
@@ -8,34 +8,63 @@
 #include "miscellaneous/textfactory.h"
 #include "network-web/webfactory.h"
 
-#include <QDomDocument>
+#include <QHash>
 
-RssParser::RssParser(const QString& data) : FeedParser(data) {}
+RssParser::RssParser(const QByteArray& data, QTextCodec* codec) : FeedParser(data, codec), m_channelFound(false) {}
 
 RssParser::~RssParser() = default;
 
-QDomNodeList RssParser::messageElements() {
-  QDomNode channel_elem = m_xml.namedItem(QSL("rss")).namedItem(QSL("channel"));
+bool RssParser::isMessageElement() const {
+  return m_channelFound && m_xml.name() == QL1S("item");
+}
 
-  if (channel_elem.isNull()) {
-    return QDomNodeList();
+void RssParser::processElement() {
+  if (m_xml.name() == QL1S("channel")) {
+    m_channelFound = true;
   }
   else {
-    return channel_elem.toElement().elementsByTagName(QSL("item"));
+    FeedParser::processElement();
   }
 }
 
-Message RssParser::extractMessage(const QDomElement& msg_element, QDateTime current_time) const {
+Message RssParser::extractMessage(const QDateTime& current_time) {
   Message new_message;
+  MrssData mrss;
+
+  // Texts of first child elements with given local names.
+  QHash<QString, QString> texts;
+  QString elem_enclosure, elem_enclosure_type, elem_link_href;
+
+  while (m_xml.readNextStartElement()) {
+    if (m_xml.namespaceUri() == m_mrssNamespace) {
+      mrssReadElement(mrss);
+      continue;
+    }
+
+    const QString name = m_xml.name().toString();
+
+    if (texts.contains(name)) {
+      m_xml.skipCurrentElement();
+      continue;
+    }
+
+    if (name == QL1S("enclosure")) {
+      elem_enclosure = m_xml.attributes().value(QSL("url")).toString();
+      elem_enclosure_type = m_xml.attributes().value(QSL("type")).toString();
+    }
+    else if (name == QL1S("link")) {
+      elem_link_href = m_xml.attributes().value(QSL("href")).toString();
+    }
+
+    texts.insert(name, m_xml.readElementText(QXmlStreamReader::IncludeChildElements));
+  }
 
   // Deal with titles & descriptions.
-  QString elem_title = msg_element.namedItem(QSL("title")).toElement().text().simplified();
-  QString elem_description = msg_element.namedItem(QSL("encoded")).toElement().text();
-  QString elem_enclosure = msg_element.namedItem(QSL("enclosure")).toElement().attribute(QSL("url"));
-  QString elem_enclosure_type = msg_element.namedItem(QSL("enclosure")).toElement().attribute(QSL("type"));
+  QString elem_title = texts.value(QSL("title")).simplified();
+  QString elem_description = texts.value(QSL("encoded"));
 
   if (elem_description.isEmpty()) {
-    elem_description = msg_element.namedItem(QSL("description")).toElement().text();
+    elem_description = texts.value(QSL("description"));
   }
 
   // Now we obtained maximum of information for title & description.
@@ -62,7 +91,7 @@ Message RssParser::extractMessage(const QDomElement& msg_element, QDateTime curr
   }
 
   // Deal with link and author.
-  new_message.m_url = msg_element.namedItem(QSL("link")).toElement().text();
+  new_message.m_url = texts.value(QSL("link"));
 
   if (new_message.m_url.isEmpty() && !new_message.m_enclosures.isEmpty()) {
     new_message.m_url = new_message.m_enclosures.first().m_url;
@@ -70,20 +99,23 @@ Message RssParser::extractMessage(const QDomElement& msg_element, QDateTime curr
 
   if (new_message.m_url.isEmpty()) {
     // Try to get "href" attribute.
-    new_message.m_url = msg_element.namedItem(QSL("link")).toElement().attribute(QSL("href"));
+    new_message.m_url = elem_link_href;
   }
 
-  new_message.m_author = msg_element.namedItem(QSL("author")).toElement().text();
+  // Obtain MRSS enclosures.
+  new_message.m_enclosures.append(mrss.enclosures());
+
+  new_message.m_author = texts.value(QSL("author"));
 
   if (new_message.m_author.isEmpty()) {
-    new_message.m_author = msg_element.namedItem(QSL("creator")).toElement().text();
+    new_message.m_author = texts.value(QSL("creator"));
   }
 
   // Deal with creation date.
-  new_message.m_created = TextFactory::parseDateTime(msg_element.namedItem(QSL("pubDate")).toElement().text());
+  new_message.m_created = TextFactory::parseDateTime(texts.value(QSL("pubDate")));
 
   if (new_message.m_created.isNull()) {
-    new_message.m_created = TextFactory::parseDateTime(msg_element.namedItem(QSL("date")).toElement().text());
+    new_message.m_created = TextFactory::parseDateTime(texts.value(QSL("date")));
   }
 
   if (!(new_message.m_createdFromFeed = !new_message.m_created.isNull())) {
@@ -9,14 +9,18 @@
 
 #include <QList>
 
-class RssParser : public FeedParser {
+class RSSGUARD_DLLSPEC RssParser : public FeedParser {
   public:
-    explicit RssParser(const QString& data);
+    explicit RssParser(const QByteArray& data, QTextCodec* codec = nullptr);
     virtual ~RssParser();
 
   private:
-    QDomNodeList messageElements();
-    Message extractMessage(const QDomElement& msg_element, QDateTime current_time) const;
+    bool isMessageElement() const;
+    void processElement();
+    Message extractMessage(const QDateTime& current_time);
+
+  private:
+    bool m_channelFound;
 };
 
 #endif // RSSPARSER_H
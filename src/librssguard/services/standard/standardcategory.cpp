@@ -104,6 +104,7 @@ bool StandardCategory::addItself(RootItem* parent) {
   else {
     setId(new_id);
     setCustomId(QString::number(new_id));
+    DatabaseQueries::editCategoryRetentionPolicy(database, new_id, retentionPolicy());
     return true;
   }
 }
@@ -115,11 +116,13 @@ bool StandardCategory::editItself(StandardCategory* new_category_data) {
 
   if (DatabaseQueries::editCategory(database, new_parent->id(), original_category->id(),
                                     new_category_data->title(), new_category_data->description(),
-                                    new_category_data->icon())) {
+                                    new_category_data->icon()) &&
+      DatabaseQueries::editCategoryRetentionPolicy(database, original_category->id(), new_category_data->retentionPolicy())) {
     // Setup new model data for the original item.
     original_category->setDescription(new_category_data->description());
     original_category->setIcon(new_category_data->icon());
     original_category->setTitle(new_category_data->title());
+    original_category->setRetentionPolicy(new_category_data->retentionPolicy());
 
     // Editing is done.
     return true;
@@ -11,6 +11,7 @@
 #include "miscellaneous/settings.h"
 #include "miscellaneous/simplecrypt/simplecrypt.h"
 #include "miscellaneous/textfactory.h"
+#include "network-web/downloader.h"
 #include "network-web/networkfactory.h"
 #include "services/abstract/recyclebin.h"
 #include "services/standard/atomparser.h"
@@ -319,6 +320,7 @@ bool StandardFeed::addItself(RootItem* parent) {
     // New feed was added, fetch is primary id from the database.
     setId(new_id);
     setCustomId(QString::number(new_id));
+    DatabaseQueries::editFeedRetentionPolicy(database, new_id, retentionPolicy());
     return true;
   }
 }
@@ -333,7 +335,8 @@ bool StandardFeed::editItself(StandardFeed* new_feed_data) {
                                  new_feed_data->encoding(), new_feed_data->url(), new_feed_data->passwordProtected(),
                                  new_feed_data->username(), new_feed_data->password(),
                                  new_feed_data->autoUpdateType(), new_feed_data->autoUpdateInitialInterval(),
-                                 new_feed_data->type())) {
+                                 new_feed_data->type()) ||
+      !DatabaseQueries::editFeedRetentionPolicy(database, original_feed->id(), new_feed_data->retentionPolicy())) {
     // Persistent storage update failed, no way to continue now.
     return false;
   }
@@ -351,6 +354,10 @@ bool StandardFeed::editItself(StandardFeed* new_feed_data) {
   original_feed->setAutoUpdateType(new_feed_data->autoUpdateType());
   original_feed->setAutoUpdateInitialInterval(new_feed_data->autoUpdateInitialInterval());
   original_feed->setType(new_feed_data->type());
+  original_feed->setRetentionPolicy(new_feed_data->retentionPolicy());
+
+  // Feed data may be completely different now, so next update must not be conditional.
+  original_feed->setHttpValidators(QString(), QString());
 
   // Editing is done.
   return true;
@@ -396,6 +403,25 @@ void StandardFeed::setEncoding(const QString& encoding) {
   m_encoding = encoding;
 }
 
+bool StandardFeed::supportsAsynchronousUpdate() const {
+  return true;
+}
+
+Downloader* StandardFeed::startAsynchronousUpdate() {
+  int download_timeout = qApp->settings()->value(GROUP(Feeds), SETTING(Feeds::UpdateTimeout)).toInt();
+  QPair<QByteArray, QByteArray> auth_header = NetworkFactory::generateBasicAuthHeader(username(), password());
+  auto* downloader = new Downloader();
+
+  if (!auth_header.first.isEmpty()) {
+    downloader->appendRawHeader(auth_header.first, auth_header.second);
+  }
+
+  downloader->appendConditionalHeaders(httpETag(), httpLastModified());
+
+  downloader->manipulateData(url(), QNetworkAccessManager::GetOperation, QByteArray(), download_timeout);
+  return downloader;
+}
+
 QList<Message> StandardFeed::obtainNewMessages(bool* error_during_obtaining) {
   QByteArray feed_contents;
   int download_timeout = qApp->settings()->value(GROUP(Feeds), SETTING(Feeds::UpdateTimeout)).toInt();
@@ -403,16 +429,29 @@ QList<Message> StandardFeed::obtainNewMessages(bool* error_during_obtaining) {
   QList<QPair<QByteArray, QByteArray>> headers;
   headers << NetworkFactory::generateBasicAuthHeader(username(), password());
 
-  m_networkError = NetworkFactory::performNetworkOperation(url(),
-                                                           download_timeout,
-                                                           QByteArray(),
-                                                           feed_contents,
-                                                           QNetworkAccessManager::GetOperation,
-                                                           headers).first;
+  NetworkResult network_result = NetworkFactory::performNetworkOperation(url(),
+                                                                         download_timeout,
+                                                                         QByteArray(),
+                                                                         feed_contents,
+                                                                         QNetworkAccessManager::GetOperation,
+                                                                         headers);
 
-  if (m_networkError != QNetworkReply::NoError) {
+  // NOTE: Feed downloader always updates standard feeds asynchronously,
+  // so hints obtained here are not used.
+  ObtainedHints hints;
+
+  return parseDownloadedData(network_result.first, feed_contents, network_result.second.toString(), error_during_obtaining, &hints);
+}
+
+QList<Message> StandardFeed::parseDownloadedData(QNetworkReply::NetworkError network_error, const QByteArray& data,
+                                                 const QString& content_type, bool* error_during_obtaining,
+                                                 ObtainedHints* hints) {
+  // NOTE: This is called in worker thread, so error is only
+  // reported and it is applied to feed in main thread.
+  hints->m_networkError = network_error;
+
+  if (network_error != QNetworkReply::NoError) {
     qWarning("Error during fetching of new messages for feed '%s' (id %d).", qPrintable(url()), id());
-    setStatus(NetworkError);
     *error_during_obtaining = true;
     return QList<Message>();
   }
@@ -420,40 +459,34 @@ QList<Message> StandardFeed::obtainNewMessages(bool* error_during_obtaining) {
     *error_during_obtaining = false;
   }
 
-  // Encode downloaded data for further parsing.
-  QTextCodec* codec = QTextCodec::codecForName(encoding().toLocal8Bit());
-  QString formatted_feed_contents;
-
-  if (codec == nullptr) {
-    // No suitable codec for this encoding was found.
-    // Use non-converted data.
-    formatted_feed_contents = feed_contents;
-  }
-  else {
-    formatted_feed_contents = codec->toUnicode(feed_contents);
-  }
-
-  // Feed data are downloaded and encoded.
-  // Parse data and obtain messages.
-  QList<Message> messages;
+  // Downloaded data are decoded only once, directly by the parser.
+  QTextCodec* codec = FeedParser::codecForData(data, content_type, encoding());
+  QScopedPointer<FeedParser> parser;
 
   switch (type()) {
     case StandardFeed::Rss0X:
     case StandardFeed::Rss2X:
-      messages = RssParser(formatted_feed_contents).messages();
+      parser.reset(new RssParser(data, codec));
       break;
 
     case StandardFeed::Rdf:
-      messages = RdfParser().parseXmlData(formatted_feed_contents);
+      parser.reset(new RdfParser(data, codec));
       break;
 
     case StandardFeed::Atom10:
-      messages = AtomParser(formatted_feed_contents).messages();
+      parser.reset(new AtomParser(data, codec));
+      break;
 
     default:
-      break;
+      return QList<Message>();
   }
 
+  QList<Message> messages = parser->messages();
+
+  // Remember how often feed itself wants to be updated.
+  hints->m_feedInterval = parser->updateInterval();
+  hints->m_skipHours = parser->skipHours();
+
   return messages;
 }
 
@@ -461,6 +494,15 @@ QNetworkReply::NetworkError StandardFeed::networkError() const {
   return m_networkError;
 }
 
+void StandardFeed::applyObtainedHints(const ObtainedHints& hints) {
+  Feed::applyObtainedHints(hints);
+  m_networkError = hints.m_networkError;
+
+  if (m_networkError != QNetworkReply::NoError) {
+    setStatus(NetworkError);
+  }
+}
+
 StandardFeed::StandardFeed(const QSqlRecord& record) : Feed(record) {
   setEncoding(record.value(FDS_DB_ENCODING_INDEX).toString());
   setPasswordProtected(record.value(FDS_DB_PROTECTED_INDEX).toBool());
@@ -67,6 +67,12 @@ class StandardFeed : public Feed {
 
     QNetworkReply::NetworkError networkError() const;
 
+    // Remembers network error of last update too.
+    void applyObtainedHints(const ObtainedHints& hints);
+
+    bool supportsAsynchronousUpdate() const;
+    Downloader* startAsynchronousUpdate();
+
     // Tries to guess feed hidden under given URL
     // and uses given credentials.
     // Returns pointer to guessed feed (if at least partially
@@ -84,6 +90,9 @@ class StandardFeed : public Feed {
 
   private:
     QList<Message> obtainNewMessages(bool* error_during_obtaining);
+    QList<Message> parseDownloadedData(QNetworkReply::NetworkError network_error, const QByteArray& data,
+                                       const QString& content_type, bool* error_during_obtaining,
+                                       ObtainedHints* hints);
 
   private:
     bool m_passwordProtected{};
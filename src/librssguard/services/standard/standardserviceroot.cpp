@@ -9,8 +9,8 @@
 #include "miscellaneous/application.h"
 #include "miscellaneous/databasequeries.h"
 #include "miscellaneous/iconfactory.h"
-#include "miscellaneous/mutex.h"
 #include "miscellaneous/settings.h"
+#include "miscellaneous/updatelock.h"
 #include "services/abstract/recyclebin.h"
 #include "services/standard/gui/formstandardcategorydetails.h"
 #include "services/standard/gui/formstandardfeeddetails.h"
@@ -107,12 +107,12 @@ bool StandardServiceRoot::supportsCategoryAdding() const {
 }
 
 void StandardServiceRoot::addNewFeed(const QString& url) {
-  if (!qApp->feedUpdateLock()->tryLock()) {
+  if (!qApp->feedUpdateLock()->tryLockAccount(this)) {
     // Lock was not obtained because
     // it is used probably by feed updater or application
     // is quitting.
     qApp->showGuiMessage(tr("Cannot add item"),
-                         tr("Cannot add feed because another critical operation is ongoing."),
+                         tr("Cannot add feed because this account is being updated or edited."),
                          QSystemTrayIcon::Warning, qApp->mainFormWidget(), true);
 
     // Thus, cannot delete and quit the method.
@@ -121,7 +121,7 @@ void StandardServiceRoot::addNewFeed(const QString& url) {
 
   QScopedPointer<FormStandardFeedDetails> form_pointer(new FormStandardFeedDetails(this, qApp->mainFormWidget()));
   form_pointer.data()->addEditFeed(nullptr, nullptr, url);
-  qApp->feedUpdateLock()->unlock();
+  qApp->feedUpdateLock()->unlockAccount(this);
 }
 
 Qt::ItemFlags StandardServiceRoot::additionalFlags() const {
@@ -267,12 +267,12 @@ bool StandardServiceRoot::mergeImportExportModel(FeedsImportExportModel* model,
 }
 
 void StandardServiceRoot::addNewCategory() {
-  if (!qApp->feedUpdateLock()->tryLock()) {
+  if (!qApp->feedUpdateLock()->tryLockAccount(this)) {
     // Lock was not obtained because
     // it is used probably by feed updater or application
     // is quitting.
     qApp->showGuiMessage(tr("Cannot add category"),
-                         tr("Cannot add category because another critical operation is ongoing."),
+                         tr("Cannot add category because this account is being updated or edited."),
                          QSystemTrayIcon::Warning, qApp->mainFormWidget(), true);
 
     // Thus, cannot delete and quit the method.
@@ -281,7 +281,7 @@ void StandardServiceRoot::addNewCategory() {
 
   QScopedPointer<FormStandardCategoryDetails> form_pointer(new FormStandardCategoryDetails(this, qApp->mainFormWidget()));
   form_pointer.data()->addEditCategory(nullptr, nullptr);
-  qApp->feedUpdateLock()->unlock();
+  qApp->feedUpdateLock()->unlockAccount(this);
 }
 
 void StandardServiceRoot::importFeeds() {
@@ -30,6 +30,7 @@ void FormTtRssFeedDetails::apply() {
     new_feed_data->setAutoUpdateType(static_cast<Feed::AutoUpdateType>(m_ui->m_cmbAutoUpdateType->itemData(
                                                                          m_ui->m_cmbAutoUpdateType->currentIndex()).toInt()));
     new_feed_data->setAutoUpdateInitialInterval(m_ui->m_spinAutoUpdateInterval->value());
+    new_feed_data->setRetentionPolicy(retentionPolicy());
     qobject_cast<TtRssFeed*>(m_editableFeed)->editItself(new_feed_data);
     delete new_feed_data;
   }
@@ -57,9 +57,11 @@ bool TtRssFeed::editItself(TtRssFeed* new_feed_data) {
   QSqlDatabase database = qApp->database()->connection(metaObject()->className());
 
   if (DatabaseQueries::editBaseFeed(database, id(), new_feed_data->autoUpdateType(),
-                                    new_feed_data->autoUpdateInitialInterval())) {
+                                    new_feed_data->autoUpdateInitialInterval()) &&
+      DatabaseQueries::editFeedRetentionPolicy(database, id(), new_feed_data->retentionPolicy())) {
     setAutoUpdateType(new_feed_data->autoUpdateType());
     setAutoUpdateInitialInterval(new_feed_data->autoUpdateInitialInterval());
+    setRetentionPolicy(new_feed_data->retentionPolicy());
     return true;
   }
   else {
@@ -5,9 +5,9 @@
 #include "miscellaneous/application.h"
 #include "miscellaneous/databasequeries.h"
 #include "miscellaneous/iconfactory.h"
-#include "miscellaneous/mutex.h"
 #include "miscellaneous/settings.h"
 #include "miscellaneous/textfactory.h"
+#include "miscellaneous/updatelock.h"
 #include "network-web/networkfactory.h"
 #include "services/abstract/recyclebin.h"
 #include "services/tt-rss/definitions.h"
@@ -79,12 +79,12 @@ bool TtRssServiceRoot::supportsCategoryAdding() const {
 }
 
 void TtRssServiceRoot::addNewFeed(const QString& url) {
-  if (!qApp->feedUpdateLock()->tryLock()) {
+  if (!qApp->feedUpdateLock()->tryLockAccount(this)) {
     // Lock was not obtained because
     // it is used probably by feed updater or application
     // is quitting.
     qApp->showGuiMessage(tr("Cannot add item"),
-                         tr("Cannot add feed because another critical operation is ongoing."),
+                         tr("Cannot add feed because this account is being updated or edited."),
                          QSystemTrayIcon::Warning, qApp->mainFormWidget(), true);
 
     // Thus, cannot delete and quit the method.
@@ -93,7 +93,7 @@ void TtRssServiceRoot::addNewFeed(const QString& url) {
 
   QScopedPointer<FormTtRssFeedDetails> form_pointer(new FormTtRssFeedDetails(this, qApp->mainFormWidget()));
   form_pointer.data()->addEditFeed(nullptr, this, url);
-  qApp->feedUpdateLock()->unlock();
+  qApp->feedUpdateLock()->unlockAccount(this);
 }
 
 void TtRssServiceRoot::addNewCategory() {
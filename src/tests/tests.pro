@@ -0,0 +1,25 @@
+TEMPLATE = app
+TARGET = tst_feedparsers
+
+MSG_PREFIX = "tst_feedparsers"
+APP_TYPE = "test"
+
+include(../../pri/vars.pri)
+include(../../pri/defs.pri)
+
+message($$MSG_PREFIX: Shadow copy build directory \"$$OUT_PWD\".)
+
+include(../../pri/build_opts.pri)
+
+QT *= testlib
+CONFIG += testcase
+
+DEFINES *= RSSGUARD_DLLSPEC=Q_DECL_IMPORT
+SOURCES += tst_feedparsers.cpp
+INCLUDEPATH +=  $$PWD/../librssguard \
+                $$OUT_PWD/../librssguard
+
+DEPENDPATH += $$PWD/../librssguard
+
+win32: LIBS += -L$$OUT_PWD/../librssguard/ -llibrssguard
+unix: LIBS += -L$$OUT_PWD/../librssguard/ -lrssguard
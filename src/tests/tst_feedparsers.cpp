@@ -0,0 +1,325 @@
+// For license of this file, see <project-root-folder>/LICENSE.md.
+
+#include "definitions/definitions.h"
+#include "miscellaneous/application.h"
+#include "services/abstract/feed.h"
+#include "services/standard/atomparser.h"
+#include "services/standard/rdfparser.h"
+#include "services/standard/rssparser.h"
+
+#include <QFile>
+#include <QTest>
+#include <QTextCodec>
+
+// Checks semantics of feed parsers on sample feeds and measures
+// how long it takes to parse large feeds.
+class FeedParsersTest : public QObject {
+  Q_OBJECT
+
+  private slots:
+    void rssMessages();
+    void rssFeedHints();
+    void atomMessages();
+    void rdfMessages();
+    void declaredEncoding();
+    void codecEncoding();
+    void codecForData_data();
+    void codecForData();
+    void normalizedTitle_data();
+    void normalizedTitle();
+    void benchmarkRss();
+    void benchmarkAtom();
+    void benchmarkRdf();
+    void benchmarkDecoding();
+    void benchmarkNormalizedTitle();
+
+  private:
+    static QByteArray sampleFeed(const QString& file_name);
+
+    // Generates RSS, Atom or RDF document with given count of messages.
+    static QByteArray largeFeed(const QString& type, int count);
+};
+
+QByteArray FeedParsersTest::sampleFeed(const QString& file_name) {
+  QFile file(QFINDTESTDATA(QSL("data/") + file_name));
+
+  if (!file.open(QIODevice::ReadOnly)) {
+    qWarning("Cannot open sample feed '%s'.", qPrintable(file_name));
+    return QByteArray();
+  }
+
+  return file.readAll();
+}
+
+QByteArray FeedParsersTest::largeFeed(const QString& type, int count) {
+  QString data;
+  const QString contents = QSL("&lt;p&gt;Contents of message with &lt;a href=\"https://example.com\"&gt;link&lt;/a&gt;. ").repeated(20);
+
+  if (type == QL1S("atom")) {
+    data = QSL("<?xml version=\"1.0\" encoding=\"UTF-8\"?><feed xmlns=\"http://www.w3.org/2005/Atom\"><title>Atom</title>");
+
+    for (int i = 0; i < count; i++) {
+      data += QString(QSL("<entry><title>Message %1</title><link href=\"https://example.com/%1\"/>"
+                          "<author><name>Author %1</name></author><updated>2017-01-02T10:00:00Z</updated>"
+                          "<content type=\"html\">%2</content></entry>")).arg(QString::number(i), contents);
+    }
+
+    data += QSL("</feed>");
+  }
+  else if (type == QL1S("rdf")) {
+    data = QSL("<?xml version=\"1.0\" encoding=\"UTF-8\"?><rdf:RDF xmlns:rdf=\"http://www.w3.org/1999/02/22-rdf-syntax-ns#\" "
+               "xmlns=\"http://purl.org/rss/1.0/\" xmlns:dc=\"http://purl.org/dc/elements/1.1/\"><channel><title>RDF</title></channel>");
+
+    for (int i = 0; i < count; i++) {
+      data += QString(QSL("<item><title>Message %1</title><link>https://example.com/%1</link>"
+                          "<dc:creator>Author %1</dc:creator><dc:date>2017-01-02T10:00:00Z</dc:date>"
+                          "<description>%2</description></item>")).arg(QString::number(i), contents);
+    }
+
+    data += QSL("</rdf:RDF>");
+  }
+  else {
+    data = QSL("<?xml version=\"1.0\" encoding=\"UTF-8\"?><rss version=\"2.0\"><channel><title>RSS</title>");
+
+    for (int i = 0; i < count; i++) {
+      data += QString(QSL("<item><title>Message %1</title><link>https://example.com/%1</link>"
+                          "<author>Author %1</author><pubDate>Mon, 02 Jan 2017 10:00:00 GMT</pubDate>"
+                          "<description>%2</description></item>")).arg(QString::number(i), contents);
+    }
+
+    data += QSL("</channel></rss>");
+  }
+
+  return data.toUtf8();
+}
+
+void FeedParsersTest::rssMessages() {
+  const QList<Message> messages = RssParser(sampleFeed(QSL("rss.xml"))).messages();
+
+  // Message without title and description is skipped.
+  QCOMPARE(messages.size(), 2);
+
+  // First title wins, other elements with the same name are not joined to it.
+  const Message& first = messages.at(0);
+
+  QCOMPARE(first.m_title, QSL("First title"));
+  QCOMPARE(first.m_contents, QSL("<p>Full contents.</p>"));
+  QCOMPARE(first.m_url, QSL("https://example.com/first"));
+  QCOMPARE(first.m_author, QSL("John Doe"));
+  QVERIFY(first.m_createdFromFeed);
+  QCOMPARE(first.m_created, QDateTime(QDate(2017, 1, 2), QTime(10, 0), Qt::UTC));
+  QCOMPARE(first.m_enclosures.size(), 2);
+  QCOMPARE(first.m_enclosures.at(0).m_url, QSL("https://example.com/first.mp3"));
+  QCOMPARE(first.m_enclosures.at(0).m_mimeType, QSL("audio/mpeg"));
+  QCOMPARE(first.m_enclosures.at(1).m_url, QSL("https://example.com/first.png"));
+
+  // Title is made of description, URL of enclosure.
+  const Message& second = messages.at(1);
+
+  QCOMPARE(second.m_title, QSL("Item without title."));
+  QCOMPARE(second.m_contents, QSL("<p>Item without title.</p>"));
+  QCOMPARE(second.m_url, QSL("https://example.com/second.mp3"));
+  QCOMPARE(second.m_author, QString(""));
+  QVERIFY(!second.m_createdFromFeed);
+}
+
+void FeedParsersTest::rssFeedHints() {
+  RssParser parser(sampleFeed(QSL("rss.xml")));
+
+  parser.messages();
+  QCOMPARE(parser.updateInterval(), 3600);
+  QCOMPARE(parser.skipHours(), quint32((1u << 1) | (1u << 2)));
+}
+
+void FeedParsersTest::atomMessages() {
+  const QList<Message> messages = AtomParser(sampleFeed(QSL("atom.xml"))).messages();
+
+  QCOMPARE(messages.size(), 2);
+
+  // Title of entry wins over titles nested deeper in the entry.
+  const Message& first = messages.at(0);
+
+  QCOMPARE(first.m_title, QSL("Entry title"));
+  QCOMPARE(first.m_contents, QSL("Entry summary."));
+  QCOMPARE(first.m_url, QSL("https://example.com/entry"));
+  QVERIFY(first.m_createdFromFeed);
+  QCOMPARE(first.m_created, QDateTime(QDate(2017, 1, 2), QTime(10, 0), Qt::UTC));
+  QCOMPARE(first.m_enclosures.size(), 1);
+  QCOMPARE(first.m_enclosures.at(0).m_url, QSL("https://example.com/entry.mp3"));
+
+  // Entry without author gets authors of whole feed.
+  QCOMPARE(first.m_author, QSL("Feed Author, Entry Author"));
+
+  // Content wins over summary.
+  const Message& second = messages.at(1);
+
+  QCOMPARE(second.m_title, QSL("Entry with author"));
+  QCOMPARE(second.m_contents, QSL("<p>Entry contents.</p>"));
+  QCOMPARE(second.m_url, QSL("https://example.com/authored"));
+  QCOMPARE(second.m_author, QSL("Entry Author"));
+  QVERIFY(!second.m_createdFromFeed);
+}
+
+void FeedParsersTest::rdfMessages() {
+  RdfParser parser(sampleFeed(QSL("rdf.xml")));
+  const QList<Message> messages = parser.messages();
+
+  QCOMPARE(messages.size(), 1);
+
+  const Message& message = messages.at(0);
+
+  QCOMPARE(message.m_title, QSL("RDF title"));
+  QCOMPARE(message.m_contents, QSL("RDF description."));
+  QCOMPARE(message.m_url, QSL("https://example.com/rdf"));
+  QCOMPARE(message.m_author, QSL("Jane Doe"));
+  QVERIFY(message.m_createdFromFeed);
+  QCOMPARE(message.m_created, QDateTime(QDate(2017, 1, 2), QTime(10, 0), Qt::UTC));
+
+  // Feed asks to be updated four times a day.
+  QCOMPARE(parser.updateInterval(), 21600);
+}
+
+void FeedParsersTest::declaredEncoding() {
+  const QString title = QString::fromUtf8("Žluťoučký kůň");
+  const QByteArray data = QTextCodec::codecForName("ISO-8859-2")->fromUnicode(
+    QSL("<?xml version=\"1.0\" encoding=\"ISO-8859-2\"?><rss version=\"2.0\"><channel>"
+        "<item><title>%1</title></item></channel></rss>").arg(title));
+  const QList<Message> messages = RssParser(data).messages();
+
+  QCOMPARE(messages.size(), 1);
+  QCOMPARE(messages.at(0).m_title, title);
+}
+
+void FeedParsersTest::codecEncoding() {
+  // Document does not declare its encoding, so it is decoded
+  // with given codec, for example with charset sent by server.
+  const QString title = QString::fromUtf8("Žluťoučký kůň");
+  QTextCodec* codec = QTextCodec::codecForName("ISO-8859-2");
+  const QByteArray data = codec->fromUnicode(QSL("<rss version=\"2.0\"><channel>"
+                                                 "<item><title>%1</title></item></channel></rss>").arg(title));
+  const QList<Message> messages = RssParser(data, codec).messages();
+
+  QCOMPARE(messages.size(), 1);
+  QCOMPARE(messages.at(0).m_title, title);
+}
+
+void FeedParsersTest::codecForData_data() {
+  QTest::addColumn<QByteArray>("data");
+  QTest::addColumn<QString>("content_type");
+  QTest::addColumn<QString>("encoding");
+  QTest::addColumn<QString>("codec");
+
+  const QByteArray declared = "<?xml version=\"1.0\" encoding=\"ISO-8859-2\"?><rss/>";
+  const QByteArray undeclared = "<?xml version=\"1.0\"?><rss/>";
+
+  // Empty codec name means that data are passed to XML parser as they are.
+  QTest::newRow("utf-8 bom") << QByteArray("\xEF\xBB\xBF<rss/>") << QSL("text/xml; charset=windows-1250")
+                             << QSL("ISO-8859-2") << QString();
+  QTest::newRow("declared encoding") << declared << QSL("text/xml; charset=windows-1250")
+                                     << QSL("KOI8-R") << QString();
+  QTest::newRow("http charset") << undeclared << QSL("text/xml; charset=\"windows-1250\"; foo=bar")
+                                << QSL("KOI8-R") << QSL("windows-1250");
+  QTest::newRow("stored encoding") << undeclared << QSL("text/xml")
+                                   << QSL("KOI8-R") << QSL("KOI8-R");
+  QTest::newRow("utf-8") << undeclared << QSL("text/xml; charset=utf-8")
+                         << QSL("KOI8-R") << QString();
+  QTest::newRow("unknown charset") << undeclared << QSL("text/xml; charset=unknown")
+                                   << QSL("KOI8-R") << QString();
+}
+
+void FeedParsersTest::codecForData() {
+  QFETCH(QByteArray, data);
+  QFETCH(QString, content_type);
+  QFETCH(QString, encoding);
+  QFETCH(QString, codec);
+
+  QTextCodec* data_codec = FeedParser::codecForData(data, content_type, encoding);
+
+  if (codec.isEmpty()) {
+    QVERIFY(data_codec == nullptr);
+  }
+  else {
+    QVERIFY(data_codec != nullptr);
+    QCOMPARE(data_codec, QTextCodec::codecForName(codec.toLatin1()));
+  }
+}
+
+void FeedParsersTest::normalizedTitle_data() {
+  QTest::addColumn<QString>("title");
+  QTest::addColumn<QString>("normalized");
+
+  QTest::newRow("unchanged") << QSL("Plain title") << QSL("Plain title");
+  QTest::newRow("leading space") << QSL(" Title") << QSL("Title");
+  QTest::newRow("leading spaces") << QSL("   Title") << QSL("Title");
+  QTest::newRow("inner spaces") << QSL("Long   title") << QSL("Long title");
+  QTest::newRow("newline") << QSL("Multi\nline") << QSL("Multiline");
+  QTest::newRow("newline run") << QSL("Multi\r\n line") << QSL("Multi line");
+  QTest::newRow("tab") << QSL("Tab\ttitle") << QSL("Tab\ttitle");
+  QTest::newRow("trailing spaces") << QSL("Title  ") << QSL("Title ");
+  QTest::newRow("empty") << QString() << QString();
+}
+
+void FeedParsersTest::normalizedTitle() {
+  QFETCH(QString, title);
+  QFETCH(QString, normalized);
+
+  QCOMPARE(Feed::normalizedTitle(title), normalized);
+}
+
+void FeedParsersTest::benchmarkRss() {
+  const QByteArray data = largeFeed(QSL("rss"), 1000);
+
+  QBENCHMARK {
+    QCOMPARE(RssParser(data).messages().size(), 1000);
+  }
+}
+
+void FeedParsersTest::benchmarkAtom() {
+  const QByteArray data = largeFeed(QSL("atom"), 1000);
+
+  QBENCHMARK {
+    QCOMPARE(AtomParser(data).messages().size(), 1000);
+  }
+}
+
+void FeedParsersTest::benchmarkRdf() {
+  const QByteArray data = largeFeed(QSL("rdf"), 1000);
+
+  QBENCHMARK {
+    QCOMPARE(RdfParser(data).messages().size(), 1000);
+  }
+}
+
+void FeedParsersTest::benchmarkDecoding() {
+  // Feed without declared encoding is decoded with charset sent by server.
+  QTextCodec* codec = QTextCodec::codecForName("ISO-8859-2");
+  const QByteArray data = codec->fromUnicode(QString::fromUtf8(largeFeed(QSL("rss"), 1000))
+                                             .remove(QSL("<?xml version=\"1.0\" encoding=\"UTF-8\"?>")));
+
+  QBENCHMARK {
+    QCOMPARE(RssParser(data, FeedParser::codecForData(data, QSL("text/xml; charset=ISO-8859-2"), QString())).messages().size(),
+             1000);
+  }
+}
+
+void FeedParsersTest::benchmarkNormalizedTitle() {
+  const QString clean_title = QSL("Title which does not need to be changed at all");
+  const QString dirty_title = QSL("  Title   which\r\nneeds  to be   changed\n");
+
+  QBENCHMARK {
+    for (int i = 0; i < 1000; i++) {
+      Feed::normalizedTitle(clean_title);
+      Feed::normalizedTitle(dirty_title);
+    }
+  }
+}
+
+int main(int argc, char* argv[]) {
+  // Parsers use web factory of application instance.
+  Application application(QSL(APP_LOW_NAME "-tests"), argc, argv);
+  FeedParsersTest test;
+
+  return QTest::qExec(&test, argc, argv);
+}
+
+#include "tst_feedparsers.moc"